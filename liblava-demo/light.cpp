@@ -134,8 +134,8 @@ int main(int argc, char* argv[]) {
         .minFilter = VK_FILTER_NEAREST,
         .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST
     };
-    VkSampler sampler;
-    if (!app.device->vkCreateSampler(&sampler_info, &sampler))
+    VkSampler sampler = app.device->get_sampler_cache().acquire(sampler_info);
+    if (!sampler)
         return error::create_failed;
 
     // pipeline-specific resources
@@ -144,6 +144,7 @@ int main(int argc, char* argv[]) {
     descriptor::pool descriptor_pool;
 
     render_pass::ptr gbuffer_renderpass = make_render_pass(app.device);
+    aliasing_allocator gbuffer_memory;
     descriptor::ptr gbuffer_set_layout = make_descriptor();
     pipeline_layout::ptr gbuffer_pipeline_layout = make_pipeline_layout();
     graphics_pipeline::ptr gbuffer_pipeline = make_graphics_pipeline(app.device);
@@ -245,6 +246,11 @@ int main(int argc, char* argv[]) {
         gbuffer_renderpass = create_gbuffer_renderpass(app, g_attachments);
         gbuffer_renderpass->add_front(gbuffer_pipeline);
 
+        // attachments are sampled in the lighting pass, they live in both passes
+        gbuffer_memory.clear();
+        for (gbuffer_attachment& att : g_attachments)
+            gbuffer_memory.add(att.image_handle, 0, 1);
+
         // Lighting pass
 
         for (auto i = 0u; i < g_attachments.size(); ++i) {
@@ -350,13 +356,12 @@ int main(int argc, char* argv[]) {
         *(decltype(g_ubo)*) ubo_buffer.get_mapped_data() = g_ubo;
 
         // (re-)create G-Buffer attachments and collect views for framebuffer creation
-        VkImageViews views;
-        for (gbuffer_attachment& att : g_attachments) {
-            if (!att.image_handle->create(app.device, area.get_size()))
-                return false;
+        if (!gbuffer_memory.create(app.device, area.get_size()))
+            return false;
 
+        VkImageViews views;
+        for (gbuffer_attachment& att : g_attachments)
             views.push_back(att.image_handle->get_view());
-        }
 
         // update lighting descriptor set with new G-Buffer image handles
         std::vector<VkWriteDescriptorSet> lighting_write_sets;
@@ -399,9 +404,7 @@ int main(int argc, char* argv[]) {
         gbuffer_renderpass->get_target_callback().on_destroyed();
 
         // destroy G-Buffer attachments
-        for (gbuffer_attachment& att : g_attachments) {
-            att.image_handle->destroy();
-        }
+        gbuffer_memory.destroy();
     };
 
     app.imgui.on_draw = [&]() {
@@ -432,7 +435,7 @@ int main(int argc, char* argv[]) {
     };
 
     app.add_run_end([&]() {
-        app.device->vkDestroySampler(sampler);
+        app.device->get_sampler_cache().release(sampler);
         sampler = VK_NULL_HANDLE;
 
         light_buffer.destroy();
@@ -8,6 +8,7 @@
 #include <imgui.h>
 #include <liblava/app/app.hpp>
 #include <liblava/app/def.hpp>
+#include <liblava/asset/asset_cache.hpp>
 #include <liblava/base/debug_utils.hpp>
 
 namespace lava {
@@ -65,6 +66,18 @@ bool app::create_block() {
     if (!block.create(device, target->get_frame_count(), device->graphics_queue().family))
         return false;
 
+    if (device->timeline_semaphore_enabled() && device->get_transfer_queues().size() > 1) {
+        uploads = make_upload_context();
+        if (!uploads->create(device, device->graphics_queue()))
+            uploads = nullptr;
+    }
+
+    if (device->timeline_semaphore_enabled() && device->get_compute_queues().size() > 1) {
+        compute = make_async_compute();
+        if (!compute->create(device, target->get_frame_count(), device->graphics_queue()))
+            compute = nullptr;
+    }
+
     block_command = block.add_cmd([&](VkCommandBuffer cmd_buf) {
         scoped_label block_label(cmd_buf, _lava_block_, { default_color, 1.f });
 
@@ -73,6 +86,13 @@ bool app::create_block() {
         {
             scoped_label stage_label(cmd_buf, _lava_texture_staging_, { 0.f, 0.13f, 0.4f, 1.f });
             staging.stage(cmd_buf, current_frame);
+
+            if (uploads) {
+                uploads->submit();
+
+                if (auto const value = uploads->acquire(cmd_buf))
+                    renderer.add_wait_semaphore(uploads->get_semaphore(), VK_PIPELINE_STAGE_TRANSFER_BIT, value);
+            }
         }
 
         if (on_process)
@@ -102,6 +122,8 @@ bool app::setup() {
     if (cmd_line[{ "-c", "--clean" }])
         file_system::instance().clean_pref_dir();
 
+    asset_cache::instance().set_path((fs::path(file_system::get_pref_dir()) / "cache").string());
+
     handle_config();
 
     cmd_line({ "-vs", "--v_sync" }) >> config.v_sync;
@@ -115,6 +137,8 @@ bool app::setup() {
     set_window_icon(window);
 
     if (!device) {
+        manager.pipeline_cache_dir = file_system::get_pref_dir();
+
         device = create_device(config.physical_device);
         if (!device)
             return false;
@@ -148,6 +172,9 @@ bool app::setup() {
 
         destroy_imgui();
 
+        uploads = nullptr;
+        compute = nullptr;
+
         block.destroy();
 
         destroy_target();
@@ -265,6 +292,11 @@ void app::handle_input() {
 
             if (event.pressed(key::space))
                 run_time.paused = !run_time.paused;
+
+            if (event.pressed(key::m, mod::alt)) {
+                write_memory_stats();
+                return true;
+            }
         }
 
         if (camera.activated())
@@ -404,10 +436,39 @@ void app::render() {
         if (!block.process(*frame_index))
             return false;
 
+        if (compute) {
+            if (!compute->process(*frame_index))
+                return false;
+
+            if (auto const stages = compute->get_wait_stages())
+                renderer.add_wait_semaphore(compute->get_semaphore(), stages, compute->get_wait_value());
+        }
+
         return renderer.end_frame(block.get_buffers());
     });
 }
 
+//-----------------------------------------------------------------------------
+bool app::write_memory_stats(bool detailed) const {
+    auto const allocator = device->get_allocator();
+    if (!allocator)
+        return false;
+
+    for (auto const& heap : allocator->get_heap_stats())
+        log()->info("memory heap {} - usage: {} MB, budget: {} MB, allocations: {}", heap.heap,
+                    heap.usage >> 20, heap.budget >> 20, heap.allocation_count);
+
+    auto const stats = allocator->get_stats_json(detailed);
+    auto const path = (fs::path(file_system::get_pref_dir()) / "memory_stats.json").string();
+    if (!write_file(str(path), stats.data(), stats.size())) {
+        log()->error("write memory stats - {}", path);
+        return false;
+    }
+
+    log()->info("memory stats - {}", path);
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 void app::draw_about(bool separator) const {
     if (separator)
@@ -420,7 +481,7 @@ void app::draw_about(bool separator) const {
     ImGui::Text("%s %s", _liblava_, str(version_string()));
 
     if (ImGui::IsItemHovered())
-        ImGui::SetTooltip("alt + enter = fullscreen\nalt + backspace = v-sync\nspace = pause\ntab = gui");
+        ImGui::SetTooltip("alt + enter = fullscreen\nalt + backspace = v-sync\nalt + m = memory stats\nspace = pause\ntab = gui");
 
     imgui_left_spacing();
 
@@ -12,6 +12,7 @@
 #include <liblava/app/forward_shading.hpp>
 #include <liblava/block.hpp>
 #include <liblava/frame.hpp>
+#include <liblava/resource/upload_context.hpp>
 
 namespace lava {
 
@@ -63,9 +64,15 @@ struct app : frame {
     /// Texture staging
     lava::staging staging;
 
+    /// Uploads on a transfer queue, e.g. of texture batches (nullptr: no dedicated queues or timeline semaphores)
+    upload_context::ptr uploads;
+
     /// Basic block
     lava::block block;
 
+    /// Async compute lane (nullptr: no dedicated queues or timeline semaphores)
+    async_compute::ptr compute;
+
     /// Plain renderer
     lava::renderer renderer;
 
@@ -115,6 +122,16 @@ struct app : frame {
         return frame_counter;
     }
 
+    /**
+     * @brief Write the memory statistics of the device to the pref dir (memory_stats.json)
+     * 
+     * @param detailed    Include the detailed map of all allocations
+     * 
+     * @return true       Write was successful
+     * @return false      Write failed
+     */
+    bool write_memory_stats(bool detailed = false) const;
+
     /**
      * @brief Draw about information
      * 
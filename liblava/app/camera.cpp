@@ -157,6 +157,17 @@ void camera::update_view(delta dt, gamepad::ref pad) {
     }
 }
 
+//-----------------------------------------------------------------------------
+r32 camera::get_screen_size(v3 const& center, r32 radius) const {
+    auto const clip = projection * view * v4(center, 1.f);
+
+    // inside of sphere
+    if (clip.w <= radius)
+        return std::numeric_limits<r32>::max();
+
+    return radius * std::abs(projection[1][1]) / std::max(clip.w, z_near);
+}
+
 //-----------------------------------------------------------------------------
 void camera::update_projection() {
     projection = glm::perspective(glm::radians(fov), aspect_ratio, z_near, z_far);
@@ -161,6 +161,34 @@ struct camera : entity {
         return up || down || left || right;
     }
 
+    /**
+     * @brief Get the projection matrix
+     * 
+     * @return mat4 const&    Projection matrix
+     */
+    mat4 const& get_projection() const {
+        return projection;
+    }
+
+    /**
+     * @brief Get the view matrix
+     * 
+     * @return mat4 const&    View matrix
+     */
+    mat4 const& get_view() const {
+        return view;
+    }
+
+    /**
+     * @brief Get the projected size of a bounding sphere
+     * 
+     * @param center    World space center of sphere
+     * @param radius    World space radius of sphere
+     * 
+     * @return r32      Projected diameter as fraction of viewport height
+     */
+    r32 get_screen_size(v3 const& center, r32 radius) const;
+
     /// Camera position
     v3 position = v3(0.f);
 
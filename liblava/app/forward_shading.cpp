@@ -18,6 +18,8 @@ bool forward_shading::create(render_target::ptr t) {
     if (!depth_format.has_value())
         return false;
 
+    auto transient_depth = false;
+
     pass = make_render_pass(target->get_device());
     {
         auto color_attachment = make_attachment(target->get_format());
@@ -31,6 +33,7 @@ bool forward_shading::create(render_target::ptr t) {
         depth_attachment->set_stencil_op(VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE);
         depth_attachment->set_layouts(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
         pass->add(depth_attachment);
+        transient_depth = depth_attachment->transient();
 
         auto subpass = make_subpass(VK_PIPELINE_BIND_POINT_GRAPHICS);
         subpass->set_color_attachment(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
@@ -57,6 +60,11 @@ bool forward_shading::create(render_target::ptr t) {
         return false;
 
     depth_stencil->set_usage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+    // depth stays in tile memory where supported
+    if (transient_depth)
+        depth_stencil->set_transient();
+
     depth_stencil->set_layout(VK_IMAGE_LAYOUT_UNDEFINED);
     depth_stencil->set_aspect_mask(VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
     depth_stencil->set_component();
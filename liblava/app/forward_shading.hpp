@@ -64,6 +64,8 @@ struct forward_shading {
     /**
      * @brief Get the depth stencil image
      * 
+     * The image is a transient attachment, its contents are not stored.
+     * 
      * @return image::ptr    Depth stencil Image
      */
     image::ptr get_depth_stencil() const {
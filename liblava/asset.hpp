@@ -7,6 +7,12 @@
 
 #pragma once
 
+#include <liblava/asset/asset_cache.hpp>
+#include <liblava/asset/asset_manager.hpp>
+#include <liblava/asset/bc_encoder.hpp>
+#include <liblava/asset/gltf_loader.hpp>
+#include <liblava/asset/half_float.hpp>
 #include <liblava/asset/image_data.hpp>
 #include <liblava/asset/mesh_loader.hpp>
+#include <liblava/asset/mip_map.hpp>
 #include <liblava/asset/texture_loader.hpp>
@@ -0,0 +1,161 @@
+/**
+ * @file         liblava/asset/asset_cache.cpp
+ * @brief        Cache for processed assets
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <fstream>
+#include <liblava/asset/asset_cache.hpp>
+#include <liblava/util/log.hpp>
+#include <thread>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+ui64 asset_cache::hash(data_cptr data, size_t size, ui64 seed) {
+    auto result = seed;
+
+    for (size_t i = 0; i < size; ++i) {
+        result ^= ui8(data[i]);
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+ui64 asset_cache::hash(file& file) {
+    std::vector<char> chunk(64 * 1024);
+    auto result = hash(nullptr, 0);
+
+    file.seek(0);
+
+    while (true) {
+        auto const size = file.read_next(chunk.data(), chunk.size());
+        if (size <= 0)
+            break;
+
+        result = hash(chunk.data(), to_size_t(size), result);
+    }
+
+    file.seek(0);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+string asset_cache::make_key(ui64 hash, string_ref tag) {
+    return fmt::format("{:016x}_{}", hash, tag);
+}
+
+//-----------------------------------------------------------------------------
+bool asset_cache::set_path(string_ref p) {
+    path.clear();
+
+    if (p.empty())
+        return true;
+
+    std::error_code error;
+    fs::create_directories(p, error);
+
+    if (error || !fs::is_directory(p, error)) {
+        log()->error("create asset cache directory {}", p);
+        return false;
+    }
+
+    path = p;
+
+    log()->debug("asset cache {}", path);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool asset_cache::exists(string_ref key) const {
+    if (!activated())
+        return false;
+
+    std::error_code error;
+    return fs::exists(get_file_path(key), error);
+}
+
+//-----------------------------------------------------------------------------
+bool asset_cache::load(string_ref key, unique_data& data) const {
+    if (!activated())
+        return false;
+
+    std::ifstream file(get_file_path(key), std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    auto const file_size = to_size_t(file.tellg());
+    if (file_size == 0)
+        return false;
+
+    data.set(file_size);
+    if (!data.ptr)
+        return false;
+
+    file.seekg(0, std::ios::beg);
+    file.read(data.ptr, file_size);
+
+    return file.good();
+}
+
+//-----------------------------------------------------------------------------
+bool asset_cache::save(string_ref key, data_cptr data, size_t size) const {
+    if (!activated())
+        return false;
+
+    auto const target = get_file_path(key);
+
+    // write to a unique temporary file first, readers never see partial entries
+    auto temp = target;
+    temp += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(temp, std::ofstream::binary | std::ofstream::trunc);
+        if (!file.is_open()) {
+            log()->error("save asset cache {}", key);
+            return false;
+        }
+
+        file.write(data, size);
+        if (!file.good()) {
+            log()->error("write asset cache {}", key);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temp, target, error);
+    if (error) {
+        fs::remove(temp, error);
+        log()->error("rename asset cache {}", key);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool asset_cache::remove(string_ref key) const {
+    if (!activated())
+        return false;
+
+    std::error_code error;
+    return fs::remove(get_file_path(key), error);
+}
+
+//-----------------------------------------------------------------------------
+void asset_cache::clear() const {
+    if (!activated())
+        return;
+
+    std::error_code error;
+    for (auto const& entry : fs::directory_iterator(path, error))
+        fs::remove(entry.path(), error);
+}
+
+} // namespace lava
@@ -0,0 +1,158 @@
+/**
+ * @file         liblava/asset/asset_cache.hpp
+ * @brief        Cache for processed assets
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/core/data.hpp>
+#include <liblava/file/file.hpp>
+#include <liblava/file/file_system.hpp>
+
+namespace lava {
+
+/**
+ * @brief Cache for processed assets (files in cache directory)
+ */
+struct asset_cache : no_copy_no_move {
+    /**
+     * @brief Get asset cache singleton
+     *
+     * @return asset_cache&    Asset cache
+     */
+    static asset_cache& instance() {
+        static asset_cache cache;
+        return cache;
+    }
+
+    /**
+     * @brief Hash data (FNV-1a)
+     *
+     * @param data      Data to hash
+     * @param size      Size of data
+     * @param seed      Hash seed (to chain hashes)
+     *
+     * @return ui64     Hash value
+     */
+    static ui64 hash(data_cptr data, size_t size, ui64 seed = 14695981039346656037ull);
+
+    /**
+     * @brief Hash file content in chunks (same value as the whole data)
+     *
+     * @param file      Opened file (position is reset)
+     *
+     * @return ui64     Hash value
+     */
+    static ui64 hash(file& file);
+
+    /**
+     * @brief Make a cache key
+     *
+     * @param hash       Hash of source
+     * @param tag        Processing tag (e.g. "mip_srgb.ktx")
+     *
+     * @return string    Cache key
+     */
+    static string make_key(ui64 hash, string_ref tag);
+
+    /**
+     * @brief Set the cache directory (empty: deactivate)
+     *
+     * @param path      Cache directory
+     *
+     * @return true     Cache directory is ready
+     * @return false    Create directory failed
+     */
+    bool set_path(string_ref path);
+
+    /**
+     * @brief Get the cache directory
+     *
+     * @return string const&    Cache directory
+     */
+    string const& get_path() const {
+        return path;
+    }
+
+    /**
+     * @brief Check if the cache is activated
+     *
+     * @return true     Cache is activated
+     * @return false    Cache is deactivated
+     */
+    bool activated() const {
+        return !path.empty();
+    }
+
+    /**
+     * @brief Check if a cache entry exists
+     *
+     * @param key       Cache key
+     *
+     * @return true     Entry exists
+     * @return false    Entry not found
+     */
+    bool exists(string_ref key) const;
+
+    /**
+     * @brief Load a cache entry
+     *
+     * @param key       Cache key
+     * @param data      Target data
+     *
+     * @return true     Load was successful
+     * @return false    Load failed
+     */
+    bool load(string_ref key, unique_data& data) const;
+
+    /**
+     * @brief Save a cache entry (atomic replace)
+     *
+     * @param key       Cache key
+     * @param data      Data to save
+     * @param size      Size of data
+     *
+     * @return true     Save was successful
+     * @return false    Save failed
+     */
+    bool save(string_ref key, data_cptr data, size_t size) const;
+
+    /**
+     * @brief Remove a cache entry
+     *
+     * @param key       Cache key
+     *
+     * @return true     Remove was successful
+     * @return false    Remove failed
+     */
+    bool remove(string_ref key) const;
+
+    /**
+     * @brief Remove all cache entries
+     */
+    void clear() const;
+
+private:
+    /**
+     * @brief Construct a new asset cache
+     */
+    asset_cache() = default;
+
+    /**
+     * @brief Get the file path of a cache entry
+     *
+     * @param key          Cache key
+     *
+     * @return fs::path    Path of entry
+     */
+    fs::path get_file_path(string_ref key) const {
+        return fs::path(path) / key;
+    }
+
+    /// Cache directory
+    string path;
+};
+
+} // namespace lava
@@ -0,0 +1,388 @@
+/**
+ * @file         liblava/asset/asset_manager.cpp
+ * @brief        Asset manager with residency budget
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/asset/asset_manager.hpp>
+
+namespace lava {
+
+/**
+ * @brief Get the memory size of a texture
+ *
+ * @param device           Vulkan device
+ * @param texture          Texture
+ *
+ * @return VkDeviceSize    Allocation size
+ */
+VkDeviceSize get_memory_size(device_ptr device, texture::ptr texture) {
+    auto image = texture->get_image();
+    if (!image || !image->get_allocation())
+        return 0;
+
+    VmaAllocationInfo info{};
+    vmaGetAllocationInfo(device->alloc(), image->get_allocation(), &info);
+    return info.size;
+}
+
+/**
+ * @brief Get the memory size of a mesh
+ *
+ * @param mesh             Mesh
+ *
+ * @return VkDeviceSize    Size of vertex and index buffer
+ */
+VkDeviceSize get_memory_size(mesh::ptr mesh) {
+    VkDeviceSize result = 0;
+
+    for (auto& vertex_buffer : mesh->get_vertex_buffers())
+        result += vertex_buffer->get_size();
+
+    if (auto index_buffer = mesh->get_index_buffer())
+        result += index_buffer->get_size();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+bool asset_manager::create(device_ptr d, ui32 frames, ui32 threads) {
+    device = d;
+    frame_count = std::max(frames, 1u);
+    thread_count = threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+
+    pool.setup(thread_count);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::destroy() {
+    if (!device)
+        return;
+
+    if (batch) {
+        batch->cancel();
+        batch = nullptr;
+    }
+
+    pool.teardown();
+
+    collect_garbage(true);
+
+    for (auto& [object_id, texture] : textures.get_all())
+        texture->destroy();
+
+    for (auto& [object_id, mesh] : meshes.get_all())
+        mesh->destroy();
+
+    textures = {};
+    meshes = {};
+
+    assets.clear();
+    requests.clear();
+    batch_assets.clear();
+    loaded_meshes.clear();
+
+    resident_size = 0;
+    uploads = nullptr;
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+id asset_manager::add_request(string_ref key, entry const& info) {
+    auto const it = requests.find(key);
+    if (it != requests.end()) {
+        auto& asset = assets.at(it->second);
+        ++asset.ref_count;
+        return it->second;
+    }
+
+    auto const result = ids::next();
+
+    auto& asset = assets.emplace(result, info).first->second;
+    asset.key = key;
+    asset.ref_count = 1;
+    asset.last_used = frame;
+
+    requests.emplace(key, result);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+id asset_manager::request_texture(file_format const& file_format, texture_type type) {
+    entry info;
+    info.file = file_format;
+    info.type = type;
+
+    return add_request(fmt::format("texture:{}:{}:{}", file_format.path,
+                                   to_i32(file_format.format), to_i32(type)),
+                       info);
+}
+
+//-----------------------------------------------------------------------------
+id asset_manager::request_mesh(string_ref filename) {
+    entry info;
+    info.file.path = filename;
+    info.mesh = true;
+
+    return add_request(fmt::format("mesh:{}", filename), info);
+}
+
+//-----------------------------------------------------------------------------
+bool asset_manager::acquire(id::ref asset) {
+    auto const it = assets.find(asset);
+    if (it == assets.end())
+        return false;
+
+    ++it->second.ref_count;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::release(id::ref asset) {
+    auto const it = assets.find(asset);
+    if (it == assets.end() || it->second.ref_count == 0)
+        return;
+
+    auto& entry = it->second;
+    if (--entry.ref_count > 0)
+        return;
+
+    // not started yet: drop the request
+    if (entry.state == asset_state::queued || entry.state == asset_state::failed) {
+        requests.erase(entry.key);
+        assets.erase(it);
+        ids::free(asset);
+    }
+}
+
+//-----------------------------------------------------------------------------
+asset_state asset_manager::get_state(id::ref asset) const {
+    auto const it = assets.find(asset);
+    return it != assets.end() ? it->second.state : asset_state::none;
+}
+
+//-----------------------------------------------------------------------------
+texture::ptr asset_manager::get_texture(id::ref asset) {
+    auto const it = assets.find(asset);
+    if (it == assets.end() || it->second.mesh || it->second.state != asset_state::ready)
+        return nullptr;
+
+    it->second.last_used = frame;
+    return textures.get(it->second.object);
+}
+
+//-----------------------------------------------------------------------------
+mesh::ptr asset_manager::get_mesh(id::ref asset) {
+    auto const it = assets.find(asset);
+    if (it == assets.end() || !it->second.mesh || it->second.state != asset_state::ready)
+        return nullptr;
+
+    it->second.last_used = frame;
+    return meshes.get(it->second.object);
+}
+
+//-----------------------------------------------------------------------------
+bool asset_manager::loading() const {
+    for (auto const& [asset_id, asset] : assets)
+        if (asset.state == asset_state::queued || asset.state == asset_state::loading)
+            return true;
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+bool asset_manager::over_budget() const {
+    if (budget > 0)
+        return resident_size > budget;
+
+    // evicted assets are still allocated until their frames are done
+    auto const memory = device->get_allocator()->get_budget();
+    return memory.usage > memory.budget + garbage_size;
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::set_ready(entry& asset, id::ref object, VkDeviceSize size) {
+    asset.state = asset_state::ready;
+    asset.object = object;
+    asset.size = size;
+    asset.last_used = frame;
+
+    resident_size += size;
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::update(staging& staging) {
+    ++frame;
+
+    collect_garbage();
+
+    if (batch) {
+        batch->poll(&staging);
+
+        if (batch->done()) {
+            batch = nullptr;
+            batch_assets.clear();
+        }
+    }
+
+    create_meshes();
+
+    evict();
+
+    if (!over_budget())
+        start_loads();
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::create_meshes() {
+    std::deque<std::pair<id, mesh::ptr>> loaded;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        loaded.swap(loaded_meshes);
+    }
+
+    for (auto& [asset_id, mesh] : loaded) {
+        auto& asset = assets.at(asset_id);
+
+        if (!mesh || !mesh->create(device)) {
+            log()->error("asset manager load mesh {}", asset.file.path);
+            asset.state = asset_state::failed;
+            continue;
+        }
+
+        meshes.add(mesh, { asset.file.path, mesh_type::none });
+        set_ready(asset, mesh->get_id(), get_memory_size(mesh));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::evict() {
+    if (!over_budget())
+        return;
+
+    std::vector<std::pair<ui64, id>> candidates;
+    for (auto const& [asset_id, asset] : assets) {
+        // assets used in this frame can still be recorded
+        if (asset.state == asset_state::ready && asset.ref_count == 0 && asset.last_used < frame)
+            candidates.emplace_back(asset.last_used, asset_id);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (auto const& [last_used, asset_id] : candidates) {
+        if (!over_budget())
+            break;
+
+        auto const it = assets.find(asset_id);
+        auto& asset = it->second;
+
+        garbage item;
+        item.frame = frame;
+        item.size = asset.size;
+
+        if (asset.mesh) {
+            item.mesh = meshes.get(asset.object);
+            meshes.remove(asset.object);
+        } else {
+            item.texture = textures.get(asset.object);
+            textures.remove(asset.object);
+        }
+
+        garbage_list.push_back(item);
+        garbage_size += asset.size;
+        resident_size -= asset.size;
+        ++eviction_count;
+
+        requests.erase(asset.key);
+        assets.erase(it);
+        ids::free(asset_id);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::start_loads() {
+    file_format::list files;
+    auto batch_type = texture_type::none;
+
+    for (auto& [asset_id, asset] : assets) {
+        if (asset.state != asset_state::queued)
+            continue;
+
+        if (asset.mesh) {
+            asset.state = asset_state::loading;
+
+            pool.enqueue([this, asset_id = asset_id, filename = asset.file.path](id::ref) {
+                auto mesh = load_mesh(nullptr, str(filename));
+
+                std::unique_lock<std::mutex> lock(mutex);
+                loaded_meshes.emplace_back(asset_id, mesh);
+            });
+
+            continue;
+        }
+
+        // one texture batch at a time, textures of the same type
+        if (batch || files.size() >= batch_size)
+            continue;
+
+        if (files.empty())
+            batch_type = asset.type;
+        else if (asset.type != batch_type)
+            continue;
+
+        asset.state = asset_state::loading;
+
+        files.push_back(asset.file);
+        batch_assets.push_back(asset_id);
+    }
+
+    if (files.empty())
+        return;
+
+    batch = make_texture_batch();
+
+    batch->on_loaded = [this](index file, texture::ptr texture) {
+        auto& asset = assets.at(batch_assets.at(file));
+
+        if (!texture) {
+            log()->error("asset manager load texture {}", asset.file.path);
+            asset.state = asset_state::failed;
+            return;
+        }
+
+        textures.add(texture, asset.file);
+        set_ready(asset, texture->get_id(), get_memory_size(device, texture));
+    };
+
+    batch->set_upload_context(uploads);
+
+    if (!batch->start(device, files, batch_type, mip_generation::cpu, thread_count)) {
+        for (auto& asset_id : batch_assets)
+            assets.at(asset_id).state = asset_state::failed;
+
+        batch = nullptr;
+        batch_assets.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void asset_manager::collect_garbage(bool all) {
+    while (!garbage_list.empty()) {
+        auto& item = garbage_list.front();
+        if (!all && item.frame + frame_count > frame)
+            break;
+
+        if (item.texture)
+            item.texture->destroy();
+
+        if (item.mesh)
+            item.mesh->destroy();
+
+        garbage_size -= item.size;
+        garbage_list.pop_front();
+    }
+}
+
+} // namespace lava
@@ -0,0 +1,379 @@
+/**
+ * @file         liblava/asset/asset_manager.hpp
+ * @brief        Asset manager with residency budget
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/asset/mesh_loader.hpp>
+#include <liblava/asset/texture_loader.hpp>
+
+namespace lava {
+
+/**
+ * @brief Asset states
+ */
+enum class asset_state : type {
+    none = 0,
+    queued,
+    loading,
+    ready,
+    failed
+};
+
+/**
+ * @brief Asset manager
+ *
+ * Assets are requested by path and loaded asynchronously (textures by a texture batch,
+ * meshes on a thread pool). Requests are reference counted, assets without references
+ * stay resident until the memory budget is exceeded and are then evicted in LRU order.
+ * Evicted assets are destroyed after the frames in flight are done.
+ */
+struct asset_manager : no_copy_no_move {
+    /// Shared pointer to asset manager
+    using ptr = std::shared_ptr<asset_manager>;
+
+    /**
+     * @brief Destroy the asset manager
+     */
+    ~asset_manager() {
+        destroy();
+    }
+
+    /**
+     * @brief Create the asset manager
+     *
+     * @param device          Vulkan device
+     * @param frame_count     Number of frames in flight (deferred destruction)
+     * @param thread_count    Number of load threads (0: hardware concurrency)
+     *
+     * @return true           Create was successful
+     * @return false          Create failed
+     */
+    bool create(device_ptr device, ui32 frame_count = 3, ui32 thread_count = 0);
+
+    /**
+     * @brief Destroy the asset manager and all assets
+     */
+    void destroy();
+
+    /**
+     * @brief Request a texture (adds a reference)
+     *
+     * @param file_format    File and format
+     * @param type           Type of texture
+     *
+     * @return id            Asset id (same id for same request)
+     */
+    id request_texture(file_format const& file_format, texture_type type = texture_type::tex_2d);
+
+    /**
+     * @brief Request a mesh (adds a reference)
+     *
+     * @param filename    File to load
+     *
+     * @return id         Asset id (same id for same file)
+     */
+    id request_mesh(string_ref filename);
+
+    /**
+     * @brief Add a reference to an asset
+     *
+     * @param asset     Asset id
+     *
+     * @return true     Reference added
+     * @return false    Asset not found
+     */
+    bool acquire(id::ref asset);
+
+    /**
+     * @brief Release a reference of an asset
+     *
+     * Assets without references can be evicted, their ids become invalid then.
+     *
+     * @param asset    Asset id
+     */
+    void release(id::ref asset);
+
+    /**
+     * @brief Get the state of an asset
+     *
+     * @param asset           Asset id
+     *
+     * @return asset_state    State of asset (none: not found or evicted)
+     */
+    asset_state get_state(id::ref asset) const;
+
+    /**
+     * @brief Get a texture and mark it as used in this frame
+     *
+     * @param asset            Asset id
+     *
+     * @return texture::ptr    Texture (nullptr: not ready)
+     */
+    texture::ptr get_texture(id::ref asset);
+
+    /**
+     * @brief Get a mesh and mark it as used in this frame
+     *
+     * @param asset         Asset id
+     *
+     * @return mesh::ptr    Mesh (nullptr: not ready)
+     */
+    mesh::ptr get_mesh(id::ref asset);
+
+    /**
+     * @brief Update the asset manager (call once per frame on the device thread)
+     *
+     * Creates the loaded assets, evicts unreferenced assets while over budget,
+     * starts new loads while under budget and destroys evicted assets of done frames.
+     *
+     * @param staging    Staging to upload the loaded textures
+     */
+    void update(staging& staging);
+
+    /**
+     * @brief Set the upload context of the texture batches
+     *
+     * Textures are copied on the transfer queue and get ready after the upload context acquired them.
+     *
+     * @param value    Upload context (nullptr: staging)
+     */
+    void set_upload_context(upload_context::ptr value) {
+        uploads = value;
+    }
+
+    /**
+     * @brief Set the memory budget
+     *
+     * @param value    Budget of resident assets in bytes (0: device local budget of Vma)
+     */
+    void set_budget(VkDeviceSize value) {
+        budget = value;
+    }
+
+    /**
+     * @brief Get the memory budget
+     *
+     * @return VkDeviceSize    Budget of resident assets in bytes (0: device local budget of Vma)
+     */
+    VkDeviceSize get_budget() const {
+        return budget;
+    }
+
+    /**
+     * @brief Check if the memory budget is exceeded
+     *
+     * @return true     Over budget
+     * @return false    Under budget
+     */
+    bool over_budget() const;
+
+    /**
+     * @brief Get the memory size of the resident assets
+     *
+     * @return VkDeviceSize    Resident size in bytes
+     */
+    VkDeviceSize get_resident_size() const {
+        return resident_size;
+    }
+
+    /**
+     * @brief Get the number of evicted assets
+     *
+     * @return ui32    Number of evictions
+     */
+    ui32 get_eviction_count() const {
+        return eviction_count;
+    }
+
+    /**
+     * @brief Check if assets are queued or loading
+     *
+     * @return true     Loads are pending
+     * @return false    All requests are handled
+     */
+    bool loading() const;
+
+    /**
+     * @brief Get the texture registry (resident textures)
+     *
+     * @return texture_registry const&    Texture registry
+     */
+    texture_registry const& get_textures() const {
+        return textures;
+    }
+
+    /**
+     * @brief Get the mesh registry (resident meshes)
+     *
+     * @return mesh_registry const&    Mesh registry
+     */
+    mesh_registry const& get_meshes() const {
+        return meshes;
+    }
+
+    /// Max number of textures per texture batch
+    ui32 batch_size = 16;
+
+private:
+    /**
+     * @brief Asset entry
+     */
+    struct entry {
+        /// Request key
+        string key;
+
+        /// File and format
+        file_format file;
+
+        /// Type of texture
+        texture_type type = texture_type::tex_2d;
+
+        /// Mesh asset
+        bool mesh = false;
+
+        /// Load state
+        asset_state state = asset_state::queued;
+
+        /// Number of references
+        ui32 ref_count = 0;
+
+        /// Frame of last use
+        ui64 last_used = 0;
+
+        /// Memory size
+        VkDeviceSize size = 0;
+
+        /// Object id in registry
+        id object;
+    };
+
+    /**
+     * @brief Evicted asset waiting for destruction
+     */
+    struct garbage {
+        /// Frame of eviction
+        ui64 frame = 0;
+
+        /// Memory size
+        VkDeviceSize size = 0;
+
+        /// Evicted texture
+        lava::texture::ptr texture;
+
+        /// Evicted mesh
+        lava::mesh::ptr mesh;
+    };
+
+    /**
+     * @brief Add a request
+     *
+     * @param key      Request key
+     * @param info     Entry to add if not requested yet
+     *
+     * @return id      Asset id
+     */
+    id add_request(string_ref key, entry const& info);
+
+    /**
+     * @brief Set an asset resident
+     *
+     * @param asset      Asset entry
+     * @param object     Object id in registry
+     * @param size       Memory size
+     */
+    void set_ready(entry& asset, id::ref object, VkDeviceSize size);
+
+    /**
+     * @brief Create the loaded meshes
+     */
+    void create_meshes();
+
+    /**
+     * @brief Evict unreferenced assets in LRU order while over budget
+     */
+    void evict();
+
+    /**
+     * @brief Start loading the queued assets
+     */
+    void start_loads();
+
+    /**
+     * @brief Destroy the evicted assets of done frames
+     *
+     * @param all    Destroy all evicted assets
+     */
+    void collect_garbage(bool all = false);
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Number of frames in flight
+    ui32 frame_count = 3;
+
+    /// Number of load threads
+    ui32 thread_count = 0;
+
+    /// Current frame
+    ui64 frame = 0;
+
+    /// Map of assets
+    std::map<id, entry> assets;
+
+    /// Asset ids by request key
+    string_id_map requests;
+
+    /// Resident textures
+    texture_registry textures;
+
+    /// Resident meshes
+    mesh_registry meshes;
+
+    /// Upload context of texture batches (nullptr: staging)
+    upload_context::ptr uploads;
+
+    /// Running texture batch
+    texture_batch::ptr batch;
+
+    /// Asset ids of running texture batch
+    id::list batch_assets;
+
+    /// Mesh load thread pool
+    thread_pool pool;
+
+    /// Loaded meshes waiting for creation
+    std::deque<std::pair<id, mesh::ptr>> loaded_meshes;
+
+    /// Loaded meshes mutex
+    std::mutex mutex;
+
+    /// Evicted assets
+    std::deque<garbage> garbage_list;
+
+    /// Memory budget (0: Vma budget)
+    VkDeviceSize budget = 0;
+
+    /// Memory size of resident assets
+    VkDeviceSize resident_size = 0;
+
+    /// Memory size of evicted assets waiting for destruction
+    VkDeviceSize garbage_size = 0;
+
+    /// Number of evicted assets
+    ui32 eviction_count = 0;
+};
+
+/**
+ * @brief Make a new asset manager
+ *
+ * @return asset_manager::ptr    Shared pointer to asset manager
+ */
+inline asset_manager::ptr make_asset_manager() {
+    return std::make_shared<asset_manager>();
+}
+
+} // namespace lava
@@ -0,0 +1,1299 @@
+/**
+ * @file         liblava/asset/bc_encoder.cpp
+ * @brief        Block compression encoder (BC1, BC3, BC4, BC5, BC7)
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/asset/bc_encoder.hpp>
+#include <liblava/util/thread.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LAVA_BC_ENCODER_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #define LAVA_BC_ENCODER_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace lava {
+
+/// Number of pixels in a block
+constexpr ui32 const block_pixels = 16;
+
+/// BC7 4-bit index weights
+constexpr std::array<ui32, 16> const bc7_weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/**
+ * @brief Block bit writer (LSB first)
+ */
+struct block_writer {
+    /**
+     * @brief Write bits
+     *
+     * @param value    Value to write
+     * @param count    Number of bits
+     */
+    void write(ui32 value, ui32 count) {
+        for (auto i = 0u; i < count; ++i, ++position)
+            if ((value >> i) & 1)
+                data[position >> 3] |= ui8(1 << (position & 7));
+    }
+
+    /// Target block (zero initialized)
+    ui8* data = nullptr;
+
+    /// Bit position
+    ui32 position = 0;
+};
+
+/**
+ * @brief Block bit reader (LSB first)
+ */
+struct block_reader {
+    /**
+     * @brief Read bits
+     *
+     * @param count    Number of bits
+     *
+     * @return ui32    Read value
+     */
+    ui32 read(ui32 count) {
+        auto result = 0u;
+        for (auto i = 0u; i < count; ++i, ++position)
+            result |= ((data[position >> 3] >> (position & 7)) & 1u) << i;
+
+        return result;
+    }
+
+    /// Source block
+    ui8 const* data = nullptr;
+
+    /// Bit position
+    ui32 position = 0;
+};
+
+/**
+ * @brief Get the component-wise bounds of a block
+ *
+ * @param pixels    16 RGBA8 pixels
+ * @param min       Minimum RGBA
+ * @param max       Maximum RGBA
+ */
+void get_block_bounds(ui8 const* pixels, ui8* min, ui8* max) {
+#if LAVA_BC_ENCODER_SSE2
+    auto low = _mm_loadu_si128((__m128i const*) pixels);
+    auto high = low;
+
+    for (auto i = 1u; i < 4; ++i) {
+        auto const row = _mm_loadu_si128((__m128i const*) (pixels + i * 16));
+        low = _mm_min_epu8(low, row);
+        high = _mm_max_epu8(high, row);
+    }
+
+    low = _mm_min_epu8(low, _mm_srli_si128(low, 8));
+    low = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+    high = _mm_max_epu8(high, _mm_srli_si128(high, 8));
+    high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+
+    auto const low_value = _mm_cvtsi128_si32(low);
+    auto const high_value = _mm_cvtsi128_si32(high);
+    memcpy(min, &low_value, 4);
+    memcpy(max, &high_value, 4);
+#elif LAVA_BC_ENCODER_NEON
+    auto low = vld1q_u8(pixels);
+    auto high = low;
+
+    for (auto i = 1u; i < 4; ++i) {
+        auto const row = vld1q_u8(pixels + i * 16);
+        low = vminq_u8(low, row);
+        high = vmaxq_u8(high, row);
+    }
+
+    auto low_half = vmin_u8(vget_low_u8(low), vget_high_u8(low));
+    auto high_half = vmax_u8(vget_low_u8(high), vget_high_u8(high));
+    low_half = vmin_u8(low_half, vext_u8(low_half, low_half, 4));
+    high_half = vmax_u8(high_half, vext_u8(high_half, high_half, 4));
+
+    vst1_lane_u32((uint32_t*) min, vreinterpret_u32_u8(low_half), 0);
+    vst1_lane_u32((uint32_t*) max, vreinterpret_u32_u8(high_half), 0);
+#else
+    for (auto c = 0u; c < 4; ++c) {
+        min[c] = 255;
+        max[c] = 0;
+    }
+
+    for (auto i = 0u; i < block_pixels; ++i) {
+        for (auto c = 0u; c < 4; ++c) {
+            min[c] = std::min(min[c], pixels[i * 4 + c]);
+            max[c] = std::max(max[c], pixels[i * 4 + c]);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Find the nearest palette colors of a block (four pixels at a time)
+ *
+ * @param pixels      16 RGBA8 pixels
+ * @param palette     Palette (RGBA)
+ * @param count       Number of palette entries
+ * @param alpha       Compare the alpha channel
+ * @param indices     Target indices
+ * @param errors      Squared error of each pixel
+ */
+void find_nearest_colors(ui8 const* pixels, std::array<i32, 4> const* palette, ui32 count, bool alpha,
+                         std::array<ui32, block_pixels>& indices, std::array<i32, block_pixels>& errors) {
+#if LAVA_BC_ENCODER_SSE2
+    auto const zero = _mm_setzero_si128();
+    auto const mask = alpha ? _mm_set1_epi32(-1) : _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+    std::array<__m128i, 16> colors;
+    for (auto p = 0u; p < count; ++p)
+        colors[p] = _mm_set_epi16(short(palette[p][3]), short(palette[p][2]), short(palette[p][1]), short(palette[p][0]),
+                                  short(palette[p][3]), short(palette[p][2]), short(palette[p][1]), short(palette[p][0]));
+
+    for (auto i = 0u; i < block_pixels; i += 4) {
+        auto const row = _mm_loadu_si128((__m128i const*) (pixels + i * 4));
+        auto const low = _mm_unpacklo_epi8(row, zero);
+        auto const high = _mm_unpackhi_epi8(row, zero);
+
+        auto best = _mm_set1_epi32(std::numeric_limits<i32>::max());
+        auto best_index = zero;
+
+        for (auto p = 0u; p < count; ++p) {
+            auto const low_delta = _mm_and_si128(_mm_sub_epi16(low, colors[p]), mask);
+            auto const high_delta = _mm_and_si128(_mm_sub_epi16(high, colors[p]), mask);
+
+            // (r² + g², b² + a²) per pixel
+            auto const low_sum = _mm_castsi128_ps(_mm_madd_epi16(low_delta, low_delta));
+            auto const high_sum = _mm_castsi128_ps(_mm_madd_epi16(high_delta, high_delta));
+
+            auto const distance = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(low_sum, high_sum, _MM_SHUFFLE(2, 0, 2, 0))),
+                                                _mm_castps_si128(_mm_shuffle_ps(low_sum, high_sum, _MM_SHUFFLE(3, 1, 3, 1))));
+
+            auto const closer = _mm_cmplt_epi32(distance, best);
+            best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+            best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(i32(p))), _mm_andnot_si128(closer, best_index));
+        }
+
+        _mm_storeu_si128((__m128i*) (indices.data() + i), best_index);
+        _mm_storeu_si128((__m128i*) (errors.data() + i), best);
+    }
+#elif LAVA_BC_ENCODER_NEON
+    auto const channels = alpha ? 4u : 3u;
+
+    for (auto i = 0u; i < block_pixels; i += 8) {
+        auto const row = vld4_u8(pixels + i * 4);
+
+        std::array<int32x4_t, 2> best = { vdupq_n_s32(std::numeric_limits<i32>::max()),
+                                          vdupq_n_s32(std::numeric_limits<i32>::max()) };
+        std::array<uint32x4_t, 2> best_index = { vdupq_n_u32(0), vdupq_n_u32(0) };
+
+        for (auto p = 0u; p < count; ++p) {
+            auto low = vdupq_n_s32(0);
+            auto high = vdupq_n_s32(0);
+
+            for (auto c = 0u; c < channels; ++c) {
+                auto const delta = vreinterpretq_s16_u16(vsubl_u8(row.val[c], vdup_n_u8(ui8(palette[p][c]))));
+                low = vmlal_s16(low, vget_low_s16(delta), vget_low_s16(delta));
+                high = vmlal_s16(high, vget_high_s16(delta), vget_high_s16(delta));
+            }
+
+            auto const index = vdupq_n_u32(p);
+
+            auto const low_closer = vcltq_s32(low, best[0]);
+            best[0] = vbslq_s32(low_closer, low, best[0]);
+            best_index[0] = vbslq_u32(low_closer, index, best_index[0]);
+
+            auto const high_closer = vcltq_s32(high, best[1]);
+            best[1] = vbslq_s32(high_closer, high, best[1]);
+            best_index[1] = vbslq_u32(high_closer, index, best_index[1]);
+        }
+
+        vst1q_u32(indices.data() + i, best_index[0]);
+        vst1q_u32(indices.data() + i + 4, best_index[1]);
+        vst1q_s32(errors.data() + i, best[0]);
+        vst1q_s32(errors.data() + i + 4, best[1]);
+    }
+#else
+    auto const channels = alpha ? 4u : 3u;
+
+    for (auto i = 0u; i < block_pixels; ++i) {
+        errors[i] = std::numeric_limits<i32>::max();
+
+        for (auto p = 0u; p < count; ++p) {
+            auto distance = 0;
+            for (auto c = 0u; c < channels; ++c) {
+                auto const d = pixels[i * 4 + c] - palette[p][c];
+                distance += d * d;
+            }
+
+            if (distance < errors[i]) {
+                errors[i] = distance;
+                indices[i] = p;
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Find the nearest palette values of a block (four values at a time)
+ *
+ * @param values     16 values
+ * @param palette    Palette
+ * @param count      Number of palette entries
+ * @param indices    Target indices
+ * @param errors     Squared error of each value
+ */
+void find_nearest_values(ui8 const* values, i32 const* palette, ui32 count,
+                         std::array<ui32, block_pixels>& indices, std::array<i32, block_pixels>& errors) {
+#if LAVA_BC_ENCODER_SSE2
+    auto const zero = _mm_setzero_si128();
+
+    for (auto i = 0u; i < block_pixels; i += 4) {
+        i32 packed = 0;
+        memcpy(&packed, values + i, 4);
+        auto const row = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+
+        auto best = _mm_set1_epi32(std::numeric_limits<i32>::max());
+        auto best_index = zero;
+
+        for (auto p = 0u; p < count; ++p) {
+            // (d, 0) pairs give d² per value
+            auto const delta = _mm_unpacklo_epi16(_mm_sub_epi16(row, _mm_set1_epi16(short(palette[p]))), zero);
+            auto const distance = _mm_madd_epi16(delta, delta);
+
+            auto const closer = _mm_cmplt_epi32(distance, best);
+            best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+            best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(i32(p))), _mm_andnot_si128(closer, best_index));
+        }
+
+        _mm_storeu_si128((__m128i*) (indices.data() + i), best_index);
+        _mm_storeu_si128((__m128i*) (errors.data() + i), best);
+    }
+#elif LAVA_BC_ENCODER_NEON
+    for (auto i = 0u; i < block_pixels; i += 8) {
+        auto const row = vld1_u8(values + i);
+
+        std::array<int32x4_t, 2> best = { vdupq_n_s32(std::numeric_limits<i32>::max()),
+                                          vdupq_n_s32(std::numeric_limits<i32>::max()) };
+        std::array<uint32x4_t, 2> best_index = { vdupq_n_u32(0), vdupq_n_u32(0) };
+
+        for (auto p = 0u; p < count; ++p) {
+            auto const delta = vreinterpretq_s16_u16(vsubl_u8(row, vdup_n_u8(ui8(palette[p]))));
+            auto const low = vmull_s16(vget_low_s16(delta), vget_low_s16(delta));
+            auto const high = vmull_s16(vget_high_s16(delta), vget_high_s16(delta));
+
+            auto const index = vdupq_n_u32(p);
+
+            auto const low_closer = vcltq_s32(low, best[0]);
+            best[0] = vbslq_s32(low_closer, low, best[0]);
+            best_index[0] = vbslq_u32(low_closer, index, best_index[0]);
+
+            auto const high_closer = vcltq_s32(high, best[1]);
+            best[1] = vbslq_s32(high_closer, high, best[1]);
+            best_index[1] = vbslq_u32(high_closer, index, best_index[1]);
+        }
+
+        vst1q_u32(indices.data() + i, best_index[0]);
+        vst1q_u32(indices.data() + i + 4, best_index[1]);
+        vst1q_s32(errors.data() + i, best[0]);
+        vst1q_s32(errors.data() + i + 4, best[1]);
+    }
+#else
+    for (auto i = 0u; i < block_pixels; ++i) {
+        errors[i] = std::numeric_limits<i32>::max();
+
+        for (auto p = 0u; p < count; ++p) {
+            auto const d = values[i] - palette[p];
+            if (d * d < errors[i]) {
+                errors[i] = d * d;
+                indices[i] = p;
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Get the principal axis of a point set (power iteration)
+ *
+ * @tparam N         Number of channels
+ *
+ * @param points     List of points
+ * @param count      Number of points
+ * @param mean       Mean of points
+ * @param axis       Initial and resulting axis
+ */
+template<ui32 N>
+void get_principal_axis(std::array<r32, N> const* points, ui32 count,
+                        std::array<r32, N> const& mean, std::array<r32, N>& axis) {
+    std::array<r32, N * N> covariance{};
+
+    for (auto i = 0u; i < count; ++i)
+        for (auto a = 0u; a < N; ++a)
+            for (auto b = 0u; b < N; ++b)
+                covariance[a * N + b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+
+    for (auto iteration = 0u; iteration < 8; ++iteration) {
+        std::array<r32, N> result{};
+        for (auto a = 0u; a < N; ++a)
+            for (auto b = 0u; b < N; ++b)
+                result[a] += covariance[a * N + b] * axis[b];
+
+        auto length = 0.f;
+        for (auto a = 0u; a < N; ++a)
+            length = std::max(length, std::abs(result[a]));
+
+        if (length <= 0.f)
+            return;
+
+        for (auto a = 0u; a < N; ++a)
+            axis[a] = result[a] / length;
+    }
+}
+
+/**
+ * @brief Get the endpoints of a point set along the principal axis
+ *
+ * @tparam N          Number of channels
+ *
+ * @param points      List of points
+ * @param count       Number of points
+ * @param min         Minimum of points
+ * @param max         Maximum of points
+ * @param start       Start endpoint
+ * @param end         End endpoint
+ */
+template<ui32 N>
+void get_endpoints(std::array<r32, N> const* points, ui32 count,
+                   std::array<r32, N> const& min, std::array<r32, N> const& max,
+                   std::array<r32, N>& start, std::array<r32, N>& end) {
+    std::array<r32, N> mean{};
+    for (auto i = 0u; i < count; ++i)
+        for (auto c = 0u; c < N; ++c)
+            mean[c] += points[i][c] / count;
+
+    auto axis = max;
+    for (auto c = 0u; c < N; ++c)
+        axis[c] -= min[c];
+
+    get_principal_axis<N>(points, count, mean, axis);
+
+    auto length = 0.f;
+    for (auto c = 0u; c < N; ++c)
+        length += axis[c] * axis[c];
+
+    if (length <= 0.f) {
+        start = mean;
+        end = mean;
+        return;
+    }
+
+    auto low = std::numeric_limits<r32>::max();
+    auto high = -low;
+
+    for (auto i = 0u; i < count; ++i) {
+        auto t = 0.f;
+        for (auto c = 0u; c < N; ++c)
+            t += (points[i][c] - mean[c]) * axis[c];
+
+        low = std::min(low, t);
+        high = std::max(high, t);
+    }
+
+    for (auto c = 0u; c < N; ++c) {
+        start[c] = std::clamp(mean[c] + axis[c] * low / length, 0.f, 255.f);
+        end[c] = std::clamp(mean[c] + axis[c] * high / length, 0.f, 255.f);
+    }
+}
+
+/**
+ * @brief Pack a color to 565
+ *
+ * @param color    RGB color
+ *
+ * @return ui32    Packed color
+ */
+inline ui32 pack_565(std::array<r32, 3> const& color) {
+    auto const r = ui32(std::clamp(color[0], 0.f, 255.f) * 31.f / 255.f + 0.5f);
+    auto const g = ui32(std::clamp(color[1], 0.f, 255.f) * 63.f / 255.f + 0.5f);
+    auto const b = ui32(std::clamp(color[2], 0.f, 255.f) * 31.f / 255.f + 0.5f);
+
+    return (r << 11) | (g << 5) | b;
+}
+
+/**
+ * @brief Unpack a 565 color
+ *
+ * @param packed    Packed color
+ * @param color     RGB color
+ */
+inline void unpack_565(ui32 packed, i32* color) {
+    auto const r = (packed >> 11) & 31;
+    auto const g = (packed >> 5) & 63;
+    auto const b = packed & 31;
+
+    color[0] = i32((r << 3) | (r >> 2));
+    color[1] = i32((g << 2) | (g >> 4));
+    color[2] = i32((b << 3) | (b >> 2));
+}
+
+/**
+ * @brief Get the BC1 palette
+ *
+ * @param c0             First endpoint (565)
+ * @param c1             Second endpoint (565)
+ * @param four_colors    Four color mode
+ * @param palette        Palette (RGBA)
+ */
+void get_bc1_palette(ui32 c0, ui32 c1, bool four_colors, std::array<std::array<i32, 4>, 4>& palette) {
+    unpack_565(c0, palette[0].data());
+    unpack_565(c1, palette[1].data());
+
+    for (auto c = 0u; c < 3; ++c) {
+        if (four_colors) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = four_colors ? 255 : 0;
+}
+
+/**
+ * @brief Find the BC1 indices of a block
+ *
+ * @param pixels         16 RGBA8 pixels
+ * @param palette        BC1 palette
+ * @param transparent    Use index 3 for transparent pixels
+ * @param indices        Target indices
+ *
+ * @return i32           Squared error
+ */
+i32 find_bc1_indices(ui8 const* pixels, std::array<std::array<i32, 4>, 4> const& palette,
+                     bool transparent, std::array<ui32, block_pixels>& indices) {
+    std::array<i32, block_pixels> errors;
+    find_nearest_colors(pixels, palette.data(), transparent ? 3u : 4u, false, indices, errors);
+
+    auto result = 0;
+    for (auto i = 0u; i < block_pixels; ++i) {
+        if (transparent && pixels[i * 4 + 3] < 128)
+            indices[i] = 3;
+        else
+            result += errors[i];
+    }
+
+    return result;
+}
+
+/**
+ * @brief Encode a BC1 color block
+ *
+ * @param pixels          16 RGBA8 pixels
+ * @param block           Target block (8 bytes)
+ * @param punch_through   Use 3 color mode for transparent pixels
+ */
+void encode_bc1_color(ui8 const* pixels, ui8* block, bool punch_through) {
+    std::array<std::array<r32, 3>, block_pixels> points;
+    auto count = 0u;
+    auto transparent = false;
+
+    std::array<r32, 3> min{ 255.f, 255.f, 255.f };
+    std::array<r32, 3> max{};
+
+    for (auto i = 0u; i < block_pixels; ++i) {
+        auto const* pixel = pixels + i * 4;
+        if (punch_through && pixel[3] < 128) {
+            transparent = true;
+            continue;
+        }
+
+        for (auto c = 0u; c < 3; ++c) {
+            points[count][c] = pixel[c];
+            min[c] = std::min(min[c], r32(pixel[c]));
+            max[c] = std::max(max[c], r32(pixel[c]));
+        }
+
+        ++count;
+    }
+
+    memset(block, 0, 8);
+
+    if (count == 0) {
+        // fully transparent
+        block[0] = 0;
+        block[2] = 0;
+        memset(block + 4, 0xff, 4);
+        return;
+    }
+
+    std::array<r32, 3> start, end;
+    get_endpoints<3>(points.data(), count, min, max, start, end);
+
+    auto c0 = pack_565(end);
+    auto c1 = pack_565(start);
+
+    std::array<std::array<i32, 4>, 4> palette;
+    std::array<ui32, block_pixels> indices{};
+
+    auto encode = [&](ui32 a, ui32 b) {
+        // 4 color mode needs c0 > c1, 3 color mode c0 <= c1
+        if (transparent ? a > b : a < b)
+            std::swap(a, b);
+
+        c0 = a;
+        c1 = b;
+
+        if (!transparent && c0 == c1) {
+            indices.fill(0);
+            auto error = 0;
+            get_bc1_palette(c0, c1, true, palette);
+            for (auto i = 0u; i < block_pixels; ++i)
+                for (auto c = 0u; c < 3; ++c)
+                    error += (pixels[i * 4 + c] - palette[0][c]) * (pixels[i * 4 + c] - palette[0][c]);
+            return error;
+        }
+
+        get_bc1_palette(c0, c1, !transparent, palette);
+        return find_bc1_indices(pixels, palette, transparent, indices);
+    };
+
+    auto error = encode(c0, c1);
+
+    // least squares refinement of endpoints for the chosen indices
+    if (!transparent && c0 != c1) {
+        static constexpr std::array<r32, 4> const weight_0 = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+        r32 alpha_2 = 0.f, beta_2 = 0.f, alpha_beta = 0.f;
+        std::array<r32, 3> alpha_x{}, beta_x{};
+
+        for (auto i = 0u; i < block_pixels; ++i) {
+            auto const a = weight_0[indices[i]];
+            auto const b = 1.f - a;
+
+            alpha_2 += a * a;
+            beta_2 += b * b;
+            alpha_beta += a * b;
+
+            for (auto c = 0u; c < 3; ++c) {
+                alpha_x[c] += a * pixels[i * 4 + c];
+                beta_x[c] += b * pixels[i * 4 + c];
+            }
+        }
+
+        auto const determinant = alpha_2 * beta_2 - alpha_beta * alpha_beta;
+        if (std::abs(determinant) > 1e-6f) {
+            std::array<r32, 3> refined_0, refined_1;
+            for (auto c = 0u; c < 3; ++c) {
+                refined_0[c] = (alpha_x[c] * beta_2 - beta_x[c] * alpha_beta) / determinant;
+                refined_1[c] = (beta_x[c] * alpha_2 - alpha_x[c] * alpha_beta) / determinant;
+            }
+
+            auto const previous_indices = indices;
+            auto const previous_c0 = c0;
+            auto const previous_c1 = c1;
+
+            auto const refined_error = encode(pack_565(refined_0), pack_565(refined_1));
+            if (refined_error >= error) {
+                indices = previous_indices;
+                c0 = previous_c0;
+                c1 = previous_c1;
+            }
+        }
+    }
+
+    block[0] = ui8(c0 & 0xff);
+    block[1] = ui8(c0 >> 8);
+    block[2] = ui8(c1 & 0xff);
+    block[3] = ui8(c1 >> 8);
+
+    block_writer writer{ block + 4 };
+    for (auto i = 0u; i < block_pixels; ++i)
+        writer.write(indices[i], 2);
+}
+
+/**
+ * @brief Get the BC4 palette
+ *
+ * @param a0         First endpoint
+ * @param a1         Second endpoint
+ * @param palette    Palette
+ */
+void get_bc4_palette(ui32 a0, ui32 a1, std::array<i32, 8>& palette) {
+    palette[0] = i32(a0);
+    palette[1] = i32(a1);
+
+    if (a0 > a1) {
+        for (auto k = 2u; k < 8; ++k)
+            palette[k] = i32(((8 - k) * a0 + (k - 1) * a1 + 3) / 7);
+    } else {
+        for (auto k = 2u; k < 6; ++k)
+            palette[k] = i32(((6 - k) * a0 + (k - 1) * a1 + 2) / 5);
+
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+/**
+ * @brief Encode a BC4 block with given endpoints
+ *
+ * @param values     16 values
+ * @param a0         First endpoint
+ * @param a1         Second endpoint
+ * @param indices    Target indices
+ *
+ * @return i32       Squared error
+ */
+i32 encode_bc4_indices(ui8 const* values, ui32 a0, ui32 a1, std::array<ui32, block_pixels>& indices) {
+    std::array<i32, 8> palette;
+    get_bc4_palette(a0, a1, palette);
+
+    std::array<i32, block_pixels> errors;
+    find_nearest_values(values, palette.data(), 8, indices, errors);
+
+    auto result = 0;
+    for (auto const error : errors)
+        result += error;
+
+    return result;
+}
+
+/**
+ * @brief Encode a BC4 block
+ *
+ * @param pixels     16 RGBA8 pixels
+ * @param channel    Source channel
+ * @param block      Target block (8 bytes)
+ */
+void encode_bc4_channel(ui8 const* pixels, ui32 channel, ui8* block) {
+    std::array<ui8, block_pixels> values;
+    ui8 min = 255, max = 0;
+    ui8 inner_min = 255, inner_max = 0;
+
+    for (auto i = 0u; i < block_pixels; ++i) {
+        auto const value = pixels[i * 4 + channel];
+        values[i] = value;
+
+        min = std::min(min, value);
+        max = std::max(max, value);
+
+        if (value != 0 && value != 255) {
+            inner_min = std::min(inner_min, value);
+            inner_max = std::max(inner_max, value);
+        }
+    }
+
+    std::array<ui32, block_pixels> indices{};
+    ui32 a0 = max, a1 = min;
+    auto error = encode_bc4_indices(values.data(), a0, a1, indices);
+
+    // 6 value mode with explicit 0 and 255
+    if (error > 0 && (min == 0 || max == 255)) {
+        if (inner_min > inner_max)
+            inner_min = inner_max = min == 0 ? 0 : 255;
+
+        std::array<ui32, block_pixels> six_indices{};
+        auto const six_error = encode_bc4_indices(values.data(), inner_min, inner_max, six_indices);
+        if (six_error < error) {
+            a0 = inner_min;
+            a1 = inner_max;
+            indices = six_indices;
+        }
+    }
+
+    memset(block, 0, 8);
+    block[0] = ui8(a0);
+    block[1] = ui8(a1);
+
+    block_writer writer{ block + 2 };
+    for (auto i = 0u; i < block_pixels; ++i)
+        writer.write(indices[i], 3);
+}
+
+/**
+ * @brief Decode a BC4 block
+ *
+ * @param block      Source block (8 bytes)
+ * @param pixels     16 RGBA8 pixels
+ * @param channel    Target channel
+ */
+void decode_bc4_channel(ui8 const* block, ui8* pixels, ui32 channel) {
+    std::array<i32, 8> palette;
+    get_bc4_palette(block[0], block[1], palette);
+
+    block_reader reader{ block + 2 };
+    for (auto i = 0u; i < block_pixels; ++i)
+        pixels[i * 4 + channel] = ui8(palette[reader.read(3)]);
+}
+
+/**
+ * @brief Decode a BC1 color block
+ *
+ * @param block           Source block (8 bytes)
+ * @param pixels          16 RGBA8 pixels
+ * @param always_four     Ignore 3 color mode (BC2, BC3)
+ */
+void decode_bc1_color(ui8 const* block, ui8* pixels, bool always_four) {
+    auto const c0 = ui32(block[0] | (block[1] << 8));
+    auto const c1 = ui32(block[2] | (block[3] << 8));
+
+    std::array<std::array<i32, 4>, 4> palette;
+    get_bc1_palette(c0, c1, always_four || c0 > c1, palette);
+
+    block_reader reader{ block + 4 };
+    for (auto i = 0u; i < block_pixels; ++i) {
+        auto const& color = palette[reader.read(2)];
+        for (auto c = 0u; c < 4; ++c)
+            pixels[i * 4 + c] = ui8(color[c]);
+    }
+}
+
+/**
+ * @brief Get the BC7 mode 6 palette
+ *
+ * @param e0         First endpoint (RGBA8)
+ * @param e1         Second endpoint (RGBA8)
+ * @param palette    Palette
+ */
+void get_bc7_palette(std::array<ui32, 4> const& e0, std::array<ui32, 4> const& e1,
+                     std::array<std::array<i32, 4>, 16>& palette) {
+    for (auto i = 0u; i < 16; ++i)
+        for (auto c = 0u; c < 4; ++c)
+            palette[i][c] = i32(((64 - bc7_weights[i]) * e0[c] + bc7_weights[i] * e1[c] + 32) >> 6);
+}
+
+/**
+ * @brief Quantize a BC7 mode 6 endpoint (7 bits + shared p-bit)
+ *
+ * @param endpoint    Float endpoint
+ * @param result      Quantized endpoint (7 bits)
+ * @param p_bit       Chosen p-bit
+ */
+void quantize_bc7_endpoint(std::array<r32, 4> const& endpoint, std::array<ui32, 4>& result, ui32& p_bit) {
+    auto best = std::numeric_limits<r32>::max();
+
+    for (auto p = 0u; p < 2; ++p) {
+        std::array<ui32, 4> quantized;
+        auto error = 0.f;
+
+        for (auto c = 0u; c < 4; ++c) {
+            quantized[c] = ui32(std::clamp((endpoint[c] - p) / 2.f + 0.5f, 0.f, 127.f));
+
+            auto const d = r32((quantized[c] << 1) | p) - endpoint[c];
+            error += d * d;
+        }
+
+        if (error < best) {
+            best = error;
+            result = quantized;
+            p_bit = p;
+        }
+    }
+}
+
+/**
+ * @brief Encode a BC7 block (mode 6)
+ *
+ * @param pixels    16 RGBA8 pixels
+ * @param block     Target block (16 bytes)
+ */
+void encode_bc7_block(ui8 const* pixels, ui8* block) {
+    std::array<std::array<r32, 4>, block_pixels> points;
+
+    std::array<ui8, 4> min_value, max_value;
+    get_block_bounds(pixels, min_value.data(), max_value.data());
+
+    std::array<r32, 4> min, max;
+    for (auto c = 0u; c < 4; ++c) {
+        min[c] = min_value[c];
+        max[c] = max_value[c];
+    }
+
+    for (auto i = 0u; i < block_pixels; ++i)
+        for (auto c = 0u; c < 4; ++c)
+            points[i][c] = pixels[i * 4 + c];
+
+    std::array<r32, 4> start, end;
+    get_endpoints<4>(points.data(), block_pixels, min, max, start, end);
+
+    std::array<ui32, 4> q0, q1;
+    ui32 p0 = 0, p1 = 0;
+    std::array<ui32, block_pixels> indices{};
+
+    auto encode = [&](std::array<r32, 4> const& a, std::array<r32, 4> const& b,
+                      std::array<ui32, 4>& qa, std::array<ui32, 4>& qb, ui32& pa, ui32& pb,
+                      std::array<ui32, block_pixels>& result) {
+        quantize_bc7_endpoint(a, qa, pa);
+        quantize_bc7_endpoint(b, qb, pb);
+
+        std::array<ui32, 4> e0, e1;
+        for (auto c = 0u; c < 4; ++c) {
+            e0[c] = (qa[c] << 1) | pa;
+            e1[c] = (qb[c] << 1) | pb;
+        }
+
+        std::array<std::array<i32, 4>, 16> palette;
+        get_bc7_palette(e0, e1, palette);
+
+        std::array<i32, block_pixels> errors;
+        find_nearest_colors(pixels, palette.data(), 16, true, result, errors);
+
+        auto error = 0;
+        for (auto const e : errors)
+            error += e;
+
+        return error;
+    };
+
+    auto error = encode(start, end, q0, q1, p0, p1, indices);
+
+    // least squares refinement of endpoints for the chosen indices
+    for (auto iteration = 0u; iteration < 2 && error > 0; ++iteration) {
+        r32 alpha_2 = 0.f, beta_2 = 0.f, alpha_beta = 0.f;
+        std::array<r32, 4> alpha_x{}, beta_x{};
+
+        for (auto i = 0u; i < block_pixels; ++i) {
+            auto const b = bc7_weights[indices[i]] / 64.f;
+            auto const a = 1.f - b;
+
+            alpha_2 += a * a;
+            beta_2 += b * b;
+            alpha_beta += a * b;
+
+            for (auto c = 0u; c < 4; ++c) {
+                alpha_x[c] += a * points[i][c];
+                beta_x[c] += b * points[i][c];
+            }
+        }
+
+        auto const determinant = alpha_2 * beta_2 - alpha_beta * alpha_beta;
+        if (std::abs(determinant) <= 1e-6f)
+            break;
+
+        std::array<r32, 4> refined_start, refined_end;
+        for (auto c = 0u; c < 4; ++c) {
+            refined_start[c] = std::clamp((alpha_x[c] * beta_2 - beta_x[c] * alpha_beta) / determinant, 0.f, 255.f);
+            refined_end[c] = std::clamp((beta_x[c] * alpha_2 - alpha_x[c] * alpha_beta) / determinant, 0.f, 255.f);
+        }
+
+        std::array<ui32, 4> r0, r1;
+        ui32 rp0 = 0, rp1 = 0;
+        std::array<ui32, block_pixels> refined_indices{};
+
+        auto const refined_error = encode(refined_start, refined_end, r0, r1, rp0, rp1, refined_indices);
+        if (refined_error >= error)
+            break;
+
+        error = refined_error;
+        q0 = r0;
+        q1 = r1;
+        p0 = rp0;
+        p1 = rp1;
+        indices = refined_indices;
+    }
+
+    // anchor index must have a zero high bit
+    if (indices[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+
+        for (auto& index : indices)
+            index = 15 - index;
+    }
+
+    memset(block, 0, 16);
+
+    block_writer writer{ block };
+    writer.write(1 << 6, 7);
+
+    for (auto c = 0u; c < 4; ++c) {
+        writer.write(q0[c], 7);
+        writer.write(q1[c], 7);
+    }
+
+    writer.write(p0, 1);
+    writer.write(p1, 1);
+
+    writer.write(indices[0], 3);
+    for (auto i = 1u; i < block_pixels; ++i)
+        writer.write(indices[i], 4);
+}
+
+/**
+ * @brief Decode a BC7 block (mode 6 only, other modes are black)
+ *
+ * @param block     Source block (16 bytes)
+ * @param pixels    16 RGBA8 pixels
+ */
+void decode_bc7_block(ui8 const* block, ui8* pixels) {
+    block_reader reader{ block };
+
+    if (reader.read(7) != (1 << 6)) {
+        memset(pixels, 0, block_pixels * 4);
+        return;
+    }
+
+    std::array<ui32, 4> e0, e1;
+    for (auto c = 0u; c < 4; ++c) {
+        e0[c] = reader.read(7) << 1;
+        e1[c] = reader.read(7) << 1;
+    }
+
+    auto const p0 = reader.read(1);
+    auto const p1 = reader.read(1);
+
+    for (auto c = 0u; c < 4; ++c) {
+        e0[c] |= p0;
+        e1[c] |= p1;
+    }
+
+    std::array<std::array<i32, 4>, 16> palette;
+    get_bc7_palette(e0, e1, palette);
+
+    for (auto i = 0u; i < block_pixels; ++i) {
+        auto const& color = palette[reader.read(i == 0 ? 3 : 4)];
+        for (auto c = 0u; c < 4; ++c)
+            pixels[i * 4 + c] = ui8(color[c]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool bc_encode_supported(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+ui32 get_bc_block_size(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        return 8;
+
+    default:
+        return 16;
+    }
+}
+
+//-----------------------------------------------------------------------------
+size_t get_bc_size(VkFormat format, uv2 size) {
+    auto const blocks_x = (size.x + 3) / 4;
+    auto const blocks_y = (size.y + 3) / 4;
+
+    return size_t(blocks_x) * blocks_y * get_bc_block_size(format);
+}
+
+//-----------------------------------------------------------------------------
+void encode_bc_block(VkFormat format, ui8 const* pixels, ui8* block) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        encode_bc1_color(pixels, block, false);
+        break;
+
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        encode_bc1_color(pixels, block, true);
+        break;
+
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        encode_bc4_channel(pixels, 3, block);
+        encode_bc1_color(pixels, block + 8, false);
+        break;
+
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        encode_bc4_channel(pixels, 0, block);
+        break;
+
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        encode_bc4_channel(pixels, 0, block);
+        encode_bc4_channel(pixels, 1, block + 8);
+        break;
+
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        encode_bc7_block(pixels, block);
+        break;
+
+    default:
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void decode_bc_block(VkFormat format, ui8 const* block, ui8* pixels) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        decode_bc1_color(block, pixels, false);
+        break;
+
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        decode_bc1_color(block + 8, pixels, true);
+        decode_bc4_channel(block, pixels, 3);
+        break;
+
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        for (auto i = 0u; i < block_pixels; ++i) {
+            pixels[i * 4 + 1] = pixels[i * 4 + 2] = 0;
+            pixels[i * 4 + 3] = 255;
+        }
+
+        decode_bc4_channel(block, pixels, 0);
+        break;
+
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        for (auto i = 0u; i < block_pixels; ++i) {
+            pixels[i * 4 + 2] = 0;
+            pixels[i * 4 + 3] = 255;
+        }
+
+        decode_bc4_channel(block, pixels, 0);
+        decode_bc4_channel(block + 8, pixels, 1);
+        break;
+
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        decode_bc7_block(block, pixels);
+        break;
+
+    default:
+        memset(pixels, 0, block_pixels * 4);
+        break;
+    }
+}
+
+/**
+ * @brief Block encoding job shared with the encoder threads
+ */
+struct bc_encode_job {
+    /**
+     * @brief Encode rows of blocks until all rows are taken
+     */
+    void run() {
+        std::array<ui8, block_pixels * 4> block_data;
+        auto encoded = 0u;
+
+        for (auto row = next_row++; row < blocks_y; row = next_row++, ++encoded) {
+            auto* block = target + size_t(row) * blocks_x * block_size;
+
+            for (auto column = 0u; column < blocks_x; ++column, block += block_size) {
+                for (auto y = 0u; y < 4; ++y) {
+                    auto const source_y = std::min(row * 4 + y, size.y - 1);
+
+                    for (auto x = 0u; x < 4; ++x) {
+                        auto const source_x = std::min(column * 4 + x, size.x - 1);
+                        memcpy(&block_data[(y * 4 + x) * 4], source + (size_t(source_y) * size.x + source_x) * 4, 4);
+                    }
+                }
+
+                encode_bc_block(format, block_data.data(), block);
+            }
+        }
+
+        if (encoded == 0)
+            return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        encoded_rows += encoded;
+        if (encoded_rows == blocks_y)
+            condition.notify_all();
+    }
+
+    /**
+     * @brief Wait until all rows are encoded
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return encoded_rows == blocks_y; });
+    }
+
+    /// Block compression format
+    VkFormat format = VK_FORMAT_UNDEFINED;
+
+    /// Source pixels (RGBA8)
+    ui8 const* source = nullptr;
+
+    /// Target blocks
+    ui8* target = nullptr;
+
+    /// Image size
+    uv2 size = {};
+
+    /// Number of blocks in a row
+    ui32 blocks_x = 0;
+
+    /// Number of block rows
+    ui32 blocks_y = 0;
+
+    /// Block size in bytes
+    ui32 block_size = 0;
+
+    /// Next row to encode
+    std::atomic<ui32> next_row = 0;
+
+    /// Number of encoded rows
+    ui32 encoded_rows = 0;
+
+    /// Encoded rows mutex
+    std::mutex mutex;
+
+    /// Encoded rows condition
+    std::condition_variable condition;
+};
+
+/**
+ * @brief Encoder thread pool (shared by all encode calls)
+ */
+struct bc_encode_pool {
+    /**
+     * @brief Construct a new encoder thread pool
+     */
+    bc_encode_pool() {
+        // workers free their ids on teardown, keep the id pool alive until then
+        ids::global();
+
+        count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        pool.setup(count);
+    }
+
+    /**
+     * @brief Destroy the encoder thread pool
+     */
+    ~bc_encode_pool() {
+        pool.teardown();
+    }
+
+    /**
+     * @brief Get the encoder thread pool
+     *
+     * @return bc_encode_pool&    Encoder thread pool
+     */
+    static bc_encode_pool& get() {
+        static bc_encode_pool instance;
+        return instance;
+    }
+
+    /// Thread pool
+    thread_pool pool;
+
+    /// Number of threads
+    ui32 count = 0;
+};
+
+//-----------------------------------------------------------------------------
+bool encode_bc(VkFormat format, data_cptr pixels, uv2 size, data_ptr target, ui32 thread_count) {
+    if (!bc_encode_supported(format) || size.x == 0 || size.y == 0)
+        return false;
+
+    auto job = std::make_shared<bc_encode_job>();
+    job->format = format;
+    job->source = (ui8 const*) pixels;
+    job->target = (ui8*) target;
+    job->size = size;
+    job->blocks_x = (size.x + 3) / 4;
+    job->blocks_y = (size.y + 3) / 4;
+    job->block_size = get_bc_block_size(format);
+
+    if (thread_count == 0)
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    thread_count = std::min(thread_count, job->blocks_y);
+
+    if (thread_count > 1) {
+        auto& encoders = bc_encode_pool::get();
+
+        // late workers find no rows left and only touch the shared job
+        for (auto i = 1u; i < std::min(thread_count, encoders.count + 1); ++i)
+            encoders.pool.enqueue([job](id::ref) { job->run(); });
+    }
+
+    // the calling thread encodes as well, so busy workers never stall the call
+    job->run();
+    job->wait();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool decode_bc(VkFormat format, data_cptr data, uv2 size, data_ptr pixels) {
+    if (!bc_encode_supported(format))
+        return false;
+
+    auto const blocks_x = (size.x + 3) / 4;
+    auto const blocks_y = (size.y + 3) / 4;
+    auto const block_size = get_bc_block_size(format);
+
+    auto const* block = (ui8 const*) data;
+    auto* target = (ui8*) pixels;
+
+    std::array<ui8, block_pixels * 4> block_data;
+
+    for (auto row = 0u; row < blocks_y; ++row) {
+        for (auto column = 0u; column < blocks_x; ++column, block += block_size) {
+            decode_bc_block(format, block, block_data.data());
+
+            for (auto y = 0u; y < 4 && row * 4 + y < size.y; ++y)
+                for (auto x = 0u; x < 4 && column * 4 + x < size.x; ++x)
+                    memcpy(target + (size_t(row * 4 + y) * size.x + column * 4 + x) * 4, &block_data[(y * 4 + x) * 4], 4);
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+r64 calculate_psnr(data_cptr a, data_cptr b, uv2 size, ui32 channel_mask) {
+    auto const* first = (ui8 const*) a;
+    auto const* second = (ui8 const*) b;
+
+    r64 error = 0.0;
+    auto count = 0ull;
+
+    for (size_t i = 0; i < size_t(size.x) * size.y; ++i) {
+        for (auto c = 0u; c < 4; ++c) {
+            if (!(channel_mask & (1 << c)))
+                continue;
+
+            auto const d = r64(first[i * 4 + c]) - r64(second[i * 4 + c]);
+            error += d * d;
+            ++count;
+        }
+    }
+
+    if (count == 0 || error == 0.0)
+        return std::numeric_limits<r64>::max();
+
+    return 10.0 * std::log10(255.0 * 255.0 / (error / count));
+}
+
+} // namespace lava
@@ -0,0 +1,107 @@
+/**
+ * @file         liblava/asset/bc_encoder.hpp
+ * @brief        Block compression encoder (BC1, BC3, BC4, BC5, BC7)
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/core/data.hpp>
+#include <liblava/core/math.hpp>
+#include <liblava/resource/format.hpp>
+
+namespace lava {
+
+/**
+ * @brief Check if a format can be encoded
+ *
+ * BC1 (RGB/RGBA), BC3, BC4 (UNORM), BC5 (UNORM) and BC7 (mode 6)
+ *
+ * @param format    Target format
+ *
+ * @return true     Format is supported
+ * @return false    Format is not supported
+ */
+bool bc_encode_supported(VkFormat format);
+
+/**
+ * @brief Get the size of a block
+ *
+ * @param format     Block compression format
+ *
+ * @return ui32      Block size in bytes (8 or 16)
+ */
+ui32 get_bc_block_size(VkFormat format);
+
+/**
+ * @brief Get the size of an encoded image
+ *
+ * @param format     Block compression format
+ * @param size       Image size
+ *
+ * @return size_t    Size of encoded data
+ */
+size_t get_bc_size(VkFormat format, uv2 size);
+
+/**
+ * @brief Encode a 4x4 block
+ *
+ * @param format    Block compression format
+ * @param pixels    16 RGBA8 pixels (row major)
+ * @param block     Target block
+ */
+void encode_bc_block(VkFormat format, ui8 const* pixels, ui8* block);
+
+/**
+ * @brief Decode a 4x4 block
+ *
+ * @param format    Block compression format
+ * @param block     Source block
+ * @param pixels    16 RGBA8 pixels (row major)
+ */
+void decode_bc_block(VkFormat format, ui8 const* block, ui8* pixels);
+
+/**
+ * @brief Encode a RGBA8 image
+ *
+ * Rows of blocks are encoded in parallel on a shared encoder thread pool and the calling
+ * thread, edge blocks repeat the last row and column.
+ *
+ * @param format          Block compression format
+ * @param pixels          RGBA8 pixels
+ * @param size            Image size
+ * @param target          Target data (get_bc_size)
+ * @param thread_count    Number of threads (0: hardware concurrency)
+ *
+ * @return true           Encode was successful
+ * @return false          Format is not supported
+ */
+bool encode_bc(VkFormat format, data_cptr pixels, uv2 size, data_ptr target, ui32 thread_count = 0);
+
+/**
+ * @brief Decode an image to RGBA8
+ *
+ * @param format    Block compression format
+ * @param data      Encoded data
+ * @param size      Image size
+ * @param pixels    Target RGBA8 pixels
+ *
+ * @return true     Decode was successful
+ * @return false    Format is not supported
+ */
+bool decode_bc(VkFormat format, data_cptr data, uv2 size, data_ptr pixels);
+
+/**
+ * @brief Calculate the peak signal to noise ratio of two RGBA8 images
+ *
+ * @param a               First image
+ * @param b               Second image
+ * @param size            Image size
+ * @param channel_mask    Compared channels (bit 0: red ... bit 3: alpha)
+ *
+ * @return r64            PSNR in dB (max for identical images)
+ */
+r64 calculate_psnr(data_cptr a, data_cptr b, uv2 size, ui32 channel_mask = 0xf);
+
+} // namespace lava
@@ -0,0 +1,875 @@
+/**
+ * @file         liblava/asset/gltf_loader.cpp
+ * @brief        Load glTF 2.0 model from file
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/asset/asset_cache.hpp>
+#include <liblava/asset/gltf_loader.hpp>
+#include <liblava/file.hpp>
+
+namespace lava {
+
+/// GLB header magic ("glTF")
+constexpr ui32 const glb_magic = 0x46546c67;
+
+/// GLB JSON chunk type
+constexpr ui32 const glb_chunk_json = 0x4e4f534a;
+
+/// GLB binary chunk type
+constexpr ui32 const glb_chunk_bin = 0x004e4942;
+
+/// glTF triangle list mode
+constexpr ui32 const gltf_mode_triangles = 4;
+
+/**
+ * @brief glTF component types
+ */
+enum gltf_component_type : ui32 {
+    gltf_byte = 5120,
+    gltf_unsigned_byte = 5121,
+    gltf_short = 5122,
+    gltf_unsigned_short = 5123,
+    gltf_unsigned_int = 5125,
+    gltf_float = 5126,
+};
+
+/// View into loaded buffer data
+using gltf_buffer_view = std::pair<data_cptr, size_t>;
+
+//-----------------------------------------------------------------------------
+ui32 gltf_accessor::get_element_size() const {
+    switch (component_type) {
+    case gltf_byte:
+    case gltf_unsigned_byte:
+        return component_count;
+    case gltf_short:
+    case gltf_unsigned_short:
+        return component_count * 2;
+    default:
+        return component_count * 4;
+    }
+}
+
+/**
+ * @brief Get the number of components of an accessor type
+ *
+ * @param type     Accessor type (e.g. "VEC3")
+ *
+ * @return ui32    Number of components (0: unknown)
+ */
+ui32 get_component_count(string_ref type) {
+    static std::map<string, ui32> const counts = {
+        { "SCALAR", 1 }, { "VEC2", 2 }, { "VEC3", 3 }, { "VEC4", 4 }, { "MAT2", 4 }, { "MAT3", 9 }, { "MAT4", 16 }
+    };
+
+    auto const it = counts.find(type);
+    return it != counts.end() ? it->second : 0;
+}
+
+/**
+ * @brief Read a component of an accessor as float
+ *
+ * @param data              Component data
+ * @param component_type    Component type
+ * @param normalized        Integer is normalized
+ *
+ * @return r32              Component value
+ */
+r32 read_component(data_cptr data, ui32 component_type, bool normalized) {
+    switch (component_type) {
+    case gltf_byte: {
+        auto const value = *(i8 const*) data;
+        return normalized ? std::max(value / 127.f, -1.f) : r32(value);
+    }
+    case gltf_unsigned_byte: {
+        auto const value = *(ui8 const*) data;
+        return normalized ? value / 255.f : r32(value);
+    }
+    case gltf_short: {
+        i16 value;
+        memcpy(&value, data, sizeof(value));
+        return normalized ? std::max(value / 32767.f, -1.f) : r32(value);
+    }
+    case gltf_unsigned_short: {
+        ui16 value;
+        memcpy(&value, data, sizeof(value));
+        return normalized ? value / 65535.f : r32(value);
+    }
+    case gltf_unsigned_int: {
+        ui32 value;
+        memcpy(&value, data, sizeof(value));
+        return r32(value);
+    }
+    default: {
+        r32 value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    }
+}
+
+/**
+ * @brief Read an element of an accessor as floats
+ *
+ * @param accessor      Source accessor
+ * @param element       Element index
+ * @param result        Target floats
+ * @param count         Number of target floats (missing components are kept)
+ */
+void read_element(gltf_accessor const& accessor, ui32 element, r32* result, ui32 count) {
+    auto const* data = accessor.data + size_t(element) * accessor.stride;
+    count = std::min(count, accessor.component_count);
+
+    if (accessor.component_type == gltf_float) {
+        memcpy(result, data, count * sizeof(r32));
+        return;
+    }
+
+    auto const component_size = accessor.get_element_size() / accessor.component_count;
+    for (auto i = 0u; i < count; ++i)
+        result[i] = read_component(data + i * component_size, accessor.component_type, accessor.normalized);
+}
+
+/**
+ * @brief Read an element of an index accessor
+ *
+ * @param accessor    Source accessor (unsigned byte, short or int)
+ * @param element     Element index
+ *
+ * @return ui32       Index
+ */
+ui32 read_index(gltf_accessor const& accessor, ui32 element) {
+    auto const* data = accessor.data + size_t(element) * accessor.stride;
+
+    switch (accessor.component_type) {
+    case gltf_unsigned_byte:
+        return *(ui8 const*) data;
+    case gltf_unsigned_short: {
+        ui16 value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    default: {
+        ui32 value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    }
+}
+
+/**
+ * @brief Decode base64 data
+ *
+ * @param text      Base64 text
+ * @param result    Decoded data
+ *
+ * @return true     Decode was successful
+ * @return false    Invalid character
+ */
+bool decode_base64(string_view text, std::vector<char>& result) {
+    auto decode = [](char c) -> i32 {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        if (c == '+' || c == '-')
+            return 62;
+        if (c == '/' || c == '_')
+            return 63;
+        return -1;
+    };
+
+    result.clear();
+    result.reserve(text.size() / 4 * 3);
+
+    ui32 bits = 0;
+    auto bit_count = 0;
+
+    for (auto c : text) {
+        if (c == '=')
+            break;
+
+        auto const value = decode(c);
+        if (value < 0)
+            return false;
+
+        bits = (bits << 6) | ui32(value);
+        bit_count += 6;
+
+        if (bit_count >= 8) {
+            bit_count -= 8;
+            result.push_back(char((bits >> bit_count) & 0xff));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decode percent encoded characters of an uri
+ *
+ * @param uri       Uri to decode
+ * @param result    Decoded uri
+ *
+ * @return true     Decode was successful
+ * @return false    Invalid escape sequence
+ */
+bool decode_uri(string_view uri, string& result) {
+    auto decode = [](char c) -> i32 {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    };
+
+    result.clear();
+    result.reserve(uri.size());
+
+    for (auto i = 0u; i < uri.size(); ++i) {
+        if (uri[i] != '%') {
+            result += uri[i];
+            continue;
+        }
+
+        if (i + 2 >= uri.size())
+            return false;
+
+        auto const high = decode(uri[i + 1]);
+        auto const low = decode(uri[i + 2]);
+        if (high < 0 || low < 0)
+            return false;
+
+        result += char((high << 4) | low);
+        i += 2;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read a whole file
+ *
+ * @param filename    File to read
+ * @param result      File data
+ *
+ * @return true       Read was successful
+ * @return false      Read failed
+ */
+bool read_gltf_file(string_ref filename, std::vector<char>& result) {
+    file file(str(filename));
+    if (!file.opened())
+        return false;
+
+    result.resize(to_size_t(file.get_size()));
+    return !file_error(file.read(result.data()));
+}
+
+/**
+ * @brief Load the buffers of a glTF model
+ *
+ * @param model         Target model (buffer storage)
+ * @param root          glTF json
+ * @param directory     Directory of glTF file
+ * @param glb_chunk     GLB binary chunk
+ * @param result        Buffer views
+ *
+ * @return true         Load was successful
+ * @return false        Load failed
+ */
+bool load_gltf_buffers(gltf_model& model, json const& root, fs::path const& directory,
+                       gltf_buffer_view glb_chunk, std::vector<gltf_buffer_view>& result) {
+    if (!root.contains("buffers"))
+        return true;
+
+    for (auto const& buffer : root["buffers"]) {
+        auto const byte_length = buffer.value("byteLength", size_t(0));
+
+        if (!buffer.contains("uri")) {
+            if (!glb_chunk.first || glb_chunk.second < byte_length) {
+                log()->error("gltf buffer without binary chunk");
+                return false;
+            }
+
+            result.push_back(glb_chunk);
+            continue;
+        }
+
+        auto const uri = buffer["uri"].get<string>();
+        std::vector<char> data;
+
+        if (uri.starts_with("data:")) {
+            auto const comma = uri.find(',');
+            if (comma == string::npos || !decode_base64(string_view(uri).substr(comma + 1), data)) {
+                log()->error("gltf buffer data uri");
+                return false;
+            }
+        } else {
+            string path;
+            if (!decode_uri(uri, path) || !read_gltf_file((directory / path).string(), data)) {
+                log()->error("gltf buffer file {}", uri);
+                return false;
+            }
+        }
+
+        if (data.size() < byte_length) {
+            log()->error("gltf buffer size {}", uri);
+            return false;
+        }
+
+        model.buffer_storage.push_back(std::move(data));
+
+        auto const& storage = model.buffer_storage.back();
+        result.emplace_back(storage.data(), byte_length);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Load the accessors of a glTF model
+ *
+ * @param model       Target model
+ * @param root        glTF json
+ * @param buffers     Buffer views
+ *
+ * @return true       Load was successful
+ * @return false      Load failed
+ */
+bool load_gltf_accessors(gltf_model& model, json const& root, std::vector<gltf_buffer_view> const& buffers) {
+    if (!root.contains("accessors"))
+        return true;
+
+    auto const& buffer_views = root.value("bufferViews", json::array());
+
+    for (auto const& item : root["accessors"]) {
+        gltf_accessor accessor;
+        accessor.count = item.value("count", 0u);
+        accessor.component_type = item.value("componentType", 0u);
+        accessor.component_count = get_component_count(item.value("type", string()));
+        accessor.normalized = item.value("normalized", false);
+
+        if (accessor.component_count == 0 || accessor.component_type < gltf_byte || accessor.component_type > gltf_float) {
+            log()->error("gltf accessor type");
+            return false;
+        }
+
+        accessor.stride = accessor.get_element_size();
+
+        if (item.contains("sparse"))
+            log()->warn("gltf sparse accessors are not supported");
+
+        if (!item.contains("bufferView")) {
+            model.accessors.push_back(accessor);
+            continue;
+        }
+
+        auto const& view = buffer_views.at(item["bufferView"].get<size_t>());
+        auto const& buffer = buffers.at(view["buffer"].get<size_t>());
+
+        auto const view_offset = view.value("byteOffset", size_t(0));
+        auto const view_length = view.value("byteLength", size_t(0));
+
+        if (view.contains("byteStride"))
+            accessor.stride = view["byteStride"].get<ui32>();
+
+        auto const offset = view_offset + item.value("byteOffset", size_t(0));
+        auto const end = accessor.count > 0 ? offset + size_t(accessor.count - 1) * accessor.stride + accessor.get_element_size()
+                                            : offset;
+
+        if (view_offset + view_length > buffer.second || end > view_offset + view_length) {
+            log()->error("gltf accessor out of range");
+            return false;
+        }
+
+        accessor.data = buffer.first + offset;
+        model.accessors.push_back(accessor);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get an accessor of a primitive attribute
+ *
+ * @param model                  glTF model
+ * @param attributes             Primitive attributes
+ * @param attribute              Attribute name
+ *
+ * @return gltf_accessor const*  Accessor (nullptr: not available)
+ */
+gltf_accessor const* get_attribute(gltf_model const& model, json const& attributes, name attribute) {
+    if (!attributes.contains(attribute))
+        return nullptr;
+
+    auto const& accessor = model.accessors.at(attributes[attribute].get<size_t>());
+    return accessor.data ? &accessor : nullptr;
+}
+
+/**
+ * @brief Create the mesh of a glTF primitive
+ *
+ * @param device        Vulkan device
+ * @param model         glTF model
+ * @param primitive     Primitive json
+ *
+ * @return mesh::ptr    Created mesh
+ */
+mesh::ptr create_gltf_mesh(device_ptr device, gltf_model const& model, json const& primitive) {
+    if (primitive.value("mode", gltf_mode_triangles) != gltf_mode_triangles) {
+        log()->warn("gltf primitive mode is not supported (triangles only)");
+        return nullptr;
+    }
+
+    auto const& attributes = primitive["attributes"];
+
+    auto const* positions = get_attribute(model, attributes, "POSITION");
+    if (!positions || positions->component_count != 3)
+        return nullptr;
+
+    auto const* normals = get_attribute(model, attributes, "NORMAL");
+    auto const* uvs = get_attribute(model, attributes, "TEXCOORD_0");
+    auto const* colors = get_attribute(model, attributes, "COLOR_0");
+
+    auto mesh = make_mesh();
+
+    auto& vertices = mesh->get_vertices();
+    vertices.resize(positions->count);
+
+    for (auto i = 0u; i < positions->count; ++i) {
+        auto& vertex = vertices[i];
+
+        read_element(*positions, i, &vertex.position.x, 3);
+
+        vertex.color = v4(1.f);
+        if (colors && i < colors->count)
+            read_element(*colors, i, &vertex.color.x, 4);
+
+        vertex.uv = v2(0.f);
+        if (uvs && i < uvs->count)
+            read_element(*uvs, i, &vertex.uv.x, 2);
+
+        vertex.normal = v3(0.f);
+        if (normals && i < normals->count)
+            read_element(*normals, i, &vertex.normal.x, 3);
+    }
+
+    if (primitive.contains("indices")) {
+        auto const& accessor = model.accessors.at(primitive["indices"].get<size_t>());
+        if (!accessor.data)
+            return nullptr;
+
+        auto& indices = mesh->get_indices();
+        indices.resize(accessor.count);
+
+        if (accessor.component_type != gltf_unsigned_byte && accessor.component_type != gltf_unsigned_short
+            && accessor.component_type != gltf_unsigned_int) {
+            log()->error("gltf index component type {}", accessor.component_type);
+            return nullptr;
+        }
+
+        if (accessor.component_type == gltf_unsigned_int && accessor.packed()) {
+            memcpy(indices.data(), accessor.data, indices.size() * sizeof(ui32));
+        } else {
+            for (auto i = 0u; i < accessor.count; ++i)
+                indices[i] = read_index(accessor, i);
+        }
+
+        for (auto index : indices) {
+            if (index >= positions->count) {
+                log()->error("gltf index out of range");
+                return nullptr;
+            }
+        }
+    }
+
+    if (!mesh->create(device))
+        return nullptr;
+
+    return mesh;
+}
+
+/**
+ * @brief Get the texture index of a material texture
+ *
+ * @param material    Material json
+ * @param texture     Texture name
+ *
+ * @return i32        Texture index (-1: none)
+ */
+i32 get_texture_index(json const& material, name texture) {
+    if (!material.contains(texture))
+        return -1;
+
+    return material[texture].value("index", -1);
+}
+
+/**
+ * @brief Load the materials of a glTF model
+ *
+ * @param model    Target model
+ * @param root     glTF json
+ */
+void load_gltf_materials(gltf_model& model, json const& root) {
+    if (!root.contains("materials"))
+        return;
+
+    for (auto const& item : root["materials"]) {
+        gltf_material material;
+        material.name = item.value("name", string());
+
+        if (item.contains("pbrMetallicRoughness")) {
+            auto const& pbr = item["pbrMetallicRoughness"];
+
+            if (pbr.contains("baseColorFactor"))
+                for (auto i = 0u; i < 4; ++i)
+                    material.base_color_factor[i] = pbr["baseColorFactor"][i].get<r32>();
+
+            material.metallic_factor = pbr.value("metallicFactor", 1.f);
+            material.roughness_factor = pbr.value("roughnessFactor", 1.f);
+            material.base_color_texture = get_texture_index(pbr, "baseColorTexture");
+            material.metallic_roughness_texture = get_texture_index(pbr, "metallicRoughnessTexture");
+        }
+
+        if (item.contains("emissiveFactor"))
+            for (auto i = 0u; i < 3; ++i)
+                material.emissive_factor[i] = item["emissiveFactor"][i].get<r32>();
+
+        material.normal_texture = get_texture_index(item, "normalTexture");
+        material.occlusion_texture = get_texture_index(item, "occlusionTexture");
+        material.emissive_texture = get_texture_index(item, "emissiveTexture");
+
+        model.materials.push_back(material);
+    }
+}
+
+/**
+ * @brief Get the file of an embedded image (extracted to the asset cache)
+ *
+ * @param data         Image data
+ * @param size         Size of data
+ * @param mime_type    Mime type of image
+ *
+ * @return string      Image file (empty: asset cache is not activated)
+ */
+string get_embedded_image_file(data_cptr data, size_t size, string_ref mime_type) {
+    auto& cache = asset_cache::instance();
+    if (!cache.activated())
+        return {};
+
+    auto const key = asset_cache::make_key(asset_cache::hash(data, size),
+                                           mime_type == "image/jpeg" ? "gltf.jpg" : "gltf.png");
+
+    if (!cache.exists(key) && !cache.save(key, data, size))
+        return {};
+
+    return (fs::path(cache.get_path()) / key).string();
+}
+
+/**
+ * @brief Load the images and textures of a glTF model
+ *
+ * @param model        Target model
+ * @param root         glTF json
+ * @param directory    Directory of glTF file
+ * @param buffers      Buffer views
+ */
+void load_gltf_images(gltf_model& model, json const& root, fs::path const& directory,
+                      std::vector<gltf_buffer_view> const& buffers) {
+    if (root.contains("textures"))
+        for (auto const& item : root["textures"])
+            model.texture_images.push_back(item.value("source", -1));
+
+    if (!root.contains("images"))
+        return;
+
+    auto const& buffer_views = root.value("bufferViews", json::array());
+
+    // color textures are sRGB, data textures are linear
+    std::vector<bool> linear_images(root["images"].size(), false);
+    for (auto const& material : model.materials) {
+        for (auto texture : { material.metallic_roughness_texture, material.normal_texture, material.occlusion_texture }) {
+            if (texture < 0 || texture >= to_i32(model.texture_images.size()))
+                continue;
+
+            auto const image = model.texture_images[texture];
+            if (image >= 0 && image < to_i32(linear_images.size()))
+                linear_images[image] = true;
+        }
+    }
+
+    for (auto const& item : root["images"]) {
+        file_format image;
+        image.format = linear_images[model.images.size()] ? VK_FORMAT_R8G8B8A8_UNORM
+                                                          : VK_FORMAT_R8G8B8A8_SRGB;
+
+        if (item.contains("uri")) {
+            auto const uri = item["uri"].get<string>();
+
+            if (uri.starts_with("data:")) {
+                std::vector<char> data;
+                auto const comma = uri.find(',');
+
+                if (comma != string::npos && decode_base64(string_view(uri).substr(comma + 1), data))
+                    image.path = get_embedded_image_file(data.data(), data.size(),
+                                                         uri.substr(5, uri.find_first_of(";,") - 5));
+            } else {
+                string path;
+                if (decode_uri(uri, path))
+                    image.path = (directory / path).string();
+            }
+        } else if (item.contains("bufferView")) {
+            auto const& view = buffer_views.at(item["bufferView"].get<size_t>());
+            auto const& buffer = buffers.at(view["buffer"].get<size_t>());
+
+            auto const offset = view.value("byteOffset", size_t(0));
+            auto const length = view.value("byteLength", size_t(0));
+
+            if (offset + length <= buffer.second)
+                image.path = get_embedded_image_file(buffer.first + offset, length,
+                                                     item.value("mimeType", string()));
+        }
+
+        if (image.path.empty())
+            log()->warn("gltf image {} not available", model.images.size());
+
+        model.images.push_back(image);
+    }
+}
+
+//-----------------------------------------------------------------------------
+texture::ptr gltf_model::get_texture(i32 texture) const {
+    if (!textures || texture < 0 || texture >= to_i32(texture_images.size()))
+        return nullptr;
+
+    auto const image = texture_images[texture];
+    if (image < 0 || image >= to_i32(textures->get_textures().size()))
+        return nullptr;
+
+    return textures->get_textures()[image];
+}
+
+//-----------------------------------------------------------------------------
+void gltf_model::traverse(node_func func, mat4 const& matrix) const {
+    std::function<void(index, mat4 const&)> visit = [&](index node, mat4 const& parent) {
+        auto const world = parent * nodes[node].matrix;
+        func(node, world);
+
+        for (auto child : nodes[node].children)
+            visit(child, world);
+    };
+
+    for (auto root : roots)
+        visit(root, matrix);
+}
+
+/**
+ * @brief Get the local matrix of a glTF node
+ *
+ * @param node     Node json
+ *
+ * @return mat4    Local matrix
+ */
+mat4 get_node_matrix(json const& node) {
+    mat4 result(1.f);
+
+    if (node.contains("matrix")) {
+        for (auto c = 0u; c < 4; ++c)
+            for (auto r = 0u; r < 4; ++r)
+                result[c][r] = node["matrix"][c * 4 + r].get<r32>();
+
+        return result;
+    }
+
+    v3 translation(0.f);
+    v4 rotation(0.f, 0.f, 0.f, 1.f);
+    v3 scale(1.f);
+
+    if (node.contains("translation"))
+        for (auto i = 0u; i < 3; ++i)
+            translation[i] = node["translation"][i].get<r32>();
+
+    if (node.contains("rotation"))
+        for (auto i = 0u; i < 4; ++i)
+            rotation[i] = node["rotation"][i].get<r32>();
+
+    if (node.contains("scale"))
+        for (auto i = 0u; i < 3; ++i)
+            scale[i] = node["scale"][i].get<r32>();
+
+    // rotation quaternion (x, y, z, w) to matrix, columns scaled
+    auto const x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+
+    result[0] = v4(1.f - 2.f * (y * y + z * z), 2.f * (x * y + z * w), 2.f * (x * z - y * w), 0.f) * scale.x;
+    result[1] = v4(2.f * (x * y - z * w), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + x * w), 0.f) * scale.y;
+    result[2] = v4(2.f * (x * z + y * w), 2.f * (y * z - x * w), 1.f - 2.f * (x * x + y * y), 0.f) * scale.z;
+    result[3] = v4(translation, 1.f);
+
+    return result;
+}
+
+/**
+ * @brief Load the nodes and the scene of a glTF model
+ *
+ * @param model    Target model
+ * @param root     glTF json
+ */
+void load_gltf_nodes(gltf_model& model, json const& root) {
+    if (root.contains("nodes")) {
+        for (auto const& item : root["nodes"]) {
+            gltf_node node;
+            node.name = item.value("name", string());
+            node.matrix = get_node_matrix(item);
+            node.mesh = item.value("mesh", -1);
+
+            if (item.contains("children"))
+                for (auto const& child : item["children"])
+                    node.children.push_back(child.get<index>());
+
+            model.nodes.push_back(node);
+        }
+    }
+
+    auto const scene = root.value("scene", 0u);
+
+    if (root.contains("scenes") && scene < root["scenes"].size()) {
+        for (auto const& node : root["scenes"][scene].value("nodes", json::array()))
+            model.roots.push_back(node.get<index>());
+
+        return;
+    }
+
+    // no scene: all nodes without parent
+    std::vector<bool> has_parent(model.nodes.size(), false);
+    for (auto const& node : model.nodes)
+        for (auto child : node.children)
+            has_parent.at(child) = true;
+
+    for (auto i = 0u; i < model.nodes.size(); ++i)
+        if (!has_parent[i])
+            model.roots.push_back(i);
+}
+
+//-----------------------------------------------------------------------------
+gltf_model::ptr load_gltf(device_ptr device, string_ref filename, bool load_images, ui32 thread_count) {
+    if (!extension(str(filename), { "GLTF", "GLB" }))
+        return nullptr;
+
+    auto model = std::make_shared<gltf_model>();
+
+    std::vector<char> file_data;
+    if (!read_gltf_file(filename, file_data)) {
+        log()->error("load gltf file {}", filename);
+        return nullptr;
+    }
+
+    json root;
+    gltf_buffer_view glb_chunk{ nullptr, 0 };
+
+    ui32 header[3] = {};
+    if (file_data.size() >= sizeof(header))
+        memcpy(header, file_data.data(), sizeof(header));
+
+    try {
+        if (header[0] == glb_magic) {
+            if (header[1] != 2 || header[2] > file_data.size()) {
+                log()->error("gltf binary header {}", filename);
+                return nullptr;
+            }
+
+            for (size_t offset = sizeof(header); offset + 8 <= header[2];) {
+                ui32 chunk[2];
+                memcpy(chunk, file_data.data() + offset, sizeof(chunk));
+
+                auto const* chunk_data = file_data.data() + offset + sizeof(chunk);
+                if (offset + sizeof(chunk) + chunk[0] > header[2])
+                    break;
+
+                if (chunk[1] == glb_chunk_json)
+                    root = json::parse(chunk_data, chunk_data + chunk[0]);
+                else if (chunk[1] == glb_chunk_bin && !glb_chunk.first)
+                    glb_chunk = { chunk_data, chunk[0] };
+
+                offset += sizeof(chunk) + chunk[0];
+            }
+        } else {
+            root = json::parse(file_data.begin(), file_data.end());
+        }
+    } catch (json::exception const& e) {
+        log()->error("parse gltf {}: {}", filename, e.what());
+        return nullptr;
+    }
+
+    // binary chunk is used in place
+    model->buffer_storage.push_back(std::move(file_data));
+
+    auto const directory = fs::path(filename).parent_path();
+
+    try {
+        std::vector<gltf_buffer_view> buffers;
+        if (!load_gltf_buffers(*model, root, directory, glb_chunk, buffers))
+            return nullptr;
+
+        if (!load_gltf_accessors(*model, root, buffers))
+            return nullptr;
+
+        if (root.contains("meshes")) {
+            for (auto const& item : root["meshes"]) {
+                gltf_mesh mesh;
+                mesh.name = item.value("name", string());
+
+                for (auto const& primitive : item.value("primitives", json::array())) {
+                    gltf_primitive result;
+                    result.mesh = create_gltf_mesh(device, *model, primitive);
+                    result.material = primitive.value("material", -1);
+
+                    if (result.mesh)
+                        mesh.primitives.push_back(result);
+                }
+
+                model->meshes.push_back(mesh);
+            }
+        }
+
+        load_gltf_materials(*model, root);
+        load_gltf_nodes(*model, root);
+        load_gltf_images(*model, root, directory, buffers);
+    } catch (json::exception const& e) {
+        log()->error("load gltf {}: {}", filename, e.what());
+        return nullptr;
+    } catch (std::out_of_range const& e) {
+        log()->error("load gltf {}: {}", filename, e.what());
+        return nullptr;
+    }
+
+    if (load_images && !model->images.empty())
+        model->textures = load_textures_async(device, model->images, texture_type::tex_2d,
+                                              mip_generation::cpu, thread_count);
+
+    return model;
+}
+
+//-----------------------------------------------------------------------------
+buffer::ptr create_buffer(device_ptr device, gltf_accessor const& accessor, VkBufferUsageFlags usage) {
+    if (!accessor.data || !accessor.packed())
+        return nullptr;
+
+    auto const size = VkDeviceSize(accessor.count) * accessor.stride;
+
+    auto result = make_buffer();
+    if (!result->create(device, nullptr, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+        return nullptr;
+
+    if (!upload_buffers(device, { { result, accessor.data, size, usage } }))
+        return nullptr;
+
+    return result;
+}
+
+} // namespace lava
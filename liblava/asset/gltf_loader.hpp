@@ -0,0 +1,228 @@
+/**
+ * @file         liblava/asset/gltf_loader.hpp
+ * @brief        Load glTF 2.0 model from file
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/asset/texture_loader.hpp>
+#include <liblava/resource/mesh.hpp>
+
+namespace lava {
+
+/**
+ * @brief glTF accessor (view into loaded buffer data)
+ */
+struct gltf_accessor {
+    /// List of accessors
+    using list = std::vector<gltf_accessor>;
+
+    /// First element (nullptr: no data)
+    data_cptr data = nullptr;
+
+    /// Number of elements
+    ui32 count = 0;
+
+    /// Bytes between elements
+    ui32 stride = 0;
+
+    /// Component type (5120: byte ... 5126: float)
+    ui32 component_type = 0;
+
+    /// Number of components per element (1: SCALAR ... 16: MAT4)
+    ui32 component_count = 0;
+
+    /// Integer components are normalized
+    bool normalized = false;
+
+    /**
+     * @brief Get the size of an element
+     *
+     * @return ui32    Element size in bytes
+     */
+    ui32 get_element_size() const;
+
+    /**
+     * @brief Check if the elements are tightly packed
+     *
+     * @return true     Data can be copied as is
+     * @return false    Data is interleaved
+     */
+    bool packed() const {
+        return stride == get_element_size();
+    }
+};
+
+/**
+ * @brief glTF primitive
+ */
+struct gltf_primitive {
+    /// List of primitives
+    using list = std::vector<gltf_primitive>;
+
+    /// Mesh of primitive
+    lava::mesh::ptr mesh;
+
+    /// Material index (-1: default material)
+    i32 material = -1;
+};
+
+/**
+ * @brief glTF mesh
+ */
+struct gltf_mesh {
+    /// List of meshes
+    using list = std::vector<gltf_mesh>;
+
+    /// Name of mesh
+    string name;
+
+    /// List of primitives
+    gltf_primitive::list primitives;
+};
+
+/**
+ * @brief glTF node
+ */
+struct gltf_node {
+    /// List of nodes
+    using list = std::vector<gltf_node>;
+
+    /// Name of node
+    string name;
+
+    /// Local transform
+    mat4 matrix = mat4(1.f);
+
+    /// Mesh index (-1: no mesh)
+    i32 mesh = -1;
+
+    /// Child node indices
+    index_list children;
+};
+
+/**
+ * @brief glTF material (metallic roughness)
+ */
+struct gltf_material {
+    /// List of materials
+    using list = std::vector<gltf_material>;
+
+    /// Name of material
+    string name;
+
+    /// Base color factor
+    v4 base_color_factor = v4(1.f);
+
+    /// Emissive factor
+    v3 emissive_factor = v3(0.f);
+
+    /// Metallic factor
+    r32 metallic_factor = 1.f;
+
+    /// Roughness factor
+    r32 roughness_factor = 1.f;
+
+    /// Base color texture index (-1: none)
+    i32 base_color_texture = -1;
+
+    /// Metallic roughness texture index (-1: none)
+    i32 metallic_roughness_texture = -1;
+
+    /// Normal texture index (-1: none)
+    i32 normal_texture = -1;
+
+    /// Occlusion texture index (-1: none)
+    i32 occlusion_texture = -1;
+
+    /// Emissive texture index (-1: none)
+    i32 emissive_texture = -1;
+};
+
+/**
+ * @brief glTF model
+ */
+struct gltf_model {
+    /// Shared pointer to glTF model
+    using ptr = std::shared_ptr<gltf_model>;
+
+    /// Node function (with node index and world matrix)
+    using node_func = std::function<void(index, mat4 const&)>;
+
+    /**
+     * @brief Get a texture of the model
+     *
+     * Textures are created by the texture batch (see texture_batch::poll).
+     *
+     * @param texture          glTF texture index
+     *
+     * @return texture::ptr    Texture (nullptr: not loaded yet or failed)
+     */
+    texture::ptr get_texture(i32 texture) const;
+
+    /**
+     * @brief Traverse the nodes of the scene
+     *
+     * @param func      Called for each node with world matrix
+     * @param matrix    Root matrix
+     */
+    void traverse(node_func func, mat4 const& matrix = mat4(1.f)) const;
+
+    /// List of meshes
+    gltf_mesh::list meshes;
+
+    /// List of nodes
+    gltf_node::list nodes;
+
+    /// Root nodes of the scene
+    index_list roots;
+
+    /// List of materials
+    gltf_material::list materials;
+
+    /// List of accessors (valid as long as the model exists)
+    gltf_accessor::list accessors;
+
+    /// Image index of each texture (-1: no image)
+    std::vector<i32> texture_images;
+
+    /// Image files (same order as glTF images)
+    file_format::list images;
+
+    /// Texture batch loading the images
+    texture_batch::ptr textures;
+
+    /// Buffer storage (GLB file or external buffers)
+    std::vector<std::vector<char>> buffer_storage;
+};
+
+/**
+ * @brief Load a glTF 2.0 model from file (.gltf or .glb)
+ *
+ * Meshes are created from the accessors, tightly packed 32 bit indices are copied as is.
+ * Images are loaded by a texture batch (embedded images need an activated asset cache).
+ *
+ * @param device             Vulkan device
+ * @param filename           File to load
+ * @param load_images        Start the texture batch for the images
+ * @param thread_count       Number of decode threads (0: hardware concurrency)
+ *
+ * @return gltf_model::ptr   Loaded model
+ */
+gltf_model::ptr load_gltf(device_ptr device, string_ref filename,
+                          bool load_images = true, ui32 thread_count = 0);
+
+/**
+ * @brief Create a device local buffer directly from an accessor (no conversion)
+ *
+ * @param device          Vulkan device
+ * @param accessor        Tightly packed accessor
+ * @param usage           Buffer usage flags
+ *
+ * @return buffer::ptr    Created buffer (nullptr: accessor is interleaved)
+ */
+buffer::ptr create_buffer(device_ptr device, gltf_accessor const& accessor, VkBufferUsageFlags usage);
+
+} // namespace lava
@@ -0,0 +1,289 @@
+/**
+ * @file         liblava/asset/half_float.cpp
+ * @brief        Half float and packed float conversion
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <bit>
+#include <liblava/asset/half_float.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LAVA_HALF_FLOAT_SSE2 1
+    #include <emmintrin.h>
+    #if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+        #define LAVA_HALF_FLOAT_F16C 1
+        #include <immintrin.h>
+    #endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #define LAVA_HALF_FLOAT_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace lava {
+
+/// Exponent of the smallest normal half float (as float bits)
+constexpr ui32 const half_min_normal = (127 - 14) << 23;
+
+/// Exponent of the smallest value that overflows half float (as float bits)
+constexpr ui32 const half_overflow = (127 + 16) << 23;
+
+/**
+ * @brief Get the magic value to round denormals of a 5 bit exponent float
+ *
+ * @param mantissa_bits    Number of mantissa bits
+ *
+ * @return ui32            Magic value (as float bits)
+ */
+constexpr ui32 get_denormal_magic(ui32 mantissa_bits) {
+    return ((127 - 15) + (23 - mantissa_bits) + 1) << 23;
+}
+
+/**
+ * @brief Get the max value of an unsigned float with 5 bit exponent
+ *
+ * @param mantissa_bits    Number of mantissa bits
+ *
+ * @return r32             Max finite value
+ */
+constexpr r32 get_ufloat_max(ui32 mantissa_bits) {
+    return (2.f - 1.f / r32(1u << mantissa_bits)) * 32768.f;
+}
+
+/**
+ * @brief Convert a float to unsigned float with 5 bit exponent (round to nearest even)
+ *
+ * @param value            Float value
+ * @param mantissa_bits    Number of mantissa bits (6 or 5)
+ *
+ * @return ui32            Unsigned float bits
+ */
+ui32 float_to_ufloat(r32 value, ui32 mantissa_bits) {
+    if (!(value > 0.f))
+        return 0;
+
+    auto bits = std::bit_cast<ui32>(std::min(value, get_ufloat_max(mantissa_bits)));
+
+    if (bits < half_min_normal) {
+        auto const magic = get_denormal_magic(mantissa_bits);
+        return std::bit_cast<ui32>(std::bit_cast<r32>(bits) + std::bit_cast<r32>(magic)) - magic;
+    }
+
+    auto const shift = 23 - mantissa_bits;
+    auto const odd = (bits >> shift) & 1;
+
+    bits += ((15 - 127) << 23) + (1u << (shift - 1)) - 1 + odd;
+    return bits >> shift;
+}
+
+/**
+ * @brief Convert an unsigned float with 5 bit exponent to float
+ *
+ * @param value            Unsigned float bits
+ * @param mantissa_bits    Number of mantissa bits (6 or 5)
+ *
+ * @return r32             Float value
+ */
+r32 ufloat_to_float(ui32 value, ui32 mantissa_bits) {
+    auto const exponent = (value >> mantissa_bits) & 0x1f;
+    auto const mantissa = value & ((1u << mantissa_bits) - 1);
+
+    if (exponent == 0x1f)
+        return mantissa ? std::numeric_limits<r32>::quiet_NaN() : std::numeric_limits<r32>::infinity();
+
+    if (exponent == 0)
+        return std::ldexp(r32(mantissa), -14 - i32(mantissa_bits));
+
+    return std::ldexp(1.f + r32(mantissa) / r32(1u << mantissa_bits), i32(exponent) - 15);
+}
+
+#if LAVA_HALF_FLOAT_SSE2
+
+/**
+ * @brief Convert 4 floats to half floats (SSE2, round to nearest even)
+ *
+ * @param value       Float values
+ *
+ * @return __m128i    Half float bits (sign extended to 32 bit)
+ */
+inline __m128i float_to_half_sse2(__m128 value) {
+    auto const sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+    auto const abs_value = _mm_xor_ps(value, sign);
+    auto const abs_bits = _mm_castps_si128(abs_value);
+
+    auto const is_nan = _mm_castps_si128(_mm_cmpunord_ps(abs_value, abs_value));
+    auto const is_regular = _mm_cmpgt_epi32(_mm_set1_epi32(half_overflow), abs_bits);
+    auto const is_denormal = _mm_cmpgt_epi32(_mm_set1_epi32(half_min_normal), abs_bits);
+
+    auto const inf_or_nan = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+    auto const magic = _mm_set1_epi32(get_denormal_magic(10));
+    auto const denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(abs_value, _mm_castsi128_ps(magic))), magic);
+
+    auto const odd = _mm_srai_epi32(_mm_slli_epi32(abs_bits, 31 - 13), 31);
+    auto const rounded = _mm_sub_epi32(_mm_add_epi32(abs_bits, _mm_set1_epi32(0xfff - ((127 - 15) << 23))), odd);
+    auto const normal = _mm_srli_epi32(rounded, 13);
+
+    auto const finite = _mm_or_si128(_mm_and_si128(is_denormal, denormal), _mm_andnot_si128(is_denormal, normal));
+    auto const result = _mm_or_si128(_mm_and_si128(is_regular, finite), _mm_andnot_si128(is_regular, inf_or_nan));
+
+    return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+/**
+ * @brief Convert 4 floats to unsigned floats with 5 bit exponent (SSE2)
+ *
+ * @tparam mantissa_bits    Number of mantissa bits (6 or 5)
+ *
+ * @param value             Float values
+ *
+ * @return __m128i          Unsigned float bits
+ */
+template<ui32 mantissa_bits>
+inline __m128i float_to_ufloat_sse2(__m128 value) {
+    // max returns the second operand for NaN
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(get_ufloat_max(mantissa_bits)));
+
+    auto const bits = _mm_castps_si128(value);
+    auto const is_denormal = _mm_cmpgt_epi32(_mm_set1_epi32(half_min_normal), bits);
+
+    auto const magic = _mm_set1_epi32(get_denormal_magic(mantissa_bits));
+    auto const denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(value, _mm_castsi128_ps(magic))), magic);
+
+    constexpr auto shift = 23 - mantissa_bits;
+    auto const odd = _mm_and_si128(_mm_srli_epi32(bits, shift), _mm_set1_epi32(1));
+    auto const bias = _mm_set1_epi32(((15 - 127) << 23) + (1 << (shift - 1)) - 1);
+    auto const normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(bits, bias), odd), shift);
+
+    return _mm_or_si128(_mm_and_si128(is_denormal, denormal), _mm_andnot_si128(is_denormal, normal));
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+ui16 float_to_half(r32 value) {
+    auto bits = std::bit_cast<ui32>(value);
+
+    auto const sign = (bits & 0x80000000) >> 16;
+    bits &= 0x7fffffff;
+
+    ui32 result = 0;
+
+    if (bits >= half_overflow) {
+        result = bits > 0x7f800000 ? 0x7e00 : 0x7c00;
+    } else if (bits < half_min_normal) {
+        auto const magic = get_denormal_magic(10);
+        result = std::bit_cast<ui32>(std::bit_cast<r32>(bits) + std::bit_cast<r32>(magic)) - magic;
+    } else {
+        auto const odd = (bits >> 13) & 1;
+        bits += ((15 - 127) << 23) + 0xfff + odd;
+        result = bits >> 13;
+    }
+
+    return ui16(result | sign);
+}
+
+//-----------------------------------------------------------------------------
+r32 half_to_float(ui16 value) {
+    auto const sign = ui32(value & 0x8000) << 16;
+    auto const exponent = (value >> 10) & 0x1f;
+    auto const mantissa = ui32(value & 0x3ff);
+
+    ui32 bits = 0;
+
+    if (exponent == 0x1f) {
+        bits = 0x7f800000 | (mantissa << 13);
+    } else if (exponent == 0) {
+        // denormal: scale the mantissa in float
+        auto const result = r32(mantissa) * (1.f / 16777216.f);
+        bits = std::bit_cast<ui32>(result);
+    } else {
+        bits = ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+    }
+
+    return std::bit_cast<r32>(bits | sign);
+}
+
+//-----------------------------------------------------------------------------
+ui32 pack_b10g11r11(v3 color) {
+    return float_to_ufloat(color.x, 6)
+           | (float_to_ufloat(color.y, 6) << 11)
+           | (float_to_ufloat(color.z, 5) << 22);
+}
+
+//-----------------------------------------------------------------------------
+v3 unpack_b10g11r11(ui32 value) {
+    return { ufloat_to_float(value & 0x7ff, 6),
+             ufloat_to_float((value >> 11) & 0x7ff, 6),
+             ufloat_to_float(value >> 22, 5) };
+}
+
+//-----------------------------------------------------------------------------
+void convert_to_half(r32 const* source, ui16* target, size_t count, bool simd) {
+    size_t i = 0;
+
+    if (simd) {
+#if LAVA_HALF_FLOAT_F16C
+        for (; i + 8 <= count; i += 8) {
+            auto const values = _mm256_loadu_ps(source + i);
+            auto const half = _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+
+            // NaN payloads are kept by the conversion, canonicalize like float_to_half
+            auto const is_nan = _mm_cmpgt_epi16(_mm_and_si128(half, _mm_set1_epi16(0x7fff)), _mm_set1_epi16(0x7c00));
+            auto const nan = _mm_or_si128(_mm_and_si128(half, _mm_set1_epi16(i16(0x8000))), _mm_set1_epi16(0x7e00));
+
+            _mm_storeu_si128((__m128i*) (target + i), _mm_or_si128(_mm_andnot_si128(is_nan, half), _mm_and_si128(is_nan, nan)));
+        }
+#elif LAVA_HALF_FLOAT_SSE2
+        for (; i + 8 <= count; i += 8) {
+            auto const low = float_to_half_sse2(_mm_loadu_ps(source + i));
+            auto const high = float_to_half_sse2(_mm_loadu_ps(source + i + 4));
+
+            // values are sign extended, signed saturation keeps the bits
+            _mm_storeu_si128((__m128i*) (target + i), _mm_packs_epi32(low, high));
+        }
+#elif LAVA_HALF_FLOAT_NEON
+        for (; i + 4 <= count; i += 4) {
+            auto const half = vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(source + i)));
+
+            // NaN payloads are kept by the conversion, canonicalize like float_to_half
+            auto const is_nan = vcgt_u16(vand_u16(half, vdup_n_u16(0x7fff)), vdup_n_u16(0x7c00));
+            auto const nan = vorr_u16(vand_u16(half, vdup_n_u16(0x8000)), vdup_n_u16(0x7e00));
+
+            vst1_u16(target + i, vbsl_u16(is_nan, nan, half));
+        }
+#endif
+    }
+
+    for (; i < count; ++i)
+        target[i] = float_to_half(source[i]);
+}
+
+//-----------------------------------------------------------------------------
+void convert_to_b10g11r11(r32 const* source, ui32* target, size_t pixel_count, bool simd) {
+    size_t i = 0;
+
+    if (simd) {
+#if LAVA_HALF_FLOAT_SSE2
+        for (; i + 4 <= pixel_count; i += 4) {
+            auto red = _mm_loadu_ps(source + i * 4);
+            auto green = _mm_loadu_ps(source + i * 4 + 4);
+            auto blue = _mm_loadu_ps(source + i * 4 + 8);
+            auto alpha = _mm_loadu_ps(source + i * 4 + 12);
+
+            _MM_TRANSPOSE4_PS(red, green, blue, alpha);
+
+            auto const result = _mm_or_si128(float_to_ufloat_sse2<6>(red),
+                                             _mm_or_si128(_mm_slli_epi32(float_to_ufloat_sse2<6>(green), 11),
+                                                          _mm_slli_epi32(float_to_ufloat_sse2<5>(blue), 22)));
+
+            _mm_storeu_si128((__m128i*) (target + i), result);
+        }
+#endif
+    }
+
+    for (; i < pixel_count; ++i)
+        target[i] = pack_b10g11r11({ source[i * 4], source[i * 4 + 1], source[i * 4 + 2] });
+}
+
+} // namespace lava
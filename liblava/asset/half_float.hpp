@@ -0,0 +1,76 @@
+/**
+ * @file         liblava/asset/half_float.hpp
+ * @brief        Half float and packed float conversion
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/core/math.hpp>
+
+namespace lava {
+
+/**
+ * @brief Convert a float to half float (round to nearest even)
+ *
+ * @param value    Float value
+ *
+ * @return ui16    Half float bits
+ */
+ui16 float_to_half(r32 value);
+
+/**
+ * @brief Convert a half float to float
+ *
+ * @param value    Half float bits
+ *
+ * @return r32     Float value
+ */
+r32 half_to_float(ui16 value);
+
+/**
+ * @brief Pack a color to B10G11R11 unsigned float
+ *
+ * Negative and NaN values map to zero, values above the max are clamped.
+ *
+ * @param color    RGB color
+ *
+ * @return ui32    Packed color (VK_FORMAT_B10G11R11_UFLOAT_PACK32)
+ */
+ui32 pack_b10g11r11(v3 color);
+
+/**
+ * @brief Unpack a B10G11R11 unsigned float color
+ *
+ * @param value    Packed color
+ *
+ * @return v3      RGB color
+ */
+v3 unpack_b10g11r11(ui32 value);
+
+/**
+ * @brief Convert floats to half floats
+ *
+ * Uses F16C, NEON or SSE2 if available.
+ *
+ * @param source    Source floats
+ * @param target    Target half floats
+ * @param count     Number of values
+ * @param simd      Use SIMD path (false: scalar reference)
+ */
+void convert_to_half(r32 const* source, ui16* target, size_t count, bool simd = true);
+
+/**
+ * @brief Convert RGBA float pixels to B10G11R11 unsigned float (alpha is dropped)
+ *
+ * Uses SSE2 if available.
+ *
+ * @param source         Source RGBA pixels
+ * @param target         Target packed pixels
+ * @param pixel_count    Number of pixels
+ * @param simd           Use SIMD path (false: scalar reference)
+ */
+void convert_to_b10g11r11(r32 const* source, ui32* target, size_t pixel_count, bool simd = true);
+
+} // namespace lava
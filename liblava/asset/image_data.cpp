@@ -10,37 +10,116 @@
 
 namespace lava {
 
+/**
+ * @brief Read callback of stb image
+ *
+ * @param user    Source file
+ * @param data    Target data
+ * @param size    Size to read
+ *
+ * @return int    Read size
+ */
+int stbi_file_read(void* user, char* data, int size) {
+    auto const result = static_cast<file*>(user)->read_next(data, to_ui64(size));
+    return result > 0 ? to_i32(result) : 0;
+}
+
+/**
+ * @brief Skip callback of stb image
+ *
+ * @param user     Source file
+ * @param count    Number of bytes to skip (or rewind if negative)
+ */
+void stbi_file_skip(void* user, int count) {
+    auto* file = static_cast<lava::file*>(user);
+
+    // keep the position instead of seeking relative to the error result
+    auto const position = file->tell();
+    if (file_error(position))
+        return;
+
+    file->seek(to_ui64(std::max(position + count, i64(0))));
+}
+
+/**
+ * @brief End of file callback of stb image
+ *
+ * @param user    Source file
+ *
+ * @return int    End of file reached
+ */
+int stbi_file_eof(void* user) {
+    auto* file = static_cast<lava::file*>(user);
+
+    auto const position = file->tell();
+    return file_error(position) || position >= file->get_size() ? 1 : 0;
+}
+
+/// Callbacks of stb image reading from a file
+stbi_io_callbacks const stbi_file_callbacks{
+    .read = stbi_file_read,
+    .skip = stbi_file_skip,
+    .eof = stbi_file_eof,
+};
+
 //-----------------------------------------------------------------------------
-image_data::image_data(string_ref filename)
-: image_file(str(filename)), file_data(image_file.get_size(), false) {
-    if (image_file.opened()) {
-        if (!file_data.allocate())
-            return;
+data_ptr load_image_data(file& file, uv2& size, ui32& channels) {
+    file.seek(0);
 
-        if (file_error(image_file.read(file_data.ptr)))
-            return;
-    }
+    i32 width = 0, height = 0, file_channels = 0;
+    auto result = stbi_load_from_callbacks(&stbi_file_callbacks, &file, &width, &height, &file_channels, STBI_rgb_alpha);
+    if (!result)
+        return nullptr;
+
+    size = { width, height };
+    channels = file_channels;
 
-    i32 tex_width, tex_height, tex_channels = 0;
+    return as_ptr(result);
+}
+
+//-----------------------------------------------------------------------------
+r32* load_image_float_data(file& file, uv2& size, ui32& channels) {
+    file.seek(0);
+
+    i32 width = 0, height = 0, file_channels = 0;
+    auto result = stbi_loadf_from_callbacks(&stbi_file_callbacks, &file, &width, &height, &file_channels, STBI_rgb_alpha);
+    if (!result)
+        return nullptr;
+
+    size = { width, height };
+    channels = file_channels;
+
+    return result;
+}
 
-    if (image_file.opened())
-        data = as_ptr(stbi_load_from_memory((stbi_uc const*) file_data.ptr, to_i32(file_data.size),
-                                            &tex_width, &tex_height, &tex_channels, STBI_rgb_alpha));
-    else
+//-----------------------------------------------------------------------------
+void free_image_data(void* data) {
+    stbi_image_free(data);
+}
+
+//-----------------------------------------------------------------------------
+image_data::image_data(string_ref filename) {
+    file image_file(str(filename));
+
+    if (image_file.opened()) {
+        data = load_image_data(image_file, size, channels);
+    } else {
+        i32 tex_width, tex_height, tex_channels = 0;
         data = as_ptr(stbi_load(str(filename), &tex_width, &tex_height, &tex_channels, STBI_rgb_alpha));
 
-    if (!data)
-        return;
+        if (data) {
+            size = { tex_width, tex_height };
+            channels = tex_channels;
+        }
+    }
 
-    size = { tex_width, tex_height };
-    channels = tex_channels;
-    ready = true;
+    ready = data != nullptr;
 }
 
 //-----------------------------------------------------------------------------
 image_data::~image_data() {
     if (data)
-        stbi_image_free(data);
+        free_image_data(data);
 }
 
 } // namespace lava
@@ -39,13 +39,37 @@ struct image_data {
 
     /// Number of channels
     ui32 channels = 0;
+};
 
-private:
-    /// Image file
-    file image_file;
+/**
+ * @brief Load RGBA8 pixels from file with stb callback I/O
+ * 
+ * The decoder reads the file in chunks, the file is not held in memory.
+ * 
+ * @param file         Opened file (position is reset)
+ * @param size         Image size
+ * @param channels     Number of channels in file
+ * 
+ * @return data_ptr    Pixel data (free with free_image_data)
+ */
+data_ptr load_image_data(file& file, uv2& size, ui32& channels);
 
-    /// File data
-    unique_data file_data;
-};
+/**
+ * @brief Load RGBA float pixels from file with stb callback I/O (HDR)
+ * 
+ * @param file         Opened file (position is reset)
+ * @param size         Image size
+ * @param channels     Number of channels in file
+ * 
+ * @return r32*        Pixel data (free with free_image_data)
+ */
+r32* load_image_float_data(file& file, uv2& size, ui32& channels);
+
+/**
+ * @brief Free pixel data
+ * 
+ * @param data    Pixel data (see load_image_data)
+ */
+void free_image_data(void* data);
 
 } // namespace lava
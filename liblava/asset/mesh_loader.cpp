@@ -87,7 +87,7 @@ mesh::ptr load_mesh(device_ptr device, name filename) {
             if (mesh->empty())
                 return nullptr;
 
-            if (!mesh->create(device))
+            if (device && !mesh->create(device))
                 return nullptr;
 
             return mesh;
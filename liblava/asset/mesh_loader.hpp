@@ -14,7 +14,7 @@ namespace lava {
 /**
  * @brief Load mesh from file
  * 
- * @param device        Vulkan device
+ * @param device        Vulkan device (nullptr: only load the mesh data, create later)
  * @param filename      File to load
  * @return mesh::ptr    Loaded mesh
  */
@@ -0,0 +1,311 @@
+/**
+ * @file         liblava/asset/mip_map.cpp
+ * @brief        CPU mip chain generation
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/asset/mip_map.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LAVA_MIP_MAP_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #define LAVA_MIP_MAP_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace lava {
+
+/// Pixel size of RGBA8
+constexpr ui32 const rgba8_size = 4;
+
+/// Resolution of the linear to sRGB table
+constexpr ui32 const srgb_table_size = 65536;
+
+/**
+ * @brief sRGB conversion tables
+ */
+struct srgb_tables {
+    /**
+     * @brief Construct the sRGB tables
+     */
+    srgb_tables() {
+        for (auto i = 0u; i < 256; ++i) {
+            auto const value = i / 255.f;
+            to_linear[i] = value <= 0.04045f ? value / 12.92f
+                                             : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            alpha[i] = value;
+        }
+
+        for (auto i = 0u; i < srgb_table_size; ++i) {
+            auto const value = i / r32(srgb_table_size - 1);
+            auto const result = value <= 0.0031308f ? value * 12.92f
+                                                    : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+            to_srgb[i] = ui8(std::clamp(result, 0.f, 1.f) * 255.f + 0.5f);
+        }
+    }
+
+    /// sRGB to linear
+    std::array<r32, 256> to_linear;
+
+    /// Unorm to float (alpha)
+    std::array<r32, 256> alpha;
+
+    /// Linear to sRGB
+    std::array<ui8, srgb_table_size> to_srgb;
+};
+
+/**
+ * @brief Get the sRGB conversion tables
+ *
+ * @return srgb_tables const&    sRGB tables
+ */
+srgb_tables const& get_srgb_tables() {
+    static srgb_tables const tables;
+    return tables;
+}
+
+/**
+ * @brief Average 4 linear pixels
+ *
+ * @param a         First pixel
+ * @param b         Second pixel
+ * @param c         Third pixel
+ * @param d         Fourth pixel
+ * @param result    Target pixel
+ */
+inline void average_pixel(ui8 const* a, ui8 const* b, ui8 const* c, ui8 const* d, ui8* result) {
+    for (auto i = 0u; i < rgba8_size; ++i)
+        result[i] = ui8((a[i] + b[i] + c[i] + d[i] + 2) >> 2);
+}
+
+/**
+ * @brief Average 4 sRGB pixels in linear space
+ *
+ * @param tables    sRGB tables
+ * @param a         First pixel
+ * @param b         Second pixel
+ * @param c         Third pixel
+ * @param d         Fourth pixel
+ * @param result    Target pixel
+ */
+inline void average_pixel_srgb(srgb_tables const& tables,
+                               ui8 const* a, ui8 const* b, ui8 const* c, ui8 const* d, ui8* result) {
+    auto const& lut = tables.to_linear;
+    auto const scale = 0.25f * (srgb_table_size - 1);
+
+    i32 channels[rgba8_size];
+    for (auto i = 0u; i < 3; ++i)
+        channels[i] = i32((lut[a[i]] + lut[b[i]] + lut[c[i]] + lut[d[i]]) * scale + 0.5f);
+
+    channels[3] = i32((tables.alpha[a[3]] + tables.alpha[b[3]] + tables.alpha[c[3]] + tables.alpha[d[3]]) * scale + 0.5f);
+
+    for (auto i = 0u; i < 3; ++i)
+        result[i] = tables.to_srgb[channels[i]];
+
+    result[3] = ui8((channels[3] * 255 + (srgb_table_size - 1) / 2) / (srgb_table_size - 1));
+}
+
+/**
+ * @brief Downsample 4 target pixels of two full source rows (linear)
+ *
+ * @param row_0     First source row (8 pixels)
+ * @param row_1     Second source row (8 pixels)
+ * @param result    Target pixels (4 pixels)
+ *
+ * @return true     Downsample was done
+ * @return false    No SIMD support
+ */
+inline bool downsample_4_pixels(ui8 const* row_0, ui8 const* row_1, ui8* result) {
+#if LAVA_MIP_MAP_SSE2
+    auto const zero = _mm_setzero_si128();
+
+    auto split = [](ui8 const* row, __m128i& even, __m128i& odd) {
+        auto const a = _mm_castsi128_ps(_mm_loadu_si128((__m128i const*) row));
+        auto const b = _mm_castsi128_ps(_mm_loadu_si128((__m128i const*) (row + 16)));
+
+        even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    };
+
+    __m128i even_0, odd_0, even_1, odd_1;
+    split(row_0, even_0, odd_0);
+    split(row_1, even_1, odd_1);
+
+    auto sum = [&](auto unpack) {
+        auto const rounding = _mm_set1_epi16(2);
+        auto result = _mm_add_epi16(unpack(even_0, zero), unpack(odd_0, zero));
+        result = _mm_add_epi16(result, _mm_add_epi16(unpack(even_1, zero), unpack(odd_1, zero)));
+        return _mm_srli_epi16(_mm_add_epi16(result, rounding), 2);
+    };
+
+    auto const low = sum([](__m128i a, __m128i b) { return _mm_unpacklo_epi8(a, b); });
+    auto const high = sum([](__m128i a, __m128i b) { return _mm_unpackhi_epi8(a, b); });
+
+    _mm_storeu_si128((__m128i*) result, _mm_packus_epi16(low, high));
+    return true;
+#elif LAVA_MIP_MAP_NEON
+    auto const pixels_0 = vld2q_u32((uint32_t const*) row_0);
+    auto const pixels_1 = vld2q_u32((uint32_t const*) row_1);
+
+    auto const even_0 = vreinterpretq_u8_u32(pixels_0.val[0]);
+    auto const odd_0 = vreinterpretq_u8_u32(pixels_0.val[1]);
+    auto const even_1 = vreinterpretq_u8_u32(pixels_1.val[0]);
+    auto const odd_1 = vreinterpretq_u8_u32(pixels_1.val[1]);
+
+    auto const low = vaddq_u16(vaddl_u8(vget_low_u8(even_0), vget_low_u8(odd_0)),
+                               vaddl_u8(vget_low_u8(even_1), vget_low_u8(odd_1)));
+    auto const high = vaddq_u16(vaddl_u8(vget_high_u8(even_0), vget_high_u8(odd_0)),
+                                vaddl_u8(vget_high_u8(even_1), vget_high_u8(odd_1)));
+
+    vst1q_u8(result, vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2)));
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Downsample 4 target pixels of two full source rows (sRGB)
+ *
+ * Linearized by the tables, the 4 channels of a pixel are averaged in one vector.
+ * Results are identical to average_pixel_srgb.
+ *
+ * @param tables    sRGB tables
+ * @param row_0     First source row (8 pixels)
+ * @param row_1     Second source row (8 pixels)
+ * @param result    Target pixels (4 pixels)
+ *
+ * @return true     Downsample was done
+ * @return false    No SIMD support
+ */
+inline bool downsample_4_pixels_srgb(srgb_tables const& tables, ui8 const* row_0, ui8 const* row_1, ui8* result) {
+#if LAVA_MIP_MAP_SSE2 || LAVA_MIP_MAP_NEON
+    auto const& lut = tables.to_linear;
+    auto const& alpha = tables.alpha;
+    auto const scale = 0.25f * (srgb_table_size - 1);
+
+    alignas(16) i32 channels[4 * rgba8_size];
+
+    for (auto i = 0u; i < 4; ++i) {
+        auto const* a = row_0 + 2 * i * rgba8_size;
+        auto const* b = a + rgba8_size;
+        auto const* c = row_1 + 2 * i * rgba8_size;
+        auto const* d = c + rgba8_size;
+
+    #if LAVA_MIP_MAP_SSE2
+        auto load = [&](ui8 const* pixel) {
+            return _mm_setr_ps(lut[pixel[0]], lut[pixel[1]], lut[pixel[2]], alpha[pixel[3]]);
+        };
+
+        // same summation order as the scalar path
+        auto const sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(load(a), load(b)), load(c)), load(d));
+        auto const value = _mm_add_ps(_mm_mul_ps(sum, _mm_set1_ps(scale)), _mm_set1_ps(0.5f));
+
+        _mm_store_si128((__m128i*) (channels + i * rgba8_size), _mm_cvttps_epi32(value));
+    #else
+        auto load = [&](ui8 const* pixel) {
+            r32 const values[rgba8_size] = { lut[pixel[0]], lut[pixel[1]], lut[pixel[2]], alpha[pixel[3]] };
+            return vld1q_f32(values);
+        };
+
+        // same summation order as the scalar path
+        auto const sum = vaddq_f32(vaddq_f32(vaddq_f32(load(a), load(b)), load(c)), load(d));
+        auto const value = vaddq_f32(vmulq_f32(sum, vdupq_n_f32(scale)), vdupq_n_f32(0.5f));
+
+        vst1q_s32(channels + i * rgba8_size, vcvtq_s32_f32(value));
+    #endif
+    }
+
+    for (auto i = 0u; i < 4 * rgba8_size; i += rgba8_size) {
+        result[i + 0] = tables.to_srgb[channels[i + 0]];
+        result[i + 1] = tables.to_srgb[channels[i + 1]];
+        result[i + 2] = tables.to_srgb[channels[i + 2]];
+        result[i + 3] = ui8((channels[i + 3] * 255 + (srgb_table_size - 1) / 2) / (srgb_table_size - 1));
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+texture::mip_level::list get_mip_levels(uv2 size) {
+    texture::mip_level::list result;
+
+    auto const level_count = get_mip_level_count(size);
+    for (auto i = 0u; i < level_count; ++i) {
+        texture::mip_level level;
+        level.extent = size;
+        level.size = size.x * size.y * rgba8_size;
+
+        result.push_back(level);
+
+        size = { std::max(size.x / 2, 1u), std::max(size.y / 2, 1u) };
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+size_t get_mip_chain_size(uv2 size) {
+    size_t result = 0;
+    for (auto const& level : get_mip_levels(size))
+        result += level.size;
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+void downsample_rgba8(data_cptr source, uv2 source_size, data_ptr target, bool srgb) {
+    uv2 const target_size = { std::max(source_size.x / 2, 1u), std::max(source_size.y / 2, 1u) };
+
+    auto const* tables = srgb ? &get_srgb_tables() : nullptr;
+
+    auto const source_pitch = source_size.x * rgba8_size;
+    auto const target_pitch = target_size.x * rgba8_size;
+
+    // SIMD needs two source pixels for each target pixel in a row
+    auto const simd_count = source_size.x > 1 ? target_size.x / 4 * 4 : 0u;
+
+    for (auto y = 0u; y < target_size.y; ++y) {
+        auto const* row_0 = (ui8 const*) source + 2 * y * source_pitch;
+        auto const* row_1 = (ui8 const*) source + std::min(2 * y + 1, source_size.y - 1) * source_pitch;
+        auto* row = (ui8*) target + y * target_pitch;
+
+        auto x = 0u;
+        for (; x < simd_count; x += 4) {
+            auto const done = tables ? downsample_4_pixels_srgb(*tables, row_0 + 2 * x * rgba8_size, row_1 + 2 * x * rgba8_size, row + x * rgba8_size)
+                                     : downsample_4_pixels(row_0 + 2 * x * rgba8_size, row_1 + 2 * x * rgba8_size, row + x * rgba8_size);
+            if (!done)
+                break;
+        }
+
+        for (; x < target_size.x; ++x) {
+            auto const x_0 = 2 * x * rgba8_size;
+            auto const x_1 = std::min(2 * x + 1, source_size.x - 1) * rgba8_size;
+
+            if (tables)
+                average_pixel_srgb(*tables, row_0 + x_0, row_0 + x_1, row_1 + x_0, row_1 + x_1, row + x * rgba8_size);
+            else
+                average_pixel(row_0 + x_0, row_0 + x_1, row_1 + x_0, row_1 + x_1, row + x * rgba8_size);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void generate_mip_chain(data_ptr data, texture::mip_level::list const& levels, bool srgb) {
+    auto source = data;
+
+    for (auto i = 1u; i < levels.size(); ++i) {
+        auto target = source + levels[i - 1].size;
+
+        downsample_rgba8(source, levels[i - 1].extent, target, srgb);
+
+        source = target;
+    }
+}
+
+} // namespace lava
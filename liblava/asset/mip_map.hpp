@@ -0,0 +1,55 @@
+/**
+ * @file         liblava/asset/mip_map.hpp
+ * @brief        CPU mip chain generation
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/texture.hpp>
+
+namespace lava {
+
+/**
+ * @brief Get the mip levels of a full mip chain (RGBA8)
+ *
+ * @param size                          Size of level 0
+ *
+ * @return texture::mip_level::list     List of mip levels
+ */
+texture::mip_level::list get_mip_levels(uv2 size);
+
+/**
+ * @brief Get the size of a full mip chain (RGBA8)
+ *
+ * @param size       Size of level 0
+ *
+ * @return size_t    Size of all levels
+ */
+size_t get_mip_chain_size(uv2 size);
+
+/**
+ * @brief Downsample a RGBA8 image with a 2x2 box filter
+ *
+ * Color channels are averaged in linear space if sRGB is set, alpha is always linear.
+ *
+ * @param source         Source pixels
+ * @param source_size    Size of source
+ * @param target         Target pixels (max(size / 2, 1))
+ * @param srgb           Source is sRGB encoded
+ */
+void downsample_rgba8(data_cptr source, uv2 source_size, data_ptr target, bool srgb);
+
+/**
+ * @brief Generate a full RGBA8 mip chain in place
+ *
+ * Level 0 must already be at the start of data, the other levels are stored tightly after it.
+ *
+ * @param data      Mip chain data (get_mip_chain_size)
+ * @param levels    List of mip levels (get_mip_levels)
+ * @param srgb      Data is sRGB encoded
+ */
+void generate_mip_chain(data_ptr data, texture::mip_level::list const& levels, bool srgb);
+
+} // namespace lava
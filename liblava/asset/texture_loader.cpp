@@ -5,6 +5,11 @@
  * @copyright    Copyright (c) 2018-present, MIT License
  */
 
+#include <liblava/asset/asset_cache.hpp>
+#include <liblava/asset/bc_encoder.hpp>
+#include <liblava/asset/half_float.hpp>
+#include <liblava/asset/image_data.hpp>
+#include <liblava/asset/mip_map.hpp>
 #include <liblava/asset/texture_loader.hpp>
 #include <liblava/file.hpp>
 #include <liblava/resource/format.hpp>
@@ -38,48 +43,50 @@
 namespace lava {
 
 /**
- * @brief Create a gli 2D texture
- * 
- * @param device           Vulkan device
- * @param file             File to load
- * @param format           Format of texture
- * @param temp_data        Data of texture
- * 
- * @return texture::ptr    Loaded texture
+ * @brief Decoded texture (ready for upload)
  */
-texture::ptr create_gli_texture_2d(device_ptr device, file const& file, VkFormat format, unique_data const& temp_data) {
-    gli::texture2d tex(file.opened() ? gli::load(temp_data.ptr, temp_data.size)
-                                     : gli::load(file.get_path()));
-    assert(!tex.empty());
-    if (tex.empty())
-        return nullptr;
+struct decoded_texture {
+    /**
+     * @brief Destroy the decoded texture
+     */
+    ~decoded_texture() {
+        if (stbi_data)
+            stbi_image_free(stbi_data);
+    }
 
-    auto mip_levels = to_ui32(tex.levels());
+    /**
+     * @brief Get the data to upload
+     * 
+     * @return void const*    Texture data
+     */
+    void const* data() const {
+        return stbi_data ? stbi_data : gli_texture.data();
+    }
 
-    texture::layer layer;
+    /// Size of texture
+    uv2 size{};
 
-    for (auto m = 0u; m < mip_levels; ++m) {
-        texture::mip_level level;
-        level.extent = { tex[m].extent().x, tex[m].extent().y };
-        level.size = to_ui32(tex[m].size());
+    /// Format of texture
+    VkFormat format = VK_FORMAT_UNDEFINED;
 
-        layer.levels.push_back(level);
-    }
+    /// Type of texture
+    texture_type type = texture_type::none;
 
-    texture::layer::list layers;
-    layers.push_back(layer);
+    /// Mip generation
+    mip_generation mip = mip_generation::none;
 
-    auto texture = make_texture();
+    /// List of layers
+    texture::layer::list layers;
 
-    uv2 const size = { tex[0].extent().x, tex[0].extent().y };
-    if (!texture->create(device, size, format, layers, texture_type::tex_2d))
-        return nullptr;
+    /// Size of data
+    size_t data_size = 0;
 
-    if (!texture->upload(tex.data(), tex.size()))
-        return nullptr;
+    /// gli texture storage
+    gli::texture gli_texture;
 
-    return texture;
-}
+    /// stbi pixel data
+    stbi_uc* stbi_data = nullptr;
+};
 
 /**
  * @brief Create a layer list for a texture
@@ -115,109 +122,327 @@ texture::layer::list create_layer_list(T const& tex, ui32 layer_count) {
 }
 
 /**
- * @brief Create a gli array texture
+ * @brief Decode a gli texture
  * 
- * @param device           Vulkan device
- * @param file             File to load
- * @param format           Format of texture
- * @param temp_data        Data of texture
+ * @param result    Decoded texture
+ * @param tex       Loaded gli texture
+ * @param format    Format of texture
+ * @param type      Type of texture
  * 
- * @return texture::ptr    Loaded texture
+ * @return true     Decode was successful
+ * @return false    Decode failed
  */
-texture::ptr create_gli_texture_array(device_ptr device, file const& file, VkFormat format, unique_data const& temp_data) {
-    gli::texture2d_array tex(file.opened() ? gli::load(temp_data.ptr, temp_data.size)
-                                           : gli::load(file.get_path()));
-    assert(!tex.empty());
+bool decode_gli_texture(decoded_texture& result, gli::texture const& tex,
+                        VkFormat format, texture_type type) {
     if (tex.empty())
-        return nullptr;
+        return false;
 
-    auto layers = create_layer_list(tex, to_ui32(tex.layers()));
+    switch (type) {
+    case texture_type::tex_2d: {
+        gli::texture2d tex_2d(tex);
+        if (tex_2d.empty())
+            return false;
 
-    auto texture = make_texture();
+        texture::layer layer;
 
-    uv2 const size = { tex[0].extent().x, tex[0].extent().y };
-    if (!texture->create(device, size, format, layers, texture_type::array))
-        return nullptr;
+        for (auto m = 0u; m < to_ui32(tex_2d.levels()); ++m) {
+            texture::mip_level level;
+            level.extent = { tex_2d[m].extent().x, tex_2d[m].extent().y };
+            level.size = to_ui32(tex_2d[m].size());
 
-    if (!texture->upload(tex.data(), tex.size()))
-        return nullptr;
+            layer.levels.push_back(level);
+        }
 
-    return texture;
+        result.layers.push_back(layer);
+        result.size = { tex_2d[0].extent().x, tex_2d[0].extent().y };
+        break;
+    }
+
+    case texture_type::array: {
+        gli::texture2d_array tex_array(tex);
+        if (tex_array.empty())
+            return false;
+
+        result.layers = create_layer_list(tex_array, to_ui32(tex_array.layers()));
+        result.size = { tex_array[0].extent().x, tex_array[0].extent().y };
+        break;
+    }
+
+    case texture_type::cube_map: {
+        gli::texture_cube tex_cube(tex);
+        if (tex_cube.empty())
+            return false;
+
+        result.layers = create_layer_list(tex_cube, to_ui32(tex_cube.faces()));
+        result.size = { tex_cube[0].extent().x, tex_cube[0].extent().y };
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    result.format = format;
+    result.type = type;
+    result.data_size = tex.size();
+    result.gli_texture = tex;
+
+    return true;
 }
 
 /**
- * @brief Create a gli cube map texture
+ * @brief Decode a gli texture from file
  * 
- * @param device           Vulkan device
- * @param file             File to load
- * @param format           Format of texture
- * @param temp_data        Data of texture
+ * @param result       Decoded texture
+ * @param file         File to load
+ * @param format       Format of texture
+ * @param type         Type of texture
+ * @param temp_data    Data of texture
  * 
- * @return texture::ptr    Loaded texture
+ * @return true        Decode was successful
+ * @return false       Decode failed
  */
-texture::ptr create_gli_texture_cube_map(device_ptr device, file const& file, VkFormat format, unique_data const& temp_data) {
-    gli::texture_cube tex(file.opened() ? gli::load(temp_data.ptr, temp_data.size)
-                                        : gli::load(file.get_path()));
-    assert(!tex.empty());
-    if (tex.empty())
-        return nullptr;
+bool decode_gli_texture(decoded_texture& result, file const& file, VkFormat format,
+                        texture_type type, unique_data const& temp_data) {
+    gli::texture tex = file.opened() ? gli::load(temp_data.ptr, temp_data.size)
+                                     : gli::load(file.get_path());
 
-    auto layers = create_layer_list(tex, to_ui32(tex.faces()));
+    return decode_gli_texture(result, tex, format, type);
+}
 
-    auto texture = make_texture();
+/**
+ * @brief Decode a stbi texture
+ * 
+ * The file is decoded with callback I/O, the compressed data is not held in memory.
+ * 
+ * @param result    Decoded texture
+ * @param file      File to load
+ * @param format    Format of texture (sRGB or UNORM)
+ * 
+ * @return true     Decode was successful
+ * @return false    Decode failed
+ */
+bool decode_stbi_texture(decoded_texture& result, file& file, VkFormat format) {
+    uv2 size{};
+    ui32 channels = 0;
 
-    uv2 const size = { tex[0].extent().x, tex[0].extent().y };
-    if (!texture->create(device, size, format, layers, texture_type::cube_map))
-        return nullptr;
+    if (file.opened()) {
+        result.stbi_data = (stbi_uc*) load_image_data(file, size, channels);
+    } else {
+        i32 tex_width = 0, tex_height = 0;
+        result.stbi_data = stbi_load(str(file.get_path()), &tex_width, &tex_height, nullptr, STBI_rgb_alpha);
+        size = { tex_width, tex_height };
+    }
 
-    if (!texture->upload(tex.data(), tex.size()))
-        return nullptr;
+    if (!result.stbi_data)
+        return false;
 
-    return texture;
+    result.size = size;
+    result.format = format == VK_FORMAT_R8G8B8A8_UNORM ? format : VK_FORMAT_R8G8B8A8_SRGB;
+    result.type = texture_type::tex_2d;
+    result.data_size = size.x * size.y * format_block_size(result.format);
+
+    return true;
 }
 
 /**
- * @brief Create a stbi texture
+ * @brief Decode a HDR texture
  * 
- * @param device           Vulkan device
- * @param file             File to load
- * @param temp_data        Data of texture
+ * Float pixels are converted to half float (default) or packed to B10G11R11.
  * 
- * @return texture::ptr    Loaded texture
+ * @param result    Decoded texture
+ * @param file      File to load
+ * @param format    Format of texture (R16G16B16A16, B10G11R11 or R32G32B32A32)
+ * 
+ * @return true     Decode was successful
+ * @return false    Decode failed
  */
-texture::ptr create_stbi_texture(device_ptr device, file const& file, unique_data const& temp_data) {
-    i32 tex_width = 0, tex_height = 0;
-    stbi_uc* data = nullptr;
+bool decode_hdr_texture(decoded_texture& result, file& file, VkFormat format) {
+    uv2 size{};
+    ui32 channels = 0;
+    r32* pixels = nullptr;
 
-    if (file.opened())
-        data = stbi_load_from_memory((stbi_uc const*) temp_data.ptr, to_i32(temp_data.size),
-                                     &tex_width, &tex_height, nullptr, STBI_rgb_alpha);
+    if (file.opened()) {
+        pixels = load_image_float_data(file, size, channels);
+    } else {
+        i32 tex_width = 0, tex_height = 0;
+        pixels = stbi_loadf(str(file.get_path()), &tex_width, &tex_height, nullptr, STBI_rgb_alpha);
+        size = { tex_width, tex_height };
+    }
+
+    if (!pixels)
+        return false;
+
+    auto gli_format = gli::FORMAT_RGBA16_SFLOAT_PACK16;
+    if (format == VK_FORMAT_B10G11R11_UFLOAT_PACK32)
+        gli_format = gli::FORMAT_RG11B10_UFLOAT_PACK32;
+    else if (format == VK_FORMAT_R32G32B32A32_SFLOAT)
+        gli_format = gli::FORMAT_RGBA32_SFLOAT_PACK32;
     else
-        data = stbi_load(str(file.get_path()), &tex_width, &tex_height, nullptr, STBI_rgb_alpha);
+        format = VK_FORMAT_R16G16B16A16_SFLOAT;
 
-    if (!data)
-        return nullptr;
+    gli::texture2d tex(gli_format, gli::extent2d(size.x, size.y), 1);
 
-    auto texture = make_texture();
+    auto const pixel_count = size_t(size.x) * size.y;
 
-    uv2 const size = { tex_width, tex_height };
-    auto const font_format = VK_FORMAT_R8G8B8A8_SRGB;
-    if (!texture->create(device, size, font_format))
-        return nullptr;
+    if (gli_format == gli::FORMAT_RG11B10_UFLOAT_PACK32)
+        convert_to_b10g11r11(pixels, (ui32*) tex.data(), pixel_count);
+    else if (gli_format == gli::FORMAT_RGBA32_SFLOAT_PACK32)
+        memcpy(tex.data(), pixels, pixel_count * 4 * sizeof(r32));
+    else
+        convert_to_half(pixels, (ui16*) tex.data(), pixel_count * 4);
 
-    auto const uploadSize = tex_width * tex_height * format_block_size(font_format);
-    auto result = texture->upload(data, uploadSize);
+    free_image_data(pixels);
 
-    stbi_image_free(data);
+    return decode_gli_texture(result, tex, format, texture_type::tex_2d);
+}
 
-    if (!result)
-        return nullptr;
+/**
+ * @brief Generate the mip chain of a decoded stbi texture
+ * 
+ * @param result    Decoded texture (stbi data is moved into gli storage)
+ * 
+ * @return true     Generate was successful
+ * @return false    Generate failed
+ */
+bool generate_stbi_mip_chain(decoded_texture& result) {
+    auto const srgb = result.format == VK_FORMAT_R8G8B8A8_SRGB;
+    auto const levels = get_mip_levels(result.size);
 
-    return texture;
+    gli::texture2d tex(srgb ? gli::FORMAT_RGBA8_SRGB_PACK8 : gli::FORMAT_RGBA8_UNORM_PACK8,
+                       gli::extent2d(result.size.x, result.size.y), levels.size());
+    if (tex.empty() || tex.levels() != levels.size())
+        return false;
+
+    memcpy(tex[0].data(), result.stbi_data, levels.front().size);
+
+    stbi_image_free(result.stbi_data);
+    result.stbi_data = nullptr;
+
+    for (auto m = 1u; m < levels.size(); ++m)
+        downsample_rgba8((data_cptr) tex[m - 1].data(), levels[m - 1].extent, (data_ptr) tex[m].data(), srgb);
+
+    texture::layer layer;
+    layer.levels = levels;
+
+    result.layers = { layer };
+    result.data_size = tex.size();
+    result.gli_texture = tex;
+
+    return true;
 }
 
-//-----------------------------------------------------------------------------
-texture::ptr load_texture(device_ptr device, file_format file_format, texture_type type) {
+/**
+ * @brief Get the gli format of a block compression format
+ * 
+ * @param format          Block compression format
+ * 
+ * @return gli::format    gli format
+ */
+gli::format get_gli_bc_format(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        return gli::FORMAT_RGB_DXT1_UNORM_BLOCK8;
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        return gli::FORMAT_RGB_DXT1_SRGB_BLOCK8;
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        return gli::FORMAT_RGBA_DXT1_UNORM_BLOCK8;
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        return gli::FORMAT_RGBA_DXT1_SRGB_BLOCK8;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+        return gli::FORMAT_RGBA_DXT5_UNORM_BLOCK16;
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+        return gli::FORMAT_RGBA_DXT5_SRGB_BLOCK16;
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        return gli::FORMAT_R_ATI1N_UNORM_BLOCK8;
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        return gli::FORMAT_RG_ATI2N_UNORM_BLOCK16;
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+        return gli::FORMAT_RGBA_BP_UNORM_BLOCK16;
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return gli::FORMAT_RGBA_BP_SRGB_BLOCK16;
+    default:
+        return gli::FORMAT_UNDEFINED;
+    }
+}
+
+/**
+ * @brief Encode a decoded stbi texture (with all levels) to block compression
+ * 
+ * @param result    Decoded texture
+ * @param format    Block compression format
+ * 
+ * @return true     Encode was successful
+ * @return false    Encode failed
+ */
+bool encode_stbi_texture(decoded_texture& result, VkFormat format) {
+    auto const levels = result.layers.empty() ? texture::mip_level::list{ { result.size } }
+                                              : result.layers.front().levels;
+
+    gli::texture2d tex(get_gli_bc_format(format), gli::extent2d(result.size.x, result.size.y), levels.size());
+    if (tex.empty() || tex.levels() != levels.size())
+        return false;
+
+    gli::texture2d source;
+    if (!result.stbi_data)
+        source = gli::texture2d(result.gli_texture);
+
+    texture::layer layer;
+
+    for (auto m = 0u; m < levels.size(); ++m) {
+        auto const pixels = result.stbi_data ? (data_cptr) result.stbi_data : (data_cptr) source[m].data();
+
+        if (!encode_bc(format, pixels, levels[m].extent, (data_ptr) tex[m].data()))
+            return false;
+
+        texture::mip_level level;
+        level.extent = levels[m].extent;
+        level.size = to_ui32(tex[m].size());
+
+        layer.levels.push_back(level);
+    }
+
+    if (result.stbi_data) {
+        stbi_image_free(result.stbi_data);
+        result.stbi_data = nullptr;
+    }
+
+    result.format = format;
+    result.layers = { layer };
+    result.data_size = tex.size();
+    result.gli_texture = tex;
+
+    return true;
+}
+
+/**
+ * @brief Get the cache key of a processed texture
+ * 
+ * @param file       Source file (hashed in chunks)
+ * @param tag        Processing tag
+ * 
+ * @return string    Cache key (empty: not cacheable)
+ */
+string get_texture_cache_key(file& file, string_ref tag) {
+    if (!asset_cache::instance().activated() || !file.opened())
+        return {};
+
+    return asset_cache::make_key(asset_cache::hash(file), tag);
+}
+
+/**
+ * @brief Decode a texture from file
+ * 
+ * @param result         Decoded texture
+ * @param file_format    File and format
+ * @param type           Type of texture
+ * @param mip            Mip generation
+ * 
+ * @return true          Decode was successful
+ * @return false         Decode failed
+ */
+bool decode_texture(decoded_texture& result, file_format const& file_format,
+                    texture_type type, mip_generation mip) {
     auto use_gli = extension(str(file_format.path), { "DDS", "KTX", "KMG" });
     auto use_stbi = false;
 
@@ -225,40 +450,372 @@ texture::ptr load_texture(device_ptr device, file_format file_format, texture_ty
         use_stbi = extension(str(file_format.path), { "JPG", "PNG", "TGA", "BMP", "PSD", "GIF", "HDR", "PIC" });
 
     if (!use_gli && !use_stbi)
-        return nullptr;
+        return false;
 
     file file(str(file_format.path));
-    unique_data temp_data(file.get_size(), false);
 
-    if (file.opened()) {
-        if (!temp_data.allocate())
+    if (use_gli) {
+        unique_data temp_data(file.get_size(), false);
+
+        if (file.opened()) {
+            if (!temp_data.allocate())
+                return false;
+
+            if (file_error(file.read(temp_data.ptr)))
+                return false;
+        }
+
+        return decode_gli_texture(result, file, file_format.format, type, temp_data);
+    }
+
+    // float formats get their mip levels on the GPU
+    if (extension(str(file_format.path), { "HDR" })) {
+        result.mip = mip == mip_generation::none ? mip : mip_generation::gpu;
+        return decode_hdr_texture(result, file, file_format.format);
+    }
+
+    // block compression needs the mip chain on the CPU
+    auto const encode = bc_encode_supported(file_format.format);
+    if (encode && mip == mip_generation::gpu)
+        mip = mip_generation::cpu;
+
+    result.mip = mip;
+
+    if (!encode && mip != mip_generation::cpu)
+        return decode_stbi_texture(result, file, file_format.format);
+
+    auto const unorm = encode ? !format_srgb(file_format.format)
+                              : file_format.format == VK_FORMAT_R8G8B8A8_UNORM;
+    auto const pixel_format = unorm ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_SRGB;
+    auto const format = encode ? file_format.format : pixel_format;
+
+    string tag;
+    if (encode)
+        tag = fmt::format("bc_{}_{}.ktx", to_ui32(format), mip == mip_generation::none ? "base" : "mip");
+    else
+        tag = unorm ? "mip_unorm.ktx" : "mip_srgb.ktx";
+
+    auto const key = get_texture_cache_key(file, tag);
+    if (!key.empty()) {
+        unique_data cache_data;
+        if (asset_cache::instance().load(key, cache_data)) {
+            if (decode_gli_texture(result, gli::load(cache_data.ptr, cache_data.size), format, texture_type::tex_2d))
+                return true;
+
+            asset_cache::instance().remove(key);
+        }
+    }
+
+    if (!decode_stbi_texture(result, file, pixel_format))
+        return false;
+
+    if (mip == mip_generation::cpu && !generate_stbi_mip_chain(result))
+        return false;
+
+    if (encode && !encode_stbi_texture(result, format))
+        return false;
+
+    if (!key.empty()) {
+        std::vector<char> ktx_data;
+        if (gli::save_ktx(result.gli_texture, ktx_data))
+            asset_cache::instance().save(key, ktx_data.data(), ktx_data.size());
+    }
+
+    return true;
+}
+
+/**
+ * @brief Create a texture from decoded data
+ * 
+ * GPU mip generation falls back to the CPU if the format does not support blits
+ * (stbi data), other textures are created without mip levels.
+ * 
+ * @param device           Vulkan device
+ * @param decoded          Decoded texture
+ * @param tail_size        Max extent of mip levels staged at once (0: no streaming)
+ * 
+ * @return texture::ptr    Created texture
+ */
+texture::ptr create_texture(device_ptr device, decoded_texture& decoded, ui32 tail_size = 0) {
+    auto mip_levels = decoded.mip == mip_generation::gpu && decoded.layers.size() <= 1
+                      && (decoded.layers.empty() || decoded.layers.front().levels.size() == 1);
+
+    if (mip_levels && !format_blit_supported(device->get_vk_physical_device(), decoded.format, false)) {
+        if (decoded.stbi_data && !generate_stbi_mip_chain(decoded))
             return nullptr;
 
-        if (file_error(file.read(temp_data.ptr)))
+        mip_levels = false;
+    }
+
+    auto texture = make_texture();
+
+    if (!texture->create(device, decoded.size, decoded.format, decoded.layers, decoded.type, mip_levels))
+        return nullptr;
+
+    if (tail_size > 0) {
+        if (!texture->upload_stream(decoded.data(), decoded.data_size, tail_size))
             return nullptr;
+    } else if (!texture->upload(decoded.data(), decoded.data_size)) {
+        return nullptr;
     }
 
-    if (use_gli) {
-        texture::layer::list layers;
+    return texture;
+}
+
+//-----------------------------------------------------------------------------
+texture::ptr load_texture(device_ptr device, file_format file_format, texture_type type, mip_generation mip) {
+    decoded_texture decoded;
+    if (!decode_texture(decoded, file_format, type, mip))
+        return nullptr;
+
+    return create_texture(device, decoded);
+}
+
+//-----------------------------------------------------------------------------
+texture::ptr load_streamed_texture(device_ptr device, file_format file_format, texture_type type, ui32 tail_size) {
+    decoded_texture decoded;
+    if (!decode_texture(decoded, file_format, type, mip_generation::cpu))
+        return nullptr;
+
+    return create_texture(device, decoded, std::max(tail_size, 1u));
+}
+
+//-----------------------------------------------------------------------------
+texture_batch::~texture_batch() {
+    cancel();
+}
+
+//-----------------------------------------------------------------------------
+bool texture_batch::start(device_ptr d, file_format::list const& file_formats, texture_type t,
+                          mip_generation m, ui32 thread_count) {
+    if (!done())
+        return false;
+
+    device = d;
+    files = file_formats;
+    type = t;
+    mip = m;
+
+    textures.assign(files.size(), nullptr);
+    create_count = 0;
+    failed_count = 0;
+    canceled = false;
+
+    uploading.clear();
+    uploaded = std::make_shared<index_list>();
 
-        switch (type) {
-        case texture_type::tex_2d: {
-            return create_gli_texture_2d(device, file, file_format.format, temp_data);
+    if (files.empty())
+        return true;
+
+    if (thread_count == 0)
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    pool.setup(std::min(thread_count, to_ui32(files.size())));
+
+    for (auto i = 0u; i < files.size(); ++i) {
+        pool.enqueue([&, i](id::ref) {
+            std::shared_ptr<decoded_texture> decoded;
+
+            if (!canceled) {
+                decoded = std::make_shared<decoded_texture>();
+                if (!decode_texture(*decoded, files[i], type, mip))
+                    decoded = nullptr;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                pending.emplace_back(i, decoded);
+            }
+
+            condition.notify_one();
+        });
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+ui32 texture_batch::poll(staging* staging) {
+    auto const result = handle_uploaded() + create_textures(staging, uploads != nullptr);
+
+    if (done() && !files.empty())
+        pool.teardown();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+ui32 texture_batch::create_textures(staging* staging, bool upload) {
+    std::deque<decoded_item> ready;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.swap(pending);
+    }
+
+    ui32 result = 0;
+
+    // Vulkan objects are created on the calling thread only
+
+    for (auto& [idx, decoded] : ready) {
+        texture::ptr texture;
+        if (decoded)
+            texture = create_texture(device, *decoded);
+
+        // handled after the upload context acquired the texture
+        if (texture && upload) {
+            std::weak_ptr<index_list> list = uploaded;
+
+            auto const added = uploads->add(texture, [list, idx = idx]() {
+                if (auto indices = list.lock())
+                    indices->push_back(idx);
+            });
+
+            if (added) {
+                uploading.emplace(idx, texture);
+                continue;
+            }
         }
 
-        case texture_type::array: {
-            return create_gli_texture_array(device, file, file_format.format, temp_data);
+        if (texture && staging)
+            staging->add(texture);
+
+        handle(idx, texture);
+        ++result;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+ui32 texture_batch::handle_uploaded() {
+    if (!uploaded || uploaded->empty())
+        return 0;
+
+    auto const indices = std::move(*uploaded);
+    uploaded->clear();
+
+    for (auto idx : indices) {
+        auto texture = uploading.at(idx);
+        uploading.erase(idx);
+
+        handle(idx, texture);
+    }
+
+    return to_ui32(indices.size());
+}
+
+//-----------------------------------------------------------------------------
+void texture_batch::handle(index idx, texture::ptr texture) {
+    if (texture) {
+        textures[idx] = texture;
+    } else {
+        log()->error("load texture {}", files[idx].path);
+        ++failed_count;
+    }
+
+    ++create_count;
+
+    if (on_loaded)
+        on_loaded(idx, texture);
+}
+
+//-----------------------------------------------------------------------------
+void texture_batch::wait(staging* staging) {
+    // textures in the upload context are handled by poll
+    while (create_count + uploading.size() < files.size()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return !pending.empty(); });
         }
 
-        case texture_type::cube_map: {
-            return create_gli_texture_cube_map(device, file, file_format.format, temp_data);
+        create_textures(staging, false);
+    }
+
+    if (done() && !files.empty())
+        pool.teardown();
+}
+
+//-----------------------------------------------------------------------------
+void texture_batch::cancel() {
+    if (done())
+        return;
+
+    canceled = true;
+    pool.teardown();
+
+    // acquired textures are not handled anymore
+    uploading.clear();
+    uploaded = nullptr;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.clear();
+
+    create_count = to_ui32(files.size());
+}
+
+//-----------------------------------------------------------------------------
+texture::list load_textures(device_ptr device, file_format::list const& files,
+                            texture_type type, mip_generation mip, staging* staging, ui32 thread_count) {
+    texture_batch batch;
+    if (!batch.start(device, files, type, mip, thread_count))
+        return {};
+
+    batch.wait(staging);
+
+    return batch.get_textures();
+}
+
+//-----------------------------------------------------------------------------
+ui32 add_atlas_files(texture_atlas& atlas, file_format::list const& files) {
+    auto result = 0u;
+
+    for (auto const& file_format : files) {
+        if (atlas.get_index(file_format) != no_index) {
+            ++result;
+            continue;
         }
+
+        file file(str(file_format.path));
+        if (!file.opened()) {
+            log()->error("atlas file not found - {}", file_format.path);
+            continue;
         }
-    } else {
-        return create_stbi_texture(device, file, temp_data);
+
+        uv2 size{};
+        ui32 channels = 0;
+        auto const pixels = load_image_data(file, size, channels);
+        if (!pixels) {
+            log()->error("decode atlas file - {}", file_format.path);
+            continue;
+        }
+
+        if (atlas.add(file_format, pixels, size) != no_index)
+            ++result;
+
+        free_image_data(pixels);
     }
 
-    return nullptr;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+texture_atlas::ptr load_texture_atlas(device_ptr device, file_format::list const& files,
+                                      uv2 page_size, texture_type type, ui32 padding) {
+    auto format = VK_FORMAT_R8G8B8A8_SRGB;
+    if (!files.empty() && files.front().format == VK_FORMAT_R8G8B8A8_UNORM)
+        format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    auto result = make_texture_atlas();
+    if (!result->create(device, page_size, type, format, padding))
+        return nullptr;
+
+    if (add_atlas_files(*result, files) == 0)
+        return nullptr;
+
+    if (!result->build())
+        return nullptr;
+
+    return result;
 }
 
 //-----------------------------------------------------------------------------
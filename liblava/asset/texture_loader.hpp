@@ -8,19 +8,37 @@
 #pragma once
 
 #include <liblava/resource/texture.hpp>
+#include <liblava/resource/texture_atlas.hpp>
+#include <liblava/resource/upload_context.hpp>
+#include <liblava/util/thread.hpp>
 
 namespace lava {
 
+/**
+ * @brief Mip generation of textures without mip levels (stb formats)
+ */
+enum class mip_generation : type {
+    none = 0,
+    cpu,
+    gpu
+};
+
 /**
  * @brief Load texture from file
  * 
+ * Block compression formats (BC1, BC3, BC4, BC5, BC7) are encoded from stb sources.
+ * HDR files are loaded as R16G16B16A16_SFLOAT (or B10G11R11_UFLOAT, R32G32B32A32_SFLOAT
+ * if requested), their mip levels are generated on the GPU.
+ * 
  * @param device           Vulkan device
  * @param file_format      File and format
  * @param type             Type of texture
+ * @param mip              Mip generation
  * 
  * @return texture::ptr    Loaded texture
  */
-texture::ptr load_texture(device_ptr device, file_format file_format, texture_type type = texture_type::tex_2d);
+texture::ptr load_texture(device_ptr device, file_format file_format, texture_type type = texture_type::tex_2d,
+                          mip_generation mip = mip_generation::cpu);
 
 /**
  * @brief Load texture from file with default format (sRGB)
@@ -29,14 +47,295 @@ texture::ptr load_texture(device_ptr device, file_format file_format, texture_ty
  * @param filename         File to load
  * @param format           Format of texture
  * @param type             Type of texture
+ * @param mip              Mip generation
  * 
  * @return texture::ptr    Loaded texture
  */
 inline texture::ptr load_texture(device_ptr device, string_ref filename,
-                                 VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, texture_type type = texture_type::tex_2d) {
-    return load_texture(device, { filename, format }, type);
+                                 VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, texture_type type = texture_type::tex_2d,
+                                 mip_generation mip = mip_generation::cpu) {
+    return load_texture(device, { filename, format }, type, mip);
 }
 
+/**
+ * @brief Load texture from file and stream the mip levels
+ * 
+ * Mip levels up to the tail size are staged at once, the larger levels are streamed
+ * by the staging over the next frames (see staging::set_stream_budget).
+ * Textures without mip levels get a CPU mip chain.
+ * 
+ * @param device           Vulkan device
+ * @param file_format      File and format
+ * @param type             Type of texture
+ * @param tail_size        Max extent of mip levels staged at once
+ * 
+ * @return texture::ptr    Loaded texture
+ */
+texture::ptr load_streamed_texture(device_ptr device, file_format file_format,
+                                   texture_type type = texture_type::tex_2d, ui32 tail_size = 128);
+
+/// Decoded texture
+struct decoded_texture;
+
+/**
+ * @brief Batch of textures decoded on a thread pool
+ */
+struct texture_batch {
+    /// Shared pointer to texture batch
+    using ptr = std::shared_ptr<texture_batch>;
+
+    /// Loaded function (with index in file list, nullptr on failure)
+    using loaded_func = std::function<void(index, texture::ptr)>;
+
+    /**
+     * @brief Destroy the texture batch
+     */
+    ~texture_batch();
+
+    /**
+     * @brief Start decoding the files
+     * 
+     * @param device          Vulkan device
+     * @param files           List of files and formats
+     * @param type            Type of textures
+     * @param mip             Mip generation
+     * @param thread_count    Number of decode threads (0: hardware concurrency)
+     * 
+     * @return true           Start was successful
+     * @return false          Batch is still running
+     */
+    bool start(device_ptr device, file_format::list const& files,
+               texture_type type = texture_type::tex_2d,
+               mip_generation mip = mip_generation::cpu, ui32 thread_count = 0);
+
+    /**
+     * @brief Set the upload context (before start)
+     * 
+     * Created textures are copied on the transfer queue instead of the staging.
+     * They are handled (see on_loaded) after the upload context acquired them.
+     * 
+     * @param value    Upload context (nullptr: staging)
+     */
+    void set_upload_context(upload_context::ptr value) {
+        uploads = value;
+    }
+
+    /**
+     * @brief Create textures of all decoded files (call on device thread)
+     * 
+     * @param staging    Staging to add created textures (optional)
+     * 
+     * @return ui32      Number of handled files
+     */
+    ui32 poll(staging* staging = nullptr);
+
+    /**
+     * @brief Wait until all files are loaded
+     * 
+     * Textures are added to the staging, the upload context is not used.
+     * 
+     * @param staging    Staging to add created textures (optional)
+     */
+    void wait(staging* staging = nullptr);
+
+    /**
+     * @brief Cancel the batch
+     */
+    void cancel();
+
+    /**
+     * @brief Check if all files are handled
+     * 
+     * @return true     Batch is done
+     * @return false    Batch is running
+     */
+    bool done() const {
+        return create_count == files.size();
+    }
+
+    /**
+     * @brief Get the number of handled files
+     * 
+     * @return ui32    Number of handled files
+     */
+    ui32 get_loaded_count() const {
+        return create_count;
+    }
+
+    /**
+     * @brief Get the number of failed files
+     * 
+     * @return ui32    Number of failed files
+     */
+    ui32 get_failed_count() const {
+        return failed_count;
+    }
+
+    /**
+     * @brief Get the textures (same order as files)
+     * 
+     * @return texture::list const&    List of textures
+     */
+    texture::list const& get_textures() const {
+        return textures;
+    }
+
+    /// Called on texture loaded
+    loaded_func on_loaded;
+
+private:
+    /// Decoded item with index in file list
+    using decoded_item = std::pair<index, std::shared_ptr<decoded_texture>>;
+
+    /**
+     * @brief Create textures of the decoded files
+     * 
+     * @param staging    Staging to add created textures (optional)
+     * @param upload     Add created textures to the upload context
+     * 
+     * @return ui32      Number of handled files
+     */
+    ui32 create_textures(staging* staging, bool upload);
+
+    /**
+     * @brief Handle the textures acquired by the upload context
+     * 
+     * @return ui32    Number of handled files
+     */
+    ui32 handle_uploaded();
+
+    /**
+     * @brief Handle a created texture
+     * 
+     * @param idx        Index in file list
+     * @param texture    Created texture (nullptr on failure)
+     */
+    void handle(index idx, texture::ptr texture);
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// List of files
+    file_format::list files;
+
+    /// Type of textures
+    texture_type type = texture_type::tex_2d;
+
+    /// Mip generation
+    mip_generation mip = mip_generation::cpu;
+
+    /// List of textures
+    texture::list textures;
+
+    /// Decode thread pool
+    thread_pool pool;
+
+    /// Decoded items waiting for creation
+    std::deque<decoded_item> pending;
+
+    /// Upload context (nullptr: staging)
+    upload_context::ptr uploads;
+
+    /// Textures in the upload context by index in file list
+    std::map<index, texture::ptr> uploading;
+
+    /// Indices of textures acquired by the upload context
+    std::shared_ptr<index_list> uploaded;
+
+    /// Pending mutex
+    std::mutex mutex;
+
+    /// Pending condition
+    std::condition_variable condition;
+
+    /// Number of handled files
+    ui32 create_count = 0;
+
+    /// Number of failed files
+    ui32 failed_count = 0;
+
+    /// Cancel state
+    std::atomic<bool> canceled = false;
+};
+
+/**
+ * @brief Make a new texture batch
+ * 
+ * @return texture_batch::ptr    Shared pointer to texture batch
+ */
+inline texture_batch::ptr make_texture_batch() {
+    return std::make_shared<texture_batch>();
+}
+
+/**
+ * @brief Load textures from files in parallel
+ * 
+ * Files are decoded on a thread pool, textures are created on the calling thread.
+ * 
+ * @param device            Vulkan device
+ * @param files             List of files and formats
+ * @param type              Type of textures
+ * @param mip               Mip generation
+ * @param staging           Staging to add loaded textures (optional)
+ * @param thread_count      Number of decode threads (0: hardware concurrency)
+ * 
+ * @return texture::list    Loaded textures (same order as files, nullptr on failure)
+ */
+texture::list load_textures(device_ptr device, file_format::list const& files,
+                            texture_type type = texture_type::tex_2d,
+                            mip_generation mip = mip_generation::cpu,
+                            staging* staging = nullptr, ui32 thread_count = 0);
+
+/**
+ * @brief Load textures from files asynchronously
+ * 
+ * Call texture_batch::poll on the device thread (e.g. every frame) to create the decoded textures.
+ * 
+ * @param device                 Vulkan device
+ * @param files                  List of files and formats
+ * @param type                   Type of textures
+ * @param mip                    Mip generation
+ * @param thread_count           Number of decode threads (0: hardware concurrency)
+ * 
+ * @return texture_batch::ptr    Started texture batch
+ */
+inline texture_batch::ptr load_textures_async(device_ptr device, file_format::list const& files,
+                                              texture_type type = texture_type::tex_2d,
+                                              mip_generation mip = mip_generation::cpu, ui32 thread_count = 0) {
+    auto result = make_texture_batch();
+    if (!result->start(device, files, type, mip, thread_count))
+        return nullptr;
+
+    return result;
+}
+
+/**
+ * @brief Add image files to a texture atlas (stb formats, RGBA8)
+ * 
+ * @param atlas     Texture atlas
+ * @param files     List of files and formats (lookup keys)
+ * 
+ * @return ui32     Number of added files
+ */
+ui32 add_atlas_files(texture_atlas& atlas, file_format::list const& files);
+
+/**
+ * @brief Load small textures into a texture atlas
+ * 
+ * The atlas texture is built and needs to be staged.
+ * 
+ * @param device                 Vulkan device
+ * @param files                  List of files and formats
+ * @param page_size              Size of atlas page
+ * @param type                   Type of atlas (tex_2d or array)
+ * @param padding                Padding around images in pixels
+ * 
+ * @return texture_atlas::ptr    Built texture atlas
+ */
+texture_atlas::ptr load_texture_atlas(device_ptr device, file_format::list const& files,
+                                      uv2 page_size = { 2048, 2048 },
+                                      texture_type type = texture_type::array, ui32 padding = 4);
+
 /**
  * @brief Create a default texture with checkerboard pattern
  * 
@@ -14,4 +14,6 @@
 #include <liblava/base/instance.hpp>
 #include <liblava/base/memory.hpp>
 #include <liblava/base/physical_device.hpp>
+#include <liblava/base/pipeline_cache.hpp>
 #include <liblava/base/queue.hpp>
+#include <liblava/base/sampler_cache.hpp>
@@ -5,6 +5,7 @@
  * @copyright    Copyright (c) 2018-present, MIT License
  */
 
+#include <filesystem>
 #include <liblava/base/device.hpp>
 #include <liblava/base/instance.hpp>
 #include <liblava/base/physical_device.hpp>
@@ -99,9 +100,31 @@ bool device::create(create_param::ref param) {
         queue_create_info_list[i].pQueuePriorities = priorities.at(i).data();
     }
 
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+        .pNext = const_cast<void*>(param.next),
+        .timelineSemaphore = VK_TRUE,
+    };
+
+    auto next = param.next;
+    if (param.timeline_semaphore) {
+        next = &timeline_semaphore_features;
+
+        // the feature must not be chained twice, enable it in a given struct
+        for (auto* item = (VkBaseOutStructure*) param.next; item; item = item->pNext) {
+            if (item->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES) {
+                ((VkPhysicalDeviceVulkan12Features*) item)->timelineSemaphore = VK_TRUE;
+                next = param.next;
+            } else if (item->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR) {
+                ((VkPhysicalDeviceTimelineSemaphoreFeaturesKHR*) item)->timelineSemaphore = VK_TRUE;
+                next = param.next;
+            }
+        }
+    }
+
     VkDeviceCreateInfo create_info{
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = param.next,
+        .pNext = next,
         .queueCreateInfoCount = to_ui32(queue_create_info_list.size()),
         .pQueueCreateInfos = queue_create_info_list.data(),
         .enabledLayerCount = 0,
@@ -117,9 +140,17 @@ bool device::create(create_param::ref param) {
     }
 
     features = param.features;
+    timeline_semaphore = param.timeline_semaphore;
 
     load_table();
 
+    samplers.create(this);
+
+    if (!pipelines.create(this, param.pipeline_cache_file)) {
+        destroy();
+        return false;
+    }
+
     graphics_queue_list.clear();
     compute_queue_list.clear();
     transfer_queue_list.clear();
@@ -164,6 +195,12 @@ void device::destroy() {
     transfer_queue_list.clear();
     queue_list.clear();
 
+    upload = nullptr;
+    timeline_semaphore = false;
+
+    samplers.destroy();
+    pipelines.destroy();
+
     if (mem_allocator) {
         mem_allocator->destroy();
         mem_allocator = nullptr;
@@ -217,6 +254,15 @@ device::ptr device_manager::create(index pd) {
         return nullptr;
 
     auto param = physical_device->create_default_device_param();
+
+    // one cache file per device and vendor, the header is validated on load
+    if (!pipeline_cache_dir.empty()) {
+        auto const& properties = physical_device->get_properties();
+        auto const file = fmt::format("pipeline_cache_{:x}_{:x}.bin", properties.vendorID, properties.deviceID);
+
+        param.pipeline_cache_file = (std::filesystem::path(pipeline_cache_dir) / file).string();
+    }
+
     if (on_create_param)
         on_create_param(param);
 
@@ -9,12 +9,15 @@
 
 #include <liblava/base/device_table.hpp>
 #include <liblava/base/queue.hpp>
+#include <liblava/base/pipeline_cache.hpp>
+#include <liblava/base/sampler_cache.hpp>
 #include <liblava/core/data.hpp>
 
 namespace lava {
 
 /// fwd
 struct physical_device;
+struct upload_ring;
 
 /// Const pointer to a physical device
 using physical_device_cptr = physical_device const*;
@@ -51,6 +54,13 @@ struct device : device_table, entity {
         /// Create parameter next pointer (pNext)
         void const* next = nullptr;
 
+        /// Enable timeline semaphores (needs VK_KHR_timeline_semaphore, set in a chained
+        /// Vulkan 1.2 or timeline semaphore features struct if next has one)
+        bool timeline_semaphore = false;
+
+        /// File of persistent pipeline cache (empty: in memory only)
+        string pipeline_cache_file;
+
         /// List of queue famiy infos
         queue_family_info::list queue_family_infos;
 
@@ -307,6 +317,16 @@ struct device : device_table, entity {
      */
     VkPhysicalDeviceFeatures const& get_features() const;
 
+    /**
+     * @brief Check if timeline semaphores are enabled
+     * 
+     * @return true     Timeline semaphores are enabled
+     * @return false    Binary semaphores only
+     */
+    bool timeline_semaphore_enabled() const {
+        return timeline_semaphore;
+    }
+
     /**
      * @brief Get the physical device properties
      * 
@@ -338,7 +358,7 @@ struct device : device_table, entity {
      * 
      * @return allocator::ptr    Allocator
      */
-    allocator::ptr get_allocator() {
+    allocator::ptr get_allocator() const {
         return mem_allocator;
     }
 
@@ -351,6 +371,42 @@ struct device : device_table, entity {
         return mem_allocator != nullptr ? mem_allocator->get() : nullptr;
     }
 
+    /**
+     * @brief Set the upload ring for this device
+     * 
+     * @param value    Upload ring (see liblava/resource/upload_ring.hpp)
+     */
+    void set_upload_ring(std::shared_ptr<upload_ring> value) {
+        upload = value;
+    }
+
+    /**
+     * @brief Get the upload ring of this device
+     * 
+     * @return std::shared_ptr<upload_ring>    Upload ring (nullptr: dedicated upload buffers)
+     */
+    std::shared_ptr<upload_ring> get_upload_ring() const {
+        return upload;
+    }
+
+    /**
+     * @brief Get the sampler cache of this device
+     * 
+     * @return sampler_cache&    Sampler cache
+     */
+    sampler_cache& get_sampler_cache() {
+        return samplers;
+    }
+
+    /**
+     * @brief Get the pipeline cache of this device
+     * 
+     * @return pipeline_cache&    Pipeline cache
+     */
+    pipeline_cache& get_pipeline_cache() {
+        return pipelines;
+    }
+
 private:
     /// Physical device
     physical_device_cptr physical_device = nullptr;
@@ -370,8 +426,20 @@ private:
     /// Device features
     VkPhysicalDeviceFeatures features{};
 
+    /// Timeline semaphores enabled
+    bool timeline_semaphore = false;
+
     /// Device allocator
     allocator::ptr mem_allocator;
+
+    /// Upload ring
+    std::shared_ptr<upload_ring> upload;
+
+    /// Shared samplers
+    sampler_cache samplers;
+
+    /// Default pipeline cache
+    pipeline_cache pipelines;
 };
 
 /**
@@ -418,6 +486,9 @@ struct device_manager {
     /// Create parameter function
     using create_param_func = std::function<void(device::create_param&)>;
 
+    /// Directory of persistent pipeline caches (empty: in memory only)
+    string pipeline_cache_dir;
+
     /// Called on create to adjust the create parameters
     create_param_func on_create_param;
 
@@ -159,7 +159,12 @@ bool allocator::create(device_cptr device, VmaAllocatorCreateFlags flags) {
         .instance = instance::get(),
     };
 
-    return check(vmaCreateAllocator(&allocator_info, &vma_allocator));
+    if (!check(vmaCreateAllocator(&allocator_info, &vma_allocator)))
+        return false;
+
+    budget_ext = (flags & VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT) != 0;
+
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -171,4 +176,78 @@ void allocator::destroy() {
     vma_allocator = nullptr;
 }
 
+//-----------------------------------------------------------------------------
+memory_budget allocator::get_budget(VkMemoryHeapFlags heap_flags) const {
+    memory_budget result;
+    if (!vma_allocator)
+        return result;
+
+    VkPhysicalDeviceMemoryProperties const* properties = nullptr;
+    vmaGetMemoryProperties(vma_allocator, &properties);
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets(vma_allocator, budgets.data());
+
+    for (auto i = 0u; i < properties->memoryHeapCount; ++i) {
+        if ((properties->memoryHeaps[i].flags & heap_flags) != heap_flags)
+            continue;
+
+        result.budget += budgets[i].budget;
+        result.usage += budgets[i].usage;
+        result.block_bytes += budgets[i].statistics.blockBytes;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+memory_heap_stats::list allocator::get_heap_stats() const {
+    memory_heap_stats::list result;
+    if (!vma_allocator)
+        return result;
+
+    VkPhysicalDeviceMemoryProperties const* properties = nullptr;
+    vmaGetMemoryProperties(vma_allocator, &properties);
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets(vma_allocator, budgets.data());
+
+    for (auto i = 0u; i < properties->memoryHeapCount; ++i) {
+        memory_heap_stats stats;
+        stats.heap = i;
+        stats.flags = properties->memoryHeaps[i].flags;
+        stats.size = properties->memoryHeaps[i].size;
+        stats.budget = budgets[i].budget;
+        stats.usage = budgets[i].usage;
+        stats.block_bytes = budgets[i].statistics.blockBytes;
+        stats.allocation_bytes = budgets[i].statistics.allocationBytes;
+        stats.block_count = budgets[i].statistics.blockCount;
+        stats.allocation_count = budgets[i].statistics.allocationCount;
+
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+string allocator::get_stats_json(bool detailed) const {
+    if (!vma_allocator)
+        return {};
+
+    char* stats = nullptr;
+    vmaBuildStatsString(vma_allocator, &stats, detailed);
+
+    string result = stats ? stats : "";
+    vmaFreeStatsString(vma_allocator, stats);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+memory_heap_stats::list memory_stats(device_cptr device) {
+    auto const allocator = device->get_allocator();
+    return allocator ? allocator->get_heap_stats() : memory_heap_stats::list{};
+}
+
 } // namespace lava
@@ -22,6 +22,55 @@ struct device;
 /// Const pointer to device
 using device_cptr = device const*;
 
+/**
+ * @brief Memory budget of heaps
+ */
+struct memory_budget {
+    /// Memory available to the process
+    VkDeviceSize budget = 0;
+
+    /// Memory used by the process (including other allocators)
+    VkDeviceSize usage = 0;
+
+    /// Memory allocated in blocks of this allocator
+    VkDeviceSize block_bytes = 0;
+};
+
+/**
+ * @brief Memory statistics of a heap
+ */
+struct memory_heap_stats {
+    /// List of heap statistics
+    using list = std::vector<memory_heap_stats>;
+
+    /// Heap index
+    index heap = 0;
+
+    /// Heap flags
+    VkMemoryHeapFlags flags = 0;
+
+    /// Heap size
+    VkDeviceSize size = 0;
+
+    /// Memory available to the process
+    VkDeviceSize budget = 0;
+
+    /// Memory used by the process (including other allocators)
+    VkDeviceSize usage = 0;
+
+    /// Memory allocated in blocks of this allocator
+    VkDeviceSize block_bytes = 0;
+
+    /// Memory used by allocations in blocks
+    VkDeviceSize allocation_bytes = 0;
+
+    /// Number of blocks
+    ui32 block_count = 0;
+
+    /// Number of allocations
+    ui32 allocation_count = 0;
+};
+
 /**
  * @brief Vulkan allocator
  */
@@ -77,9 +126,50 @@ struct allocator {
         return vma_allocator;
     }
 
+    /**
+     * @brief Get the memory budget of heaps
+     *
+     * Budget and usage are estimated by Vma if VK_EXT_memory_budget is not enabled
+     * (see VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT).
+     *
+     * @param heap_flags         Required heap flags (0: all heaps)
+     *
+     * @return memory_budget     Sum of matching heaps
+     */
+    memory_budget get_budget(VkMemoryHeapFlags heap_flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) const;
+
+    /**
+     * @brief Get the memory statistics of all heaps
+     *
+     * @return memory_heap_stats::list    List of heap statistics
+     */
+    memory_heap_stats::list get_heap_stats() const;
+
+    /**
+     * @brief Get the statistics as json (Vma stats string)
+     *
+     * @param detailed    Include the detailed map of all allocations
+     *
+     * @return string     Json statistics
+     */
+    string get_stats_json(bool detailed = false) const;
+
+    /**
+     * @brief Check if the memory budget extension is used
+     *
+     * @return true     Budget is queried from the driver
+     * @return false    Budget is estimated
+     */
+    bool budget_supported() const {
+        return budget_ext;
+    }
+
 private:
     /// Vma allocator
     VmaAllocator vma_allocator = nullptr;
+
+    /// VK_EXT_memory_budget is used
+    bool budget_ext = false;
 };
 
 /**
@@ -107,6 +197,15 @@ inline allocator::ptr create_allocator(device_cptr device, VmaAllocatorCreateFla
     return result;
 }
 
+/**
+ * @brief Get the memory statistics of all heaps of a device
+ *
+ * @param device                      Vulkan device
+ *
+ * @return memory_heap_stats::list    List of heap statistics
+ */
+memory_heap_stats::list memory_stats(device_cptr device);
+
 /**
  * @brief Vulkan memory
  */
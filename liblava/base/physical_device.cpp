@@ -66,6 +66,30 @@ device::create_param physical_device::create_default_device_param() const {
     create_param.add_swapchain_extension();
     create_param.set_default_queues();
 
+    // needs VK_KHR_get_physical_device_properties2 on the instance
+    if (supported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) && vkGetPhysicalDeviceMemoryProperties2KHR) {
+        create_param.extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        create_param.vma_flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+
+    if (supported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) && vkGetPhysicalDeviceFeatures2KHR) {
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+        };
+
+        VkPhysicalDeviceFeatures2KHR features2{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+            .pNext = &timeline_semaphore_features,
+        };
+
+        vkGetPhysicalDeviceFeatures2KHR(vk_physical_device, &features2);
+
+        if (timeline_semaphore_features.timelineSemaphore) {
+            create_param.extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+            create_param.timeline_semaphore = true;
+        }
+    }
+
     return create_param;
 }
 
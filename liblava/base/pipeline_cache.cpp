@@ -0,0 +1,154 @@
+/**
+ * @file         liblava/base/pipeline_cache.cpp
+ * @brief        Persistent pipeline cache of a device
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <liblava/base/device.hpp>
+#include <liblava/base/pipeline_cache.hpp>
+
+namespace lava {
+
+/// Size of pipeline cache header version one (size, version, vendor, device, uuid)
+constexpr size_t const pipeline_cache_header_size = 4 * sizeof(ui32) + VK_UUID_SIZE;
+
+//-----------------------------------------------------------------------------
+bool pipeline_cache_compatible(cdata const& data, VkPhysicalDeviceProperties const& properties) {
+    if (!data.ptr || data.size < pipeline_cache_header_size)
+        return false;
+
+    ui32 header[4] = {};
+    memcpy(header, data.ptr, sizeof(header));
+
+    auto const [header_size, header_version, vendor_id, device_id] = header;
+
+    if (header_size < pipeline_cache_header_size || header_size > data.size)
+        return false;
+
+    if (header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+        return false;
+
+    if (vendor_id != properties.vendorID || device_id != properties.deviceID)
+        return false;
+
+    return memcmp((ui8 const*) data.ptr + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+//-----------------------------------------------------------------------------
+bool pipeline_cache::create(device* d, string_ref p) {
+    vk_device = d;
+    path = p;
+    loaded_size = 0;
+
+    std::vector<char> data;
+    if (load(data))
+        loaded_size = data.size();
+
+    VkPipelineCacheCreateInfo const create_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = loaded_size,
+        .pInitialData = loaded_size > 0 ? data.data() : nullptr,
+    };
+
+    if (failed(vk_device->call().vkCreatePipelineCache(vk_device->get(), &create_info,
+                                                       memory::alloc(), &vk_pipeline_cache))) {
+        log()->error("create pipeline cache");
+        return false;
+    }
+
+    if (loaded_size > 0)
+        log()->debug("pipeline cache - loaded {} KB from {}", loaded_size >> 10, path);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void pipeline_cache::destroy() {
+    if (!vk_pipeline_cache)
+        return;
+
+    save();
+
+    vk_device->call().vkDestroyPipelineCache(vk_device->get(), vk_pipeline_cache, memory::alloc());
+    vk_pipeline_cache = VK_NULL_HANDLE;
+
+    vk_device = nullptr;
+    loaded_size = 0;
+}
+
+//-----------------------------------------------------------------------------
+bool pipeline_cache::load(std::vector<char>& data) const {
+    if (path.empty())
+        return false;
+
+    std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+    if (!file.is_open())
+        return false;
+
+    auto const file_size = to_size_t(file.tellg());
+
+    data.resize(file_size);
+
+    file.seekg(0, std::ios::beg);
+    file.read(data.data(), file_size);
+
+    if (!file.good())
+        return false;
+
+    if (!pipeline_cache_compatible({ data.data(), data.size() }, vk_device->get_properties())) {
+        log()->warn("pipeline cache - discard incompatible {}", path);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool pipeline_cache::save() const {
+    if (!vk_pipeline_cache || path.empty())
+        return false;
+
+    size_t size = 0;
+    if (failed(vk_device->call().vkGetPipelineCacheData(vk_device->get(), vk_pipeline_cache, &size, nullptr)))
+        return false;
+
+    std::vector<char> data(size);
+    if (failed(vk_device->call().vkGetPipelineCacheData(vk_device->get(), vk_pipeline_cache, &size, data.data())))
+        return false;
+
+    // write to a temporary file first, the cache file is never partial
+    auto const target = std::filesystem::path(path);
+    auto temp = target;
+    temp += ".tmp";
+
+    {
+        std::ofstream file(temp, std::ofstream::binary | std::ofstream::trunc);
+        if (!file.is_open()) {
+            log()->error("save pipeline cache {}", path);
+            return false;
+        }
+
+        file.write(data.data(), size);
+        if (!file.good()) {
+            log()->error("write pipeline cache {}", path);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp, target, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        log()->error("rename pipeline cache {}", path);
+        return false;
+    }
+
+    log()->debug("pipeline cache - saved {} KB to {}", size >> 10, path);
+
+    return true;
+}
+
+} // namespace lava
@@ -0,0 +1,114 @@
+/**
+ * @file         liblava/base/pipeline_cache.hpp
+ * @brief        Persistent pipeline cache of a device
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/base/base.hpp>
+#include <liblava/core/data.hpp>
+
+namespace lava {
+
+/// fwd
+struct device;
+
+/**
+ * @brief Check if pipeline cache data was written by a physical device
+ *
+ * Validates the header (version one) vendor, device and pipeline cache UUID.
+ *
+ * @param data          Pipeline cache data
+ * @param properties    Physical device properties
+ *
+ * @return true         Data can be loaded
+ * @return false        Data is invalid or from another device or driver
+ */
+bool pipeline_cache_compatible(cdata const& data, VkPhysicalDeviceProperties const& properties);
+
+/**
+ * @brief Pipeline cache
+ *
+ * Loaded from a file when the device is created and saved back when it is
+ * destroyed (written to a temporary file first, then renamed). Used by all
+ * pipelines that do not pass an own cache.
+ */
+struct pipeline_cache : no_copy_no_move {
+    /**
+     * @brief Create the pipeline cache
+     *
+     * @param device    Vulkan device
+     * @param path      Cache file (empty: in memory only)
+     *
+     * @return true     Create was successful
+     * @return false    Create failed
+     */
+    bool create(device* device, string_ref path = {});
+
+    /**
+     * @brief Save and destroy the pipeline cache
+     */
+    void destroy();
+
+    /**
+     * @brief Save the pipeline cache to the file
+     *
+     * @return true     Save was successful
+     * @return false    No file or save failed
+     */
+    bool save() const;
+
+    /**
+     * @brief Get the Vulkan pipeline cache
+     *
+     * @return VkPipelineCache    Pipeline cache
+     */
+    VkPipelineCache get() const {
+        return vk_pipeline_cache;
+    }
+
+    /**
+     * @brief Get the cache file
+     *
+     * @return string_ref    Cache file (empty: in memory only)
+     */
+    string_ref get_path() const {
+        return path;
+    }
+
+    /**
+     * @brief Get the size of the loaded data
+     *
+     * @return size_t    Bytes loaded from the file (0: cold start)
+     */
+    size_t get_loaded_size() const {
+        return loaded_size;
+    }
+
+private:
+    /**
+     * @brief Load the cache file
+     *
+     * @param data      Loaded data
+     *
+     * @return true     Compatible data was loaded
+     * @return false    No file or incompatible data
+     */
+    bool load(std::vector<char>& data) const;
+
+    /// Vulkan device
+    device* vk_device = nullptr;
+
+    /// Vulkan pipeline cache
+    VkPipelineCache vk_pipeline_cache = VK_NULL_HANDLE;
+
+    /// Cache file
+    string path;
+
+    /// Bytes loaded from the file
+    size_t loaded_size = 0;
+};
+
+} // namespace lava
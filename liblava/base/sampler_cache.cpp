@@ -0,0 +1,151 @@
+/**
+ * @file         liblava/base/sampler_cache.cpp
+ * @brief        Shared samplers of a device
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/base/device.hpp>
+#include <liblava/base/sampler_cache.hpp>
+
+namespace lava {
+
+/// Hashed part of sampler create info (flags up to the end, no padding)
+constexpr size_t const sampler_info_offset = offsetof(VkSamplerCreateInfo, flags);
+
+/// Size of hashed part
+constexpr size_t const sampler_info_size = sizeof(VkSamplerCreateInfo) - sampler_info_offset;
+
+//-----------------------------------------------------------------------------
+ui64 hash_sampler_info(VkSamplerCreateInfo const& info) {
+    auto const data = (ui8 const*) &info + sampler_info_offset;
+
+    // FNV-1a
+    ui64 result = 14695981039346656037ull;
+    for (auto i = 0u; i < sampler_info_size; ++i) {
+        result ^= data[i];
+        result *= 1099511628211ull;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+bool equal_sampler_info(VkSamplerCreateInfo const& a, VkSamplerCreateInfo const& b) {
+    return memcmp((ui8 const*) &a + sampler_info_offset,
+                  (ui8 const*) &b + sampler_info_offset, sampler_info_size)
+           == 0;
+}
+
+//-----------------------------------------------------------------------------
+void sampler_cache::create(device* d) {
+    vk_device = d;
+}
+
+//-----------------------------------------------------------------------------
+void sampler_cache::destroy() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (!entries.empty())
+        log()->warn("sampler cache - destroy {} samplers in use", entries.size());
+
+    for (auto& [sampler, entry] : entries)
+        vk_device->vkDestroySampler(sampler);
+
+    entries.clear();
+    hashes.clear();
+
+    vk_device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+VkSampler sampler_cache::acquire(VkSamplerCreateInfo const& info) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (!vk_device)
+        return VK_NULL_HANDLE;
+
+    auto const shared = info.pNext == nullptr;
+    auto const hash = hash_sampler_info(info);
+
+    if (shared) {
+        auto [begin, end] = hashes.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            auto& entry = entries.at(it->second);
+            if (entry.shared && equal_sampler_info(entry.info, info)) {
+                ++entry.references;
+                return it->second;
+            }
+        }
+    }
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    if (!vk_device->vkCreateSampler(&info, &sampler)) {
+        log()->error("sampler cache - create sampler ({} in cache)", entries.size());
+        return VK_NULL_HANDLE;
+    }
+
+    entry entry;
+    entry.info = info;
+    entry.info.pNext = nullptr;
+    entry.hash = hash;
+    entry.shared = shared;
+    entry.references = 1;
+
+    entries.emplace(sampler, entry);
+    if (shared)
+        hashes.emplace(hash, sampler);
+
+    return sampler;
+}
+
+//-----------------------------------------------------------------------------
+void sampler_cache::release(VkSampler sampler) {
+    if (sampler == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    auto it = entries.find(sampler);
+    if (it == entries.end()) {
+        log()->warn("sampler cache - release unknown sampler");
+        return;
+    }
+
+    auto& entry = it->second;
+    if (--entry.references > 0)
+        return;
+
+    if (entry.shared) {
+        auto [begin, end] = hashes.equal_range(entry.hash);
+        for (auto h = begin; h != end; ++h) {
+            if (h->second == sampler) {
+                hashes.erase(h);
+                break;
+            }
+        }
+    }
+
+    entries.erase(it);
+
+    vk_device->vkDestroySampler(sampler);
+}
+
+//-----------------------------------------------------------------------------
+size_t sampler_cache::get_count() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+size_t sampler_cache::get_reference_count() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    size_t result = 0;
+    for (auto const& [sampler, entry] : entries)
+        result += entry.references;
+
+    return result;
+}
+
+} // namespace lava
@@ -0,0 +1,119 @@
+/**
+ * @file         liblava/base/sampler_cache.hpp
+ * @brief        Shared samplers of a device
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/base/base.hpp>
+#include <mutex>
+#include <unordered_map>
+
+namespace lava {
+
+/// fwd
+struct device;
+
+/**
+ * @brief Hash a sampler create info (without pNext)
+ *
+ * @param info      Sampler create info
+ *
+ * @return ui64     Hash value
+ */
+ui64 hash_sampler_info(VkSamplerCreateInfo const& info);
+
+/**
+ * @brief Compare two sampler create infos (without pNext)
+ *
+ * @param a         First sampler create info
+ * @param b         Second sampler create info
+ *
+ * @return true     Sampler create infos are equal
+ * @return false    Sampler create infos are different
+ */
+bool equal_sampler_info(VkSamplerCreateInfo const& a, VkSamplerCreateInfo const& b);
+
+/**
+ * @brief Sampler cache
+ *
+ * Samplers with identical create info are shared and reference counted.
+ * Create infos with a pNext chain are not shared.
+ */
+struct sampler_cache : no_copy_no_move {
+    /**
+     * @brief Set up the sampler cache
+     *
+     * @param device    Vulkan device
+     */
+    void create(device* device);
+
+    /**
+     * @brief Destroy all samplers
+     */
+    void destroy();
+
+    /**
+     * @brief Acquire a sampler (increments the reference count)
+     *
+     * @param info          Sampler create info
+     *
+     * @return VkSampler    Sampler (VK_NULL_HANDLE: create failed)
+     */
+    VkSampler acquire(VkSamplerCreateInfo const& info);
+
+    /**
+     * @brief Release a sampler (destroyed with the last reference)
+     *
+     * @param sampler    Sampler to release
+     */
+    void release(VkSampler sampler);
+
+    /**
+     * @brief Get the number of samplers
+     *
+     * @return size_t    Number of samplers
+     */
+    size_t get_count() const;
+
+    /**
+     * @brief Get the number of references
+     *
+     * @return size_t    Sum of all reference counts
+     */
+    size_t get_reference_count() const;
+
+private:
+    /**
+     * @brief Sampler entry
+     */
+    struct entry {
+        /// Sampler create info
+        VkSamplerCreateInfo info = {};
+
+        /// Hash of create info
+        ui64 hash = 0;
+
+        /// Shared sampler
+        bool shared = true;
+
+        /// Reference count
+        ui32 references = 0;
+    };
+
+    /// Vulkan device
+    device* vk_device = nullptr;
+
+    /// Samplers by hash
+    std::unordered_multimap<ui64, VkSampler> hashes;
+
+    /// Entries by sampler
+    std::unordered_map<VkSampler, entry> entries;
+
+    /// Cache mutex
+    mutable std::mutex cache_mutex;
+};
+
+} // namespace lava
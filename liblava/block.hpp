@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <liblava/block/async_compute.hpp>
 #include <liblava/block/attachment.hpp>
 #include <liblava/block/block.hpp>
 #include <liblava/block/compute_pipeline.hpp>
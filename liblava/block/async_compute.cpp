@@ -0,0 +1,245 @@
+/**
+ * @file         liblava/block/async_compute.cpp
+ * @brief        Compute block on a dedicated compute queue
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/block/async_compute.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+bool async_compute::create(device_ptr d, index frame_count, queue::ref graphics_queue) {
+    device = d;
+
+    if (!device->timeline_semaphore_enabled()) {
+        log()->error("async compute - timeline semaphores not enabled");
+        return false;
+    }
+
+    compute_queue = {};
+
+    // compute only family first
+    for (auto& queue : device->get_compute_queues()) {
+        if (queue.family == graphics_queue.family)
+            continue;
+
+        if (!compute_queue.valid() || !(queue.flags & VK_QUEUE_GRAPHICS_BIT))
+            compute_queue = queue;
+    }
+
+    if (!compute_queue.valid()) {
+        for (auto& queue : device->get_compute_queues()) {
+            if (queue.vk_queue != graphics_queue.vk_queue) {
+                compute_queue = queue;
+                break;
+            }
+        }
+    }
+
+    if (!compute_queue.valid()) {
+        log()->error("async compute - no compute queue (see add_dedicated_queues)");
+        return false;
+    }
+
+    if (!cmd_block.create(device, frame_count, compute_queue.family))
+        return false;
+
+    VkSemaphoreTypeCreateInfoKHR const type_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo const create_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+    };
+
+    if (!device->vkCreateSemaphore(&create_info, &semaphore))
+        return false;
+
+    submitted_value = 0;
+    frame_values.assign(frame_count, 0);
+
+    log()->debug("async compute - compute queue family {} (graphics {})",
+                 compute_queue.family, graphics_queue.family);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void async_compute::destroy() {
+    if (!device)
+        return;
+
+    if (semaphore && submitted_value > 0) {
+        VkSemaphoreWaitInfoKHR const wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &submitted_value,
+        };
+
+        device->call().vkWaitSemaphoresKHR(device->get(), &wait_info, UINT64_MAX);
+    }
+
+    cmd_block.destroy();
+    dependencies.clear();
+
+    if (semaphore) {
+        device->vkDestroySemaphore(semaphore);
+        semaphore = VK_NULL_HANDLE;
+    }
+
+    frame_values.clear();
+
+    wait_semaphores.clear();
+    semaphore_stages.clear();
+    semaphore_values.clear();
+
+    wait_stages = 0;
+    wait_value = 0;
+
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void async_compute::remove_cmd(id::ref cmd) {
+    dependencies.erase(cmd);
+    cmd_block.remove_cmd(cmd);
+}
+
+//-----------------------------------------------------------------------------
+void async_compute::add_dependency(id::ref cmd, VkPipelineStageFlags stages) {
+    if (stages == 0) {
+        remove_dependency(cmd);
+        return;
+    }
+
+    dependencies[cmd] = stages;
+}
+
+//-----------------------------------------------------------------------------
+bool async_compute::add_wait_semaphore(VkSemaphore wait_semaphore, VkPipelineStageFlags stage, ui64 value) {
+    // timeline only, a binary wait needs its signal submitted first
+    if (!wait_semaphore || value == 0) {
+        log()->error("async compute - wait needs a timeline semaphore and value");
+        return false;
+    }
+
+    wait_semaphores.push_back(wait_semaphore);
+    semaphore_stages.push_back(stage);
+    semaphore_values.push_back(value);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool async_compute::process(index frame) {
+    wait_stages = 0;
+    wait_value = 0;
+
+    // command pool of frame is reset
+    if (frame_values.at(frame) > 0) {
+        VkSemaphoreWaitInfoKHR const wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &frame_values.at(frame),
+        };
+
+        if (failed(device->call().vkWaitSemaphoresKHR(device->get(), &wait_info, UINT64_MAX)))
+            return false;
+    }
+
+    if (!cmd_block.process(frame))
+        return false;
+
+    VkCommandBuffers cmd_buffers;
+    VkPipelineStageFlags dependent_stages = 0;
+    size_t dependent_count = 0;
+
+    for (auto const& cmd : cmd_block.get_cmd_order()) {
+        if (!cmd->active)
+            continue;
+
+        cmd_buffers.push_back(cmd->buffers.at(frame));
+
+        if (dependencies.count(cmd->get_id())) {
+            dependent_stages |= dependencies.at(cmd->get_id());
+            dependent_count = cmd_buffers.size();
+        }
+    }
+
+    if (cmd_buffers.empty())
+        return true;
+
+    // split after the last dependent command, the rest overlaps with graphics
+    if (dependent_count > 0) {
+        if (!submit(VkCommandBuffers(cmd_buffers.begin(), cmd_buffers.begin() + dependent_count), true))
+            return false;
+
+        wait_stages = dependent_stages;
+        wait_value = submitted_value;
+    }
+
+    if (dependent_count < cmd_buffers.size())
+        if (!submit(VkCommandBuffers(cmd_buffers.begin() + dependent_count, cmd_buffers.end()), dependent_count == 0))
+            return false;
+
+    frame_values.at(frame) = submitted_value;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool async_compute::submit(VkCommandBuffers const& cmd_buffers, bool wait) {
+    auto const value = submitted_value + 1;
+
+    VkSemaphores submit_wait_semaphores;
+    std::vector<VkPipelineStageFlags> submit_wait_stages;
+    std::vector<ui64> submit_wait_values;
+
+    if (wait) {
+        submit_wait_semaphores = std::move(wait_semaphores);
+        submit_wait_stages = std::move(semaphore_stages);
+        submit_wait_values = std::move(semaphore_values);
+
+        wait_semaphores.clear();
+        semaphore_stages.clear();
+        semaphore_values.clear();
+    }
+
+    VkTimelineSemaphoreSubmitInfoKHR const timeline_info{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+        .waitSemaphoreValueCount = to_ui32(submit_wait_values.size()),
+        .pWaitSemaphoreValues = submit_wait_values.data(),
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &value,
+    };
+
+    VkSubmitInfo const submit_info{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_info,
+        .waitSemaphoreCount = to_ui32(submit_wait_semaphores.size()),
+        .pWaitSemaphores = submit_wait_semaphores.data(),
+        .pWaitDstStageMask = submit_wait_stages.data(),
+        .commandBufferCount = to_ui32(cmd_buffers.size()),
+        .pCommandBuffers = cmd_buffers.data(),
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &semaphore,
+    };
+
+    if (!device->vkQueueSubmit(compute_queue.vk_queue, 1, &submit_info, VK_NULL_HANDLE)) {
+        log()->error("async compute - submit {} command buffers", cmd_buffers.size());
+        return false;
+    }
+
+    submitted_value = value;
+
+    return true;
+}
+
+} // namespace lava
@@ -0,0 +1,245 @@
+/**
+ * @file         liblava/block/async_compute.hpp
+ * @brief        Compute block on a dedicated compute queue
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/block/block.hpp>
+
+namespace lava {
+
+/**
+ * @brief Async compute lane
+ * 
+ * Commands are recorded in an own block and submitted on a compute queue
+ * that runs next to the graphics queue. Each submit signals a timeline semaphore.
+ * 
+ * Graphics work depends only on commands declared with add_dependency: the
+ * commands up to the last dependent one are submitted first, the graphics submit
+ * waits on their value at the declared stages (see renderer::add_wait_semaphore).
+ * Independent commands keep running in parallel to the graphics work.
+ * 
+ * Resources written on the compute queue of another family need a queue family
+ * ownership transfer before graphics use (see get_queue).
+ */
+struct async_compute : entity {
+    /// Shared pointer to async compute
+    using ptr = std::shared_ptr<async_compute>;
+
+    /**
+     * @brief Destroy the async compute
+     */
+    ~async_compute() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new async compute
+     * 
+     * Picks a compute queue of another family (compute only first) or another
+     * queue of the graphics family. Needs timeline semaphores.
+     * 
+     * @param device            Vulkan device
+     * @param frame_count       Number of frames
+     * @param graphics_queue    Graphics queue
+     * 
+     * @return true             Create was successful
+     * @return false            No compute queue or timeline semaphores
+     */
+    bool create(device_ptr device, index frame_count, queue::ref graphics_queue);
+
+    /**
+     * @brief Destroy the async compute (waits for pending submits)
+     */
+    void destroy();
+
+    /**
+     * @brief Add a command
+     * 
+     * @param func      Command function
+     * @param active    Active state
+     * 
+     * @return id       Command id
+     */
+    id add_cmd(command::process_func func, bool active = true) {
+        return cmd_block.add_cmd(func, active);
+    }
+
+    /**
+     * @brief Remove the command
+     * 
+     * @param cmd    Command id
+     */
+    void remove_cmd(id::ref cmd);
+
+    /**
+     * @brief Set the command active
+     * 
+     * @param cmd       Command id
+     * @param active    Active state
+     * 
+     * @return true     Set was successful
+     * @return false    Set failed
+     */
+    bool set_active(id::ref cmd, bool active = true) {
+        return cmd_block.set_active(cmd, active);
+    }
+
+    /**
+     * @brief Declare that graphics work depends on a command
+     * 
+     * @param cmd       Command id
+     * @param stages    Graphics pipeline stages that wait for the command
+     */
+    void add_dependency(id::ref cmd, VkPipelineStageFlags stages);
+
+    /**
+     * @brief Remove the dependency on a command
+     * 
+     * @param cmd    Command id
+     */
+    void remove_dependency(id::ref cmd) {
+        dependencies.erase(cmd);
+    }
+
+    /**
+     * @brief Wait for a timeline semaphore in the next submit
+     * 
+     * Binary semaphores are not supported, the compute submit may happen before
+     * their signal operation is submitted.
+     * 
+     * @param semaphore    Timeline semaphore
+     * @param stage        Pipeline stages that wait
+     * @param value        Timeline value (greater than 0)
+     * 
+     * @return true        Wait was added
+     * @return false       No semaphore or value
+     */
+    bool add_wait_semaphore(VkSemaphore semaphore, VkPipelineStageFlags stage, ui64 value);
+
+    /**
+     * @brief Record and submit the commands
+     * 
+     * @param frame     Frame index
+     * 
+     * @return true     Process was successful
+     * @return false    Process failed
+     */
+    bool process(index frame);
+
+    /**
+     * @brief Get the graphics stages that wait for the last process
+     * 
+     * @return VkPipelineStageFlags    Wait stages (0: no dependency)
+     */
+    VkPipelineStageFlags get_wait_stages() const {
+        return wait_stages;
+    }
+
+    /**
+     * @brief Get the semaphore value the graphics work waits on
+     * 
+     * @return ui64    Semaphore value of the dependent commands
+     */
+    ui64 get_wait_value() const {
+        return wait_value;
+    }
+
+    /**
+     * @brief Get the timeline semaphore
+     * 
+     * @return VkSemaphore    Timeline semaphore
+     */
+    VkSemaphore get_semaphore() const {
+        return semaphore;
+    }
+
+    /**
+     * @brief Get the value of the last submit
+     * 
+     * @return ui64    Semaphore value
+     */
+    ui64 get_submitted_value() const {
+        return submitted_value;
+    }
+
+    /**
+     * @brief Get the compute queue
+     * 
+     * @return queue::ref    Compute queue
+     */
+    queue::ref get_queue() const {
+        return compute_queue;
+    }
+
+    /**
+     * @brief Get the block of the commands
+     * 
+     * @return block&    Compute block
+     */
+    block& get_block() {
+        return cmd_block;
+    }
+
+private:
+    /**
+     * @brief Submit command buffers
+     * 
+     * @param cmd_buffers    List of command buffers
+     * @param wait           Wait for the additional semaphores
+     * 
+     * @return true          Submit was successful
+     * @return false         Submit failed
+     */
+    bool submit(VkCommandBuffers const& cmd_buffers, bool wait);
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Compute queue
+    queue compute_queue;
+
+    /// Compute block
+    block cmd_block;
+
+    /// Map of graphics wait stages by command id
+    std::map<id, VkPipelineStageFlags> dependencies;
+
+    /// Timeline semaphore
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+
+    /// Value of last submit
+    ui64 submitted_value = 0;
+
+    /// Last submitted value of each frame
+    std::vector<ui64> frame_values;
+
+    /// Graphics wait stages of last process
+    VkPipelineStageFlags wait_stages = 0;
+
+    /// Semaphore value of dependent commands
+    ui64 wait_value = 0;
+
+    /// Additional timeline semaphores of next submit
+    VkSemaphores wait_semaphores = {};
+
+    /// Wait stages of additional semaphores
+    std::vector<VkPipelineStageFlags> semaphore_stages = {};
+
+    /// Timeline values of additional semaphores
+    std::vector<ui64> semaphore_values = {};
+};
+
+/**
+ * @brief Make a new async compute
+ * 
+ * @return async_compute::ptr    Shared pointer to async compute
+ */
+inline async_compute::ptr make_async_compute() {
+    return std::make_shared<async_compute>();
+}
+
+} // namespace lava
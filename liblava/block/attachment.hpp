@@ -153,6 +153,21 @@ struct attachment {
         description.finalLayout = layout;
     }
 
+    /**
+     * @brief Check if the contents stay inside the render pass
+     * 
+     * Neither loaded nor stored, the image can be a transient attachment.
+     * 
+     * @return true     Transient attachment
+     * @return false    Contents are loaded or stored
+     */
+    bool transient() const {
+        return description.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD
+               && description.storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE
+               && description.stencilLoadOp != VK_ATTACHMENT_LOAD_OP_LOAD
+               && description.stencilStoreOp == VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    }
+
 private:
     /// Attachment description
     VkAttachmentDescription description;
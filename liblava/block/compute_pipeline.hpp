@@ -101,7 +101,7 @@ private:
  * @brief Make a new compute pipeline
  * 
  * @param device                    Vulkan device
- * @param pipeline_cache            Pipeline cache
+ * @param pipeline_cache            Pipeline cache (0: device pipeline cache)
  * 
  * @return compute_pipeline::ptr    Shared pointer to compute pipeline
  */
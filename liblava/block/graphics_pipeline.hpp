@@ -60,7 +60,7 @@ struct graphics_pipeline : pipeline {
      * @brief Construct a new graphics pipeline
      * 
      * @param device            Vulkan device
-     * @param pipeline_cache    Pipeline cache
+     * @param pipeline_cache    Pipeline cache (0: device pipeline cache)
      */
     explicit graphics_pipeline(device_ptr device, VkPipelineCache pipeline_cache);
 
@@ -510,7 +510,7 @@ private:
  * @brief Make a new graphics pipeline
  * 
  * @param device                     Vulkan device
- * @param pipeline_cache             Pipeline cache
+ * @param pipeline_cache             Pipeline cache (0: device pipeline cache)
  * 
  * @return graphics_pipeline::ptr    Shared pointer to graphics pipeline
  */
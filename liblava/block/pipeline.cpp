@@ -11,7 +11,7 @@ namespace lava {
 
 //-----------------------------------------------------------------------------
 pipeline::pipeline(device_ptr device_, VkPipelineCache pipeline_cache)
-: device(device_), pipeline_cache(pipeline_cache) {}
+: device(device_), pipeline_cache(pipeline_cache ? pipeline_cache : device_->get_pipeline_cache().get()) {}
 
 //-----------------------------------------------------------------------------
 pipeline::~pipeline() {
@@ -34,7 +34,7 @@ struct pipeline : entity {
      * @brief Construct a new pipeline
      * 
      * @param device            Vulkan device
-     * @param pipeline_cache    Pipeline cache
+     * @param pipeline_cache    Pipeline cache (0: device pipeline cache)
      */
     explicit pipeline(device_ptr device, VkPipelineCache pipeline_cache = 0);
 
@@ -447,7 +447,7 @@ struct id_registry {
      * @return ptr      Shared pointer to object
      */
     ptr get(id::ref object) const {
-        return objects.at(object).get();
+        return objects.at(object);
     }
 
     /**
@@ -455,10 +455,10 @@ struct id_registry {
      * 
      * @param object    Object id
      * 
-     * @return Meta     Copy of meta
+     * @return Meta const&    Meta of object
      */
     Meta const& get_meta(id::ref object) const {
-        return meta.at(object).get();
+        return meta.at(object);
     }
 
     /**
@@ -483,16 +483,16 @@ struct id_registry {
      * @brief Update meta of object
      * 
      * @param object    Object id
-     * @param meta      Meta to update
+     * @param info      Meta to update
      * 
      * @return true     Meta updated
      * @return false    Meta not updated
      */
-    bool update(id::ref object, Meta const& meta) {
+    bool update(id::ref object, Meta const& info) {
         if (!has(object))
             return false;
 
-        meta.at(object) = meta;
+        meta.at(object) = info;
         return true;
     }
 
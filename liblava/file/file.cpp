@@ -118,6 +118,27 @@ i64 file::read(data_ptr data, ui64 size) {
     return file_error_result;
 }
 
+//-----------------------------------------------------------------------------
+i64 file::read_next(data_ptr data, ui64 size) {
+    if (write_mode)
+        return file_error_result;
+
+    if (type == file_type::fs) {
+        return PHYSFS_readBytes(fs_file, data, size);
+    } else if (type == file_type::f_stream) {
+        i_stream.read(data, size);
+        auto const result = to_i64(i_stream.gcount());
+
+        // keep the position valid at end of file
+        if (i_stream.eof())
+            i_stream.clear();
+
+        return result;
+    }
+
+    return file_error_result;
+}
+
 //-----------------------------------------------------------------------------
 i64 file::write(data_cptr data, ui64 size) {
     if (!write_mode)
@@ -139,9 +160,9 @@ i64 file::seek(ui64 position) {
         return PHYSFS_seek(fs_file, position);
     } else if (type == file_type::f_stream) {
         if (write_mode)
-            o_stream.seekp(position, std::ostream::cur);
+            o_stream.seekp(position, std::ostream::beg);
         else
-            i_stream.seekg(position, std::ostream::cur);
+            i_stream.seekg(position, std::ostream::beg);
 
         return tell();
     }
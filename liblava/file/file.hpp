@@ -111,6 +111,16 @@ struct file : no_copy_no_move {
      */
     i64 read(data_ptr data, ui64 size);
 
+    /**
+     * @brief Read data from the current position in the file
+     * 
+     * @param data    Data to read
+     * @param size    Max size to read
+     * 
+     * @return i64    Read size
+     */
+    i64 read_next(data_ptr data, ui64 size);
+
     /**
      * @brief Write data to file
      * 
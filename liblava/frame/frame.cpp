@@ -192,6 +192,18 @@ bool frame::setup(frame_config c) {
     for (auto i = 0u; i < glfw_extensions_count; ++i)
         config.param.extensions.push_back(glfw_extensions[i]);
 
+    // memory budget queries (VK_EXT_memory_budget)
+    name const properties2 = VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME;
+    auto& extensions = config.param.extensions;
+    if (std::none_of(extensions.begin(), extensions.end(), [&](name ext) { return strcmp(ext, properties2) == 0; })) {
+        for (auto const& extension : instance::enumerate_extension_properties()) {
+            if (strcmp(extension.extensionName, properties2) == 0) {
+                extensions.push_back(properties2);
+                break;
+            }
+        }
+    }
+
     if (!instance::singleton().create(config.param, config.debug, config.info)) {
         log()->error("create instance");
         return false;
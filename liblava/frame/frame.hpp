@@ -10,6 +10,7 @@
 #include <argh.h>
 #include <liblava/base/device.hpp>
 #include <liblava/base/instance.hpp>
+#include <liblava/resource/upload_ring.hpp>
 
 namespace lava {
 
@@ -249,7 +250,7 @@ struct frame : interface, no_copy_no_move {
     }
 
     /**
-     * @brief Create a new device
+     * @brief Create a new device (with upload ring)
      * 
      * @param physical_device    Physical device
      * 
@@ -261,6 +262,10 @@ struct frame : interface, no_copy_no_move {
             return nullptr;
 
         auto ptr = device.get();
+
+        // without upload ring, uploads use dedicated buffers
+        ptr->set_upload_ring(create_upload_ring(ptr));
+
         return ptr;
     }
 
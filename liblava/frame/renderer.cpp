@@ -75,6 +75,13 @@ void renderer::destroy() {
     image_acquired_semaphores.clear();
     render_complete_semaphores.clear();
 
+    wait_semaphores.clear();
+    wait_stages.clear();
+    wait_values.clear();
+
+    signal_semaphores.clear();
+    signal_values.clear();
+
     queued_frames = 0;
 }
 
@@ -134,24 +141,65 @@ optional_index renderer::begin_frame() {
     return get_frame();
 }
 
+//-----------------------------------------------------------------------------
+void renderer::add_wait_semaphore(VkSemaphore semaphore, VkPipelineStageFlags stage, ui64 value) {
+    wait_semaphores.push_back(semaphore);
+    wait_stages.push_back(stage);
+    wait_values.push_back(value);
+}
+
+//-----------------------------------------------------------------------------
+void renderer::add_signal_semaphore(VkSemaphore semaphore, ui64 value) {
+    signal_semaphores.push_back(semaphore);
+    signal_values.push_back(value);
+}
+
 //-----------------------------------------------------------------------------
 bool renderer::end_frame(VkCommandBuffers const& cmd_buffers) {
     assert(!cmd_buffers.empty());
 
-    std::array<VkSemaphore, 1> const wait_semaphores = { image_acquired_semaphores[current_sync] };
+    VkSemaphores submit_wait_semaphores = { image_acquired_semaphores[current_sync] };
+    std::vector<VkPipelineStageFlags> submit_wait_stages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    std::vector<ui64> submit_wait_values = { 0 };
+
+    submit_wait_semaphores.insert(submit_wait_semaphores.end(), wait_semaphores.begin(), wait_semaphores.end());
+    submit_wait_stages.insert(submit_wait_stages.end(), wait_stages.begin(), wait_stages.end());
+    submit_wait_values.insert(submit_wait_values.end(), wait_values.begin(), wait_values.end());
+
+    wait_semaphores.clear();
+    wait_stages.clear();
+    wait_values.clear();
+
     std::array<VkSemaphore, 1> const sync_present_semaphores = { render_complete_semaphores[current_sync] };
 
-    VkPipelineStageFlags const wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSemaphores submit_signal_semaphores = { render_complete_semaphores[current_sync] };
+    std::vector<ui64> submit_signal_values = { 0 };
+
+    submit_signal_semaphores.insert(submit_signal_semaphores.end(), signal_semaphores.begin(), signal_semaphores.end());
+    submit_signal_values.insert(submit_signal_values.end(), signal_values.begin(), signal_values.end());
+
+    signal_semaphores.clear();
+    signal_values.clear();
+
+    // values of binary semaphores are ignored
+    VkTimelineSemaphoreSubmitInfoKHR const timeline_info{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+        .waitSemaphoreValueCount = to_ui32(submit_wait_values.size()),
+        .pWaitSemaphoreValues = submit_wait_values.data(),
+        .signalSemaphoreValueCount = to_ui32(submit_signal_values.size()),
+        .pSignalSemaphoreValues = submit_signal_values.data(),
+    };
 
     VkSubmitInfo const submit_info{
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .waitSemaphoreCount = to_ui32(wait_semaphores.size()),
-        .pWaitSemaphores = wait_semaphores.data(),
-        .pWaitDstStageMask = &wait_stage,
+        .pNext = device->timeline_semaphore_enabled() ? &timeline_info : nullptr,
+        .waitSemaphoreCount = to_ui32(submit_wait_semaphores.size()),
+        .pWaitSemaphores = submit_wait_semaphores.data(),
+        .pWaitDstStageMask = submit_wait_stages.data(),
         .commandBufferCount = to_ui32(cmd_buffers.size()),
         .pCommandBuffers = cmd_buffers.data(),
-        .signalSemaphoreCount = to_ui32(sync_present_semaphores.size()),
-        .pSignalSemaphores = sync_present_semaphores.data(),
+        .signalSemaphoreCount = to_ui32(submit_signal_semaphores.size()),
+        .pSignalSemaphores = submit_signal_semaphores.data(),
     };
 
     std::array<VkSubmitInfo, 1> const submit_infos = { submit_info };
@@ -51,6 +51,23 @@ struct renderer : entity {
      */
     bool end_frame(VkCommandBuffers const& cmd_buffers);
 
+    /**
+     * @brief Wait for a semaphore in the next frame submit
+     * 
+     * @param semaphore    Binary or timeline semaphore
+     * @param stage        Pipeline stages that wait
+     * @param value        Timeline value (ignored for binary semaphores)
+     */
+    void add_wait_semaphore(VkSemaphore semaphore, VkPipelineStageFlags stage, ui64 value = 0);
+
+    /**
+     * @brief Signal a semaphore in the next frame submit
+     * 
+     * @param semaphore    Binary or timeline semaphore
+     * @param value        Timeline value (ignored for binary semaphores)
+     */
+    void add_signal_semaphore(VkSemaphore semaphore, ui64 value = 0);
+
     /**
      * @brief Render a frame
      * 
@@ -123,6 +140,21 @@ private:
 
     /// List of render complete semaphores
     VkSemaphores render_complete_semaphores = {};
+
+    /// Additional wait semaphores of next submit
+    VkSemaphores wait_semaphores = {};
+
+    /// Wait stages of additional semaphores
+    std::vector<VkPipelineStageFlags> wait_stages = {};
+
+    /// Timeline values of additional semaphores
+    std::vector<ui64> wait_values = {};
+
+    /// Additional signal semaphores of next submit
+    VkSemaphores signal_semaphores = {};
+
+    /// Timeline values of additional signal semaphores
+    std::vector<ui64> signal_values = {};
 };
 
 } // namespace lava
@@ -7,8 +7,19 @@
 
 #pragma once
 
+#include <liblava/resource/aliasing_allocator.hpp>
 #include <liblava/resource/buffer.hpp>
+#include <liblava/resource/defragmenter.hpp>
 #include <liblava/resource/format.hpp>
+#include <liblava/resource/frame_allocator.hpp>
 #include <liblava/resource/image.hpp>
+#include <liblava/resource/instance_buffer.hpp>
 #include <liblava/resource/mesh.hpp>
+#include <liblava/resource/mesh_lod.hpp>
+#include <liblava/resource/mesh_pool.hpp>
+#include <liblava/resource/meshlet.hpp>
+#include <liblava/resource/packed_vertex.hpp>
 #include <liblava/resource/texture.hpp>
+#include <liblava/resource/texture_atlas.hpp>
+#include <liblava/resource/upload_context.hpp>
+#include <liblava/resource/upload_ring.hpp>
@@ -0,0 +1,189 @@
+/**
+ * @file         liblava/resource/aliasing_allocator.cpp
+ * @brief        Render pass attachments sharing one allocation
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/aliasing_allocator.hpp>
+#include <numeric>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+VkDeviceSize place_alias_ranges(alias_range_list const& ranges, std::vector<VkDeviceSize>& offsets) {
+    offsets.assign(ranges.size(), 0);
+
+    std::vector<index> order(ranges.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](index a, index b) {
+        return ranges[a].size > ranges[b].size;
+    });
+
+    auto const align = [](VkDeviceSize value, VkDeviceSize alignment) {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    };
+
+    // occupied memory [begin, end)
+    using interval = std::pair<VkDeviceSize, VkDeviceSize>;
+
+    VkDeviceSize result = 0;
+    std::vector<index> placed;
+
+    for (auto const current : order) {
+        auto const& range = ranges[current];
+
+        std::vector<interval> occupied;
+        for (auto const other : placed)
+            if (range.overlaps(ranges[other]))
+                occupied.emplace_back(offsets[other], offsets[other] + ranges[other].size);
+
+        std::sort(occupied.begin(), occupied.end());
+
+        // first gap that fits
+        VkDeviceSize offset = 0;
+        for (auto const& [begin, end] : occupied) {
+            if (align(offset, range.alignment) + range.size <= begin)
+                break;
+
+            offset = std::max(offset, end);
+        }
+
+        offset = align(offset, range.alignment);
+
+        offsets[current] = offset;
+        placed.push_back(current);
+
+        result = std::max(result, offset + range.size);
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+void aliasing_allocator::add(image::ptr image, ui32 first_pass, ui32 last_pass) {
+    entry entry;
+    entry.image = image;
+    entry.first_pass = std::min(first_pass, last_pass);
+    entry.last_pass = std::max(first_pass, last_pass);
+
+    entries.push_back(entry);
+}
+
+//-----------------------------------------------------------------------------
+void aliasing_allocator::clear() {
+    destroy();
+    entries.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool aliasing_allocator::create(device_ptr d, uv2 image_size) {
+    destroy();
+
+    if (entries.empty())
+        return false;
+
+    device = d;
+
+    alias_range_list ranges;
+    ranges.reserve(entries.size());
+
+    VkMemoryRequirements requirements{
+        .size = 0,
+        .alignment = 1,
+        .memoryTypeBits = ~0u,
+    };
+
+    auto transient = true;
+
+    // query requirements with temporary images
+    for (auto const& entry : entries) {
+        auto info = entry.image->get_info();
+        info.extent = { image_size.x, image_size.y, 1 };
+
+        VkImage vk_image = VK_NULL_HANDLE;
+        if (failed(device->call().vkCreateImage(device->get(), &info, memory::alloc(), &vk_image))) {
+            log()->error("aliasing allocator - create image");
+            return false;
+        }
+
+        VkMemoryRequirements image_requirements{};
+        device->call().vkGetImageMemoryRequirements(device->get(), vk_image, &image_requirements);
+        device->call().vkDestroyImage(device->get(), vk_image, memory::alloc());
+
+        ranges.push_back({
+            .size = image_requirements.size,
+            .alignment = image_requirements.alignment,
+            .first_pass = entry.first_pass,
+            .last_pass = entry.last_pass,
+        });
+
+        requirements.alignment = std::max(requirements.alignment, image_requirements.alignment);
+        requirements.memoryTypeBits &= image_requirements.memoryTypeBits;
+
+        unaliased_size += image_requirements.size;
+        transient &= entry.image->transient();
+    }
+
+    if (requirements.memoryTypeBits == 0) {
+        log()->error("aliasing allocator - no common memory type");
+        return false;
+    }
+
+    std::vector<VkDeviceSize> offsets;
+    requirements.size = place_alias_ranges(ranges, offsets);
+
+    VmaAllocationCreateInfo create_info{
+        .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+    };
+
+    if (transient) {
+        create_info.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+
+        lazy = vmaAllocateMemory(device->alloc(), &requirements, &create_info, &allocation, nullptr) == VK_SUCCESS;
+        if (!lazy)
+            create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    }
+
+    if (!allocation && failed(vmaAllocateMemory(device->alloc(), &requirements, &create_info, &allocation, nullptr))) {
+        log()->error("aliasing allocator - allocate {} KB", requirements.size >> 10);
+        allocation = nullptr;
+        return false;
+    }
+
+    size = requirements.size;
+
+    for (auto i = 0u; i < entries.size(); ++i) {
+        if (!entries[i].image->create(device, image_size, allocation, offsets[i])) {
+            destroy();
+            return false;
+        }
+    }
+
+    log()->debug("aliasing allocator - {} images in {} KB (unaliased {} KB)",
+                 entries.size(), size >> 10, unaliased_size >> 10);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void aliasing_allocator::destroy() {
+    if (!device)
+        return;
+
+    for (auto& entry : entries)
+        entry.image->destroy();
+
+    if (allocation) {
+        vmaFreeMemory(device->alloc(), allocation);
+        allocation = nullptr;
+    }
+
+    size = 0;
+    unaliased_size = 0;
+    lazy = false;
+
+    device = nullptr;
+}
+
+} // namespace lava
@@ -0,0 +1,181 @@
+/**
+ * @file         liblava/resource/aliasing_allocator.hpp
+ * @brief        Render pass attachments sharing one allocation
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/image.hpp>
+
+namespace lava {
+
+/**
+ * @brief Memory range of an aliased resource
+ */
+struct alias_range {
+    /// Size in bytes
+    VkDeviceSize size = 0;
+
+    /// Alignment in bytes
+    VkDeviceSize alignment = 1;
+
+    /// First pass using the resource
+    ui32 first_pass = 0;
+
+    /// Last pass using the resource
+    ui32 last_pass = 0;
+
+    /**
+     * @brief Check if the lifetimes of two ranges overlap
+     *
+     * @param other     Other range
+     *
+     * @return true     Ranges are used in a common pass
+     * @return false    Ranges can share memory
+     */
+    bool overlaps(alias_range const& other) const {
+        return first_pass <= other.last_pass && other.first_pass <= last_pass;
+    }
+};
+
+/// List of alias ranges
+using alias_range_list = std::vector<alias_range>;
+
+/**
+ * @brief Place ranges in one memory block
+ *
+ * Largest ranges first, each at the lowest offset that does not intersect
+ * a placed range with an overlapping lifetime.
+ *
+ * @param ranges           List of ranges
+ * @param offsets          Resulting offsets (same order as ranges)
+ *
+ * @return VkDeviceSize    Size of memory block
+ */
+VkDeviceSize place_alias_ranges(alias_range_list const& ranges, std::vector<VkDeviceSize>& offsets);
+
+/**
+ * @brief Aliasing allocator
+ *
+ * Registered images (attachments with optimal tiling) are created in one allocation.
+ * Images used in different passes share memory, the first pass using an aliased image
+ * must not load its contents (initial layout undefined). If all images are transient
+ * the allocation is lazily allocated where supported.
+ */
+struct aliasing_allocator : entity {
+    /// Shared pointer to aliasing allocator
+    using ptr = std::shared_ptr<aliasing_allocator>;
+
+    /**
+     * @brief Destroy the aliasing allocator
+     */
+    ~aliasing_allocator() {
+        destroy();
+    }
+
+    /**
+     * @brief Register an image
+     *
+     * @param image         Image to create (format and usage set)
+     * @param first_pass    First pass using the image
+     * @param last_pass     Last pass using the image
+     */
+    void add(image::ptr image, ui32 first_pass, ui32 last_pass);
+
+    /**
+     * @brief Unregister all images
+     */
+    void clear();
+
+    /**
+     * @brief Create all registered images
+     *
+     * Previously created images are destroyed (resize).
+     *
+     * @param device    Vulkan device
+     * @param size      Size of images
+     *
+     * @return true     Create was successful
+     * @return false    Create failed
+     */
+    bool create(device_ptr device, uv2 size);
+
+    /**
+     * @brief Destroy the images and the allocation
+     */
+    void destroy();
+
+    /**
+     * @brief Get the size of the allocation
+     *
+     * @return VkDeviceSize    Allocated bytes
+     */
+    VkDeviceSize get_size() const {
+        return size;
+    }
+
+    /**
+     * @brief Get the size without aliasing
+     *
+     * @return VkDeviceSize    Sum of image sizes
+     */
+    VkDeviceSize get_unaliased_size() const {
+        return unaliased_size;
+    }
+
+    /**
+     * @brief Check if the allocation is lazily allocated
+     *
+     * @return true     Tile memory
+     * @return false    Regular device memory
+     */
+    bool lazily_allocated() const {
+        return lazy;
+    }
+
+private:
+    /**
+     * @brief Registered image
+     */
+    struct entry {
+        /// Image
+        lava::image::ptr image;
+
+        /// First pass using the image
+        ui32 first_pass = 0;
+
+        /// Last pass using the image
+        ui32 last_pass = 0;
+    };
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Registered images
+    std::vector<entry> entries;
+
+    /// Shared allocation
+    VmaAllocation allocation = nullptr;
+
+    /// Allocated bytes
+    VkDeviceSize size = 0;
+
+    /// Sum of image sizes
+    VkDeviceSize unaliased_size = 0;
+
+    /// Lazily allocated
+    bool lazy = false;
+};
+
+/**
+ * @brief Make a new aliasing allocator
+ *
+ * @return aliasing_allocator::ptr    Shared pointer to aliasing allocator
+ */
+inline aliasing_allocator::ptr make_aliasing_allocator() {
+    return std::make_shared<aliasing_allocator>();
+}
+
+} // namespace lava
@@ -48,8 +48,9 @@ VkAccessFlags buffer::usage_to_possible_access(VkBufferUsageFlags usage) {
 }
 
 //-----------------------------------------------------------------------------
-bool buffer::create(device_ptr d, void const* data, size_t size, VkBufferUsageFlags usage, bool mapped, VmaMemoryUsage memory_usage) {
+bool buffer::create(device_ptr d, void const* data, size_t size, VkBufferUsageFlags u, bool mapped, VmaMemoryUsage memory_usage) {
     device = d;
+    usage = u;
 
     VkBufferCreateInfo buffer_info{
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -126,9 +127,66 @@ VkDeviceAddress buffer::get_address() const {
     }
 }
 
+//-----------------------------------------------------------------------------
+void buffer::rebind(VkBuffer value) {
+    device->call().vkDestroyBuffer(device->get(), vk_buffer, memory::alloc());
+    vk_buffer = value;
+
+    vmaGetAllocationInfo(device->alloc(), allocation, &allocation_info);
+
+    descriptor.buffer = vk_buffer;
+}
+
 //-----------------------------------------------------------------------------
 void buffer::flush(VkDeviceSize offset, VkDeviceSize size) {
     vmaFlushAllocation(device->alloc(), allocation, offset, size);
 }
 
+//-----------------------------------------------------------------------------
+bool copy_buffers(device_ptr device, buffer_copy::list const& copies) {
+    auto const& queue = device->get_graphics_queue();
+
+    VkCommandPool pool = VK_NULL_HANDLE;
+    if (!device->vkCreateCommandPool(queue.family, &pool))
+        return false;
+
+    auto const result = one_time_command_buffer(device, pool, queue, [&](VkCommandBuffer cmd_buf) {
+        std::vector<VkBufferMemoryBarrier> barriers;
+        VkPipelineStageFlags dst_stages = 0;
+
+        for (auto& copy : copies) {
+            if (copy.regions.empty())
+                continue;
+
+            device->call().vkCmdCopyBuffer(cmd_buf, copy.source->get(), copy.target->get(),
+                                           to_ui32(copy.regions.size()), copy.regions.data());
+
+            barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = buffer::usage_to_possible_access(copy.usage),
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = copy.target->get(),
+                .offset = 0,
+                .size = VK_WHOLE_SIZE,
+            });
+
+            dst_stages |= buffer::usage_to_possible_stages(copy.usage);
+        }
+
+        if (!barriers.empty())
+            device->call().vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                dst_stages ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                                0, 0, nullptr, to_ui32(barriers.size()), barriers.data(), 0, nullptr);
+    });
+
+    device->vkDestroyCommandPool(pool);
+
+    if (!result)
+        log()->error("copy buffers");
+
+    return result;
+}
+
 } // namespace lava
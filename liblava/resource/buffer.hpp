@@ -170,6 +170,24 @@ struct buffer : entity {
         return allocation;
     }
 
+    /**
+     * @brief Get the usage of the buffer
+     * 
+     * @return VkBufferUsageFlags    Buffer usage flags
+     */
+    VkBufferUsageFlags get_usage() const {
+        return usage;
+    }
+
+    /**
+     * @brief Replace the buffer handle after its allocation was moved (see defragmenter)
+     * 
+     * The previous handle is destroyed, descriptor sets using the buffer need to be updated.
+     * 
+     * @param value    Buffer bound to the moved allocation
+     */
+    void rebind(VkBuffer value);
+
     /**
      * @brief Get the allocation information
      * 
@@ -192,6 +210,9 @@ private:
     /// Allocation information
     VmaAllocationInfo allocation_info = {};
 
+    /// Buffer usage flags
+    VkBufferUsageFlags usage = 0;
+
     /// Descriptor buffer information
     VkDescriptorBufferInfo descriptor = {};
 };
@@ -205,4 +226,37 @@ inline buffer::ptr make_buffer() {
     return std::make_shared<buffer>();
 }
 
+/**
+ * @brief Copy regions between buffers
+ */
+struct buffer_copy {
+    /// List of buffer copies
+    using list = std::vector<buffer_copy>;
+
+    /// Source buffer
+    buffer::ptr source;
+
+    /// Target buffer
+    buffer::ptr target;
+
+    /// Copy regions
+    std::vector<VkBufferCopy> regions;
+
+    /// Usage of target buffer (barrier after the copy)
+    VkBufferUsageFlags usage = 0;
+};
+
+/**
+ * @brief Copy regions between buffers
+ * 
+ * Copies in one submit on the graphics queue and waits for completion.
+ * 
+ * @param device    Vulkan device
+ * @param copies    List of buffer copies
+ * 
+ * @return true     Copy was successful
+ * @return false    Copy failed
+ */
+bool copy_buffers(device_ptr device, buffer_copy::list const& copies);
+
 } // namespace lava
@@ -0,0 +1,307 @@
+/**
+ * @file         liblava/resource/defragmenter.cpp
+ * @brief        Incremental defragmentation of device memory
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/defragmenter.hpp>
+#include <liblava/resource/format.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+bool defragmenter::create(device_ptr d, VkDeviceSize max_bytes, ui32 max_moves) {
+    device = d;
+    max_bytes_per_pass = max_bytes;
+    max_moves_per_pass = max_moves;
+
+    return device->vkCreateCommandPool(device->get_graphics_queue().family, &pool);
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::destroy() {
+    if (!device)
+        return;
+
+    end();
+
+    resources.clear();
+
+    if (pool) {
+        device->vkDestroyCommandPool(pool);
+        pool = VK_NULL_HANDLE;
+    }
+
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::add(buffer::ptr buffer, moved_func on_moved) {
+    auto const required = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if ((buffer->get_usage() & required) != required) {
+        log()->warn("defragmenter - buffer without transfer usage is not moved");
+        return;
+    }
+
+    entry entry;
+    entry.buffer = buffer;
+    entry.on_moved = on_moved;
+
+    resources[buffer->get_allocation()] = entry;
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::add(texture::ptr texture, moved_func on_moved, VkImageLayout layout) {
+    entry entry;
+    entry.texture = texture;
+    entry.layout = layout;
+    entry.on_moved = on_moved;
+
+    resources[texture->get_image()->get_allocation()] = entry;
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::remove(buffer::ptr buffer) {
+    resources.erase(buffer->get_allocation());
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::remove(texture::ptr texture) {
+    if (auto image = texture->get_image())
+        resources.erase(image->get_allocation());
+}
+
+//-----------------------------------------------------------------------------
+bool defragmenter::begin() {
+    if (!device || context)
+        return false;
+
+    // drop destroyed resources
+    std::erase_if(resources, [](auto const& item) {
+        auto const& [allocation, entry] = item;
+        if (entry.buffer)
+            return entry.buffer->get_allocation() != allocation;
+
+        auto const image = entry.texture->get_image();
+        return !image || image->get_allocation() != allocation;
+    });
+
+    VmaDefragmentationInfo const info{
+        .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+        .maxBytesPerPass = max_bytes_per_pass,
+        .maxAllocationsPerPass = max_moves_per_pass,
+    };
+
+    if (failed(vmaBeginDefragmentation(device->alloc(), &info, &context))) {
+        log()->error("begin defragmentation");
+        context = nullptr;
+        return false;
+    }
+
+    moved_bytes = 0;
+    freed_bytes = 0;
+    move_count = 0;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<defragmenter::move> defragmenter::prepare_moves(VmaDefragmentationPassMoveInfo& pass_info) {
+    std::vector<move> result(pass_info.moveCount);
+
+    for (auto i = 0u; i < pass_info.moveCount; ++i) {
+        auto& vma_move = pass_info.pMoves[i];
+
+        auto it = resources.find(vma_move.srcAllocation);
+        if (it == resources.end()) {
+            vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            continue;
+        }
+
+        auto const& resource = it->second;
+
+        if (resource.buffer) {
+            VkBufferCreateInfo const buffer_info{
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .size = resource.buffer->get_size(),
+                .usage = resource.buffer->get_usage(),
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            };
+
+            VkBuffer buffer = VK_NULL_HANDLE;
+            if (failed(device->call().vkCreateBuffer(device->get(), &buffer_info, memory::alloc(), &buffer))
+                || failed(vmaBindBufferMemory(device->alloc(), vma_move.dstTmpAllocation, buffer))) {
+                if (buffer)
+                    device->call().vkDestroyBuffer(device->get(), buffer, memory::alloc());
+
+                vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+
+            result[i] = { &resource, buffer, VK_NULL_HANDLE };
+        } else {
+            auto image_info = resource.texture->get_image()->get_info();
+            image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            VkImage image = VK_NULL_HANDLE;
+            if (failed(device->call().vkCreateImage(device->get(), &image_info, memory::alloc(), &image))
+                || failed(vmaBindImageMemory(device->alloc(), vma_move.dstTmpAllocation, image))) {
+                if (image)
+                    device->call().vkDestroyImage(device->get(), image, memory::alloc());
+
+                vma_move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+
+            result[i] = { &resource, VK_NULL_HANDLE, image };
+        }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::copy_moves(VkCommandBuffer cmd_buf, std::vector<move> const& moves) const {
+    for (auto const& move : moves) {
+        if (!move.resource)
+            continue;
+
+        if (move.buffer) {
+            auto const& buffer = move.resource->buffer;
+
+            VkBufferCopy const region{ .size = buffer->get_size() };
+            device->call().vkCmdCopyBuffer(cmd_buf, buffer->get(), move.buffer, 1, &region);
+            continue;
+        }
+
+        auto const image = move.resource->texture->get_image();
+        auto const& range = image->get_subresource_range();
+        auto const layout = move.resource->layout;
+
+        insert_image_memory_barrier(device, cmd_buf, image->get(),
+                                    VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                    layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, range);
+
+        insert_image_memory_barrier(device, cmd_buf, move.image,
+                                    0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, range);
+
+        std::vector<VkImageCopy> regions;
+        auto size = image->get_size();
+        auto depth = image->get_depth();
+        for (auto level = 0u; level < range.levelCount; ++level) {
+            VkImageSubresourceLayers const layers{
+                .aspectMask = range.aspectMask,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = range.layerCount,
+            };
+
+            regions.push_back({
+                .srcSubresource = layers,
+                .dstSubresource = layers,
+                .extent = { size.x, size.y, depth },
+            });
+
+            size = { std::max(size.x / 2, 1u), std::max(size.y / 2, 1u) };
+            depth = std::max(depth / 2, 1u);
+        }
+
+        device->call().vkCmdCopyImage(cmd_buf, image->get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                      move.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      to_ui32(regions.size()), regions.data());
+
+        insert_image_memory_barrier(device, cmd_buf, move.image,
+                                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, layout,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, range);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool defragmenter::step() {
+    if (!context)
+        return false;
+
+    VmaDefragmentationPassMoveInfo pass_info{};
+    auto result = vmaBeginDefragmentationPass(device->alloc(), context, &pass_info);
+    if (result == VK_SUCCESS) {
+        end();
+        return false;
+    }
+
+    if (result != VK_INCOMPLETE) {
+        log()->error("begin defragmentation pass");
+        end();
+        return false;
+    }
+
+    // resources of frames in flight are moved
+    device->wait_for_idle();
+
+    auto const moves = prepare_moves(pass_info);
+
+    auto const copied = one_time_command_buffer(device, pool, device->get_graphics_queue(), [&](VkCommandBuffer cmd_buf) {
+        copy_moves(cmd_buf, moves);
+    });
+
+    if (!copied) {
+        for (auto i = 0u; i < pass_info.moveCount; ++i) {
+            pass_info.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+
+            if (moves[i].buffer)
+                device->call().vkDestroyBuffer(device->get(), moves[i].buffer, memory::alloc());
+            if (moves[i].image)
+                device->call().vkDestroyImage(device->get(), moves[i].image, memory::alloc());
+        }
+    }
+
+    // allocations point to the new place after the pass
+    result = vmaEndDefragmentationPass(device->alloc(), context, &pass_info);
+
+    if (copied) {
+        for (auto const& move : moves) {
+            if (!move.resource)
+                continue;
+
+            if (move.buffer) {
+                move.resource->buffer->rebind(move.buffer);
+            } else {
+                move.resource->texture->get_image()->rebind(move.image);
+                move.resource->texture->update_descriptor();
+            }
+
+            if (move.resource->on_moved)
+                move.resource->on_moved();
+        }
+    }
+
+    if (result == VK_SUCCESS) {
+        end();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void defragmenter::end() {
+    if (!context)
+        return;
+
+    VmaDefragmentationStats stats{};
+    vmaEndDefragmentation(device->alloc(), context, &stats);
+    context = nullptr;
+
+    moved_bytes = stats.bytesMoved;
+    freed_bytes = stats.bytesFreed;
+    move_count = stats.allocationsMoved;
+
+    log()->info("defragmentation - moved {} allocations ({} KB), freed {} KB",
+                move_count, moved_bytes >> 10, freed_bytes >> 10);
+}
+
+} // namespace lava
@@ -0,0 +1,229 @@
+/**
+ * @file         liblava/resource/defragmenter.hpp
+ * @brief        Incremental defragmentation of device memory
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/texture.hpp>
+
+namespace lava {
+
+/**
+ * @brief Defragmenter
+ *
+ * Moves registered buffers and textures with Vma defragmentation, one pass per step.
+ * Allocations of resources that are not registered stay in place. After a resource
+ * was moved its handle (and image view) is replaced and its moved function is called
+ * to update descriptor sets.
+ */
+struct defragmenter : entity {
+    /// Shared pointer to defragmenter
+    using ptr = std::shared_ptr<defragmenter>;
+
+    /// Moved function
+    using moved_func = std::function<void()>;
+
+    /**
+     * @brief Destroy the defragmenter
+     */
+    ~defragmenter() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new defragmenter
+     *
+     * @param device                Vulkan device
+     * @param max_bytes_per_pass    Max bytes moved per step (0: no limit)
+     * @param max_moves_per_pass    Max allocations moved per step (0: no limit)
+     *
+     * @return true                 Create was successful
+     * @return false                Create failed
+     */
+    bool create(device_ptr device, VkDeviceSize max_bytes_per_pass = 64 << 20, ui32 max_moves_per_pass = 64);
+
+    /**
+     * @brief Destroy the defragmenter
+     */
+    void destroy();
+
+    /**
+     * @brief Register a buffer (needs transfer src and dst usage)
+     *
+     * @param buffer      Buffer to move
+     * @param on_moved    Called after the buffer was moved
+     */
+    void add(buffer::ptr buffer, moved_func on_moved = {});
+
+    /**
+     * @brief Register a texture
+     *
+     * @param texture     Texture to move
+     * @param on_moved    Called after the texture was moved
+     * @param layout      Layout of the texture image between frames
+     */
+    void add(texture::ptr texture, moved_func on_moved = {},
+             VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    /**
+     * @brief Unregister a buffer
+     *
+     * @param buffer    Buffer to remove
+     */
+    void remove(buffer::ptr buffer);
+
+    /**
+     * @brief Unregister a texture
+     *
+     * @param texture    Texture to remove
+     */
+    void remove(texture::ptr texture);
+
+    /**
+     * @brief Start a defragmentation
+     *
+     * @return true     Defragmentation was started
+     * @return false    Start failed
+     */
+    bool begin();
+
+    /**
+     * @brief Run one defragmentation pass (waits for device idle)
+     *
+     * @return true     Defragmentation is in progress
+     * @return false    Defragmentation is done (or failed)
+     */
+    bool step();
+
+    /**
+     * @brief End the defragmentation
+     */
+    void end();
+
+    /**
+     * @brief Check if a defragmentation is in progress
+     *
+     * @return true     Defragmentation is in progress
+     * @return false    No defragmentation
+     */
+    bool active() const {
+        return context != nullptr;
+    }
+
+    /**
+     * @brief Get the number of moved bytes of the last defragmentation
+     *
+     * @return VkDeviceSize    Moved bytes
+     */
+    VkDeviceSize get_moved_bytes() const {
+        return moved_bytes;
+    }
+
+    /**
+     * @brief Get the number of freed bytes of the last defragmentation
+     *
+     * @return VkDeviceSize    Freed bytes
+     */
+    VkDeviceSize get_freed_bytes() const {
+        return freed_bytes;
+    }
+
+    /**
+     * @brief Get the number of moved allocations of the last defragmentation
+     *
+     * @return ui32    Moved allocations
+     */
+    ui32 get_move_count() const {
+        return move_count;
+    }
+
+private:
+    /**
+     * @brief Registered resource
+     */
+    struct entry {
+        /// Buffer (or nullptr)
+        lava::buffer::ptr buffer;
+
+        /// Texture (or nullptr)
+        lava::texture::ptr texture;
+
+        /// Layout of texture image
+        VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        /// Called after move
+        moved_func on_moved;
+    };
+
+    /**
+     * @brief Move of a pass
+     */
+    struct move {
+        /// Registered resource
+        entry const* resource = nullptr;
+
+        /// New buffer
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        /// New image
+        VkImage image = VK_NULL_HANDLE;
+    };
+
+    /**
+     * @brief Prepare the moves of a pass (create and bind new handles)
+     *
+     * @param pass_info    Vma pass information
+     *
+     * @return list        List of moves (same order as pass_info)
+     */
+    std::vector<move> prepare_moves(VmaDefragmentationPassMoveInfo& pass_info);
+
+    /**
+     * @brief Record the copies of a pass
+     *
+     * @param cmd_buf    Command buffer
+     * @param moves      List of moves
+     */
+    void copy_moves(VkCommandBuffer cmd_buf, std::vector<move> const& moves) const;
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Command pool
+    VkCommandPool pool = VK_NULL_HANDLE;
+
+    /// Registered resources by allocation
+    std::unordered_map<VmaAllocation, entry> resources;
+
+    /// Vma defragmentation context
+    VmaDefragmentationContext context = nullptr;
+
+    /// Max bytes moved per pass
+    VkDeviceSize max_bytes_per_pass = 0;
+
+    /// Max allocations moved per pass
+    ui32 max_moves_per_pass = 0;
+
+    /// Moved bytes
+    VkDeviceSize moved_bytes = 0;
+
+    /// Freed bytes
+    VkDeviceSize freed_bytes = 0;
+
+    /// Moved allocations
+    ui32 move_count = 0;
+};
+
+/**
+ * @brief Make a new defragmenter
+ *
+ * @return defragmenter::ptr    Shared pointer to defragmenter
+ */
+inline defragmenter::ptr make_defragmenter() {
+    return std::make_shared<defragmenter>();
+}
+
+} // namespace lava
@@ -419,6 +419,18 @@ VkFormat_optional get_supported_format(VkPhysicalDevice physical_device, VkForma
     return std::nullopt;
 }
 
+//-----------------------------------------------------------------------------
+bool format_blit_supported(VkPhysicalDevice physical_device, VkFormat format, bool linear_filter) {
+    VkFormatFeatureFlags features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if (linear_filter)
+        features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    VkFormatProperties format_props;
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &format_props);
+
+    return (format_props.optimalTilingFeatures & features) == features;
+}
+
 //-----------------------------------------------------------------------------
 VkImageMemoryBarrier image_memory_barrier(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout) {
     return {
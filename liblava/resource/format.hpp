@@ -120,6 +120,18 @@ VkFormat_optional get_supported_depth_format(VkPhysicalDevice physical_device);
  */
 VkFormat_optional get_supported_format(VkPhysicalDevice physical_device, VkFormats const& possible_formats, VkImageUsageFlags usage);
 
+/**
+ * @brief Check if a format supports blits (optimal tiling)
+ * 
+ * @param physical_device    Physical device
+ * @param format             Format to check
+ * @param linear_filter      Check for linear filtering
+ * 
+ * @return true              Blit is supported
+ * @return false             Blit is not supported
+ */
+bool format_blit_supported(VkPhysicalDevice physical_device, VkFormat format, bool linear_filter = true);
+
 /**
  * @brief Get image memory barrier
  * 
@@ -0,0 +1,87 @@
+/**
+ * @file         liblava/resource/frame_allocator.cpp
+ * @brief        Per-frame linear allocator for uniform and storage data
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/frame_allocator.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+bool frame_allocator::create(device_ptr device, VkDeviceSize s, ui32 frames, VkBufferUsageFlags usage) {
+    auto const& limits = device->get_properties().limits;
+
+    alignment = 1;
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+        alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
+    if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+
+    // offset alignments are powers of two
+    size = (s + alignment - 1) & ~(alignment - 1);
+    frame_count = std::max(frames, 1u);
+
+    ring_buffer = make_buffer();
+    if (!ring_buffer->create_mapped(device, nullptr, size * frame_count, usage)) {
+        log()->error("create frame allocator");
+        ring_buffer = nullptr;
+        return false;
+    }
+
+    region = 0;
+    head = 0;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void frame_allocator::destroy() {
+    ring_buffer = nullptr;
+
+    size = 0;
+    region = 0;
+    head = 0;
+}
+
+//-----------------------------------------------------------------------------
+void frame_allocator::begin_frame(index frame) {
+    region = size * (frame % frame_count);
+    head = 0;
+}
+
+//-----------------------------------------------------------------------------
+frame_allocation frame_allocator::allocate(VkDeviceSize alloc_size) {
+    if (!ring_buffer)
+        return {};
+
+    auto const aligned_size = (std::max(alloc_size, VkDeviceSize(1)) + alignment - 1) & ~(alignment - 1);
+    if (head + aligned_size > size) {
+        log()->error("frame allocator full ({} bytes per frame)", size);
+        return {};
+    }
+
+    frame_allocation result;
+    result.buffer = ring_buffer;
+    result.offset = to_ui32(region + head);
+    result.size = alloc_size;
+    result.data = (data_ptr) ring_buffer->get_mapped_data() + region + head;
+
+    head += aligned_size;
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+void frame_allocator::flush() {
+    if (ring_buffer && head > 0)
+        ring_buffer->flush(region, head);
+}
+
+//-----------------------------------------------------------------------------
+VkDescriptorBufferInfo frame_allocator::get_descriptor_info(VkDeviceSize range) const {
+    return { ring_buffer ? ring_buffer->get() : VK_NULL_HANDLE, 0, range };
+}
+
+} // namespace lava
@@ -0,0 +1,195 @@
+/**
+ * @file         liblava/resource/frame_allocator.hpp
+ * @brief        Per-frame linear allocator for uniform and storage data
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/buffer.hpp>
+
+namespace lava {
+
+/// Default size of frame allocator region
+constexpr VkDeviceSize const default_frame_allocator_size = 4 << 20;
+
+/**
+ * @brief Frame allocation (range of mapped buffer)
+ */
+struct frame_allocation {
+    /// Buffer of allocation
+    lava::buffer::ptr buffer;
+
+    /// Dynamic offset in buffer
+    index offset = 0;
+
+    /// Size of allocation
+    VkDeviceSize size = 0;
+
+    /// Mapped data
+    data_ptr data = nullptr;
+
+    /**
+     * @brief Check if the allocation is valid
+     *
+     * @return true     Allocation is valid
+     * @return false    Allocation is invalid
+     */
+    bool valid() const {
+        return data != nullptr;
+    }
+};
+
+/**
+ * @brief Frame allocator
+ *
+ * One persistently mapped buffer with a region per frame in flight. Allocations are linear
+ * in the region of the current frame and reset when the frame index comes back, so data of
+ * frames in flight is not overwritten. Use the offsets as dynamic descriptor offsets
+ * (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC or STORAGE_BUFFER_DYNAMIC).
+ */
+struct frame_allocator : no_copy_no_move {
+    /// Shared pointer to frame allocator
+    using ptr = std::shared_ptr<frame_allocator>;
+
+    /**
+     * @brief Destroy the frame allocator
+     */
+    ~frame_allocator() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new frame allocator
+     *
+     * @param device         Vulkan device
+     * @param size           Size of region per frame
+     * @param frame_count    Number of frames in flight
+     * @param usage          Buffer usage flags
+     *
+     * @return true          Create was successful
+     * @return false         Create failed
+     */
+    bool create(device_ptr device, VkDeviceSize size = default_frame_allocator_size, ui32 frame_count = 3,
+                VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    /**
+     * @brief Destroy the frame allocator
+     */
+    void destroy();
+
+    /**
+     * @brief Begin a frame (resets the region of the frame)
+     *
+     * @param frame    Frame index
+     */
+    void begin_frame(index frame);
+
+    /**
+     * @brief Allocate in the region of the current frame
+     *
+     * @param size                  Size of allocation
+     *
+     * @return frame_allocation     Allocation (invalid: region is full)
+     */
+    frame_allocation allocate(VkDeviceSize size);
+
+    /**
+     * @brief Allocate and copy a value
+     *
+     * @tparam T                    Type of value
+     *
+     * @param value                 Value to copy
+     *
+     * @return frame_allocation     Allocation (invalid: region is full)
+     */
+    template<typename T>
+    frame_allocation push(T const& value) {
+        auto result = allocate(sizeof(T));
+        if (result.valid())
+            memcpy(result.data, &value, sizeof(T));
+
+        return result;
+    }
+
+    /**
+     * @brief Flush the allocations of the current frame (before submit)
+     */
+    void flush();
+
+    /**
+     * @brief Get the descriptor buffer information for dynamic offsets
+     *
+     * @param range                      Size of bound range (e.g. size of uniform struct)
+     *
+     * @return VkDescriptorBufferInfo    Descriptor buffer information (offset 0)
+     */
+    VkDescriptorBufferInfo get_descriptor_info(VkDeviceSize range) const;
+
+    /**
+     * @brief Get the buffer
+     *
+     * @return buffer::ptr    Shared pointer to buffer
+     */
+    buffer::ptr get_buffer() const {
+        return ring_buffer;
+    }
+
+    /**
+     * @brief Get the offset alignment
+     *
+     * @return VkDeviceSize    Alignment of allocations
+     */
+    VkDeviceSize get_alignment() const {
+        return alignment;
+    }
+
+    /**
+     * @brief Get the used size of the current frame
+     *
+     * @return VkDeviceSize    Used size in bytes
+     */
+    VkDeviceSize get_used() const {
+        return head;
+    }
+
+    /**
+     * @brief Get the size of a frame region
+     *
+     * @return VkDeviceSize    Region size in bytes
+     */
+    VkDeviceSize get_size() const {
+        return size;
+    }
+
+private:
+    /// Mapped buffer with one region per frame
+    lava::buffer::ptr ring_buffer;
+
+    /// Size of region per frame
+    VkDeviceSize size = 0;
+
+    /// Number of frames in flight
+    ui32 frame_count = 3;
+
+    /// Offset alignment
+    VkDeviceSize alignment = 256;
+
+    /// Offset of current region
+    VkDeviceSize region = 0;
+
+    /// Used size of current region
+    VkDeviceSize head = 0;
+};
+
+/**
+ * @brief Make a new frame allocator
+ *
+ * @return frame_allocator::ptr    Shared pointer to frame allocator
+ */
+inline frame_allocator::ptr make_frame_allocator() {
+    return std::make_shared<frame_allocator>();
+}
+
+} // namespace lava
@@ -57,12 +57,26 @@ bool image::create(device_ptr d, uv2 size, VmaMemoryUsage memory_usage, bool mip
 
     info.extent = { size.x, size.y, 1 };
 
+    if (mip_levels_generation)
+        set_level_count(get_mip_level_count(size));
+
     if (!vk_image) {
         VmaAllocationCreateInfo create_info{
             .usage = memory_usage,
         };
 
-        if (failed(vmaCreateImage(device->alloc(), &info, &create_info, &vk_image, &allocation, nullptr))) {
+        // transient attachments prefer tile memory
+        lazy = transient() && memory_usage == VMA_MEMORY_USAGE_GPU_ONLY;
+        if (lazy) {
+            create_info.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+
+            if (vmaCreateImage(device->alloc(), &info, &create_info, &vk_image, &allocation, nullptr) != VK_SUCCESS) {
+                create_info.usage = memory_usage;
+                lazy = false;
+            }
+        }
+
+        if (!vk_image && failed(vmaCreateImage(device->alloc(), &info, &create_info, &vk_image, &allocation, nullptr))) {
             log()->error("create image");
             return false;
         }
@@ -74,6 +88,41 @@ bool image::create(device_ptr d, uv2 size, VmaMemoryUsage memory_usage, bool mip
     return device->vkCreateImageView(&view_info, &view);
 }
 
+//-----------------------------------------------------------------------------
+bool image::create(device_ptr d, uv2 size, VmaAllocation memory, VkDeviceSize offset) {
+    device = d;
+
+    info.extent = { size.x, size.y, 1 };
+
+    if (failed(device->call().vkCreateImage(device->get(), &info, memory::alloc(), &vk_image))) {
+        log()->error("create aliased image");
+        return false;
+    }
+
+    if (failed(vmaBindImageMemory2(device->alloc(), memory, offset, vk_image, nullptr))) {
+        log()->error("bind aliased image");
+
+        device->call().vkDestroyImage(device->get(), vk_image, memory::alloc());
+        vk_image = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VmaAllocationInfo allocation_info{};
+    vmaGetAllocationInfo(device->alloc(), memory, &allocation_info);
+
+    VkMemoryPropertyFlags memory_flags = 0;
+    vmaGetMemoryTypeProperties(device->alloc(), allocation_info.memoryType, &memory_flags);
+    lazy = (memory_flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+
+    allocation = nullptr;
+    bound = true;
+
+    view_info.image = vk_image;
+    view_info.subresourceRange = subresource_range;
+
+    return device->vkCreateImageView(&view_info, &view);
+}
+
 //-----------------------------------------------------------------------------
 void image::destroy(bool view_only) {
     if (view) {
@@ -85,14 +134,34 @@ void image::destroy(bool view_only) {
         return;
 
     if (vk_image) {
+        // aliased images release only the handle
         vmaDestroyImage(device->alloc(), vk_image, allocation);
         vk_image = 0;
         allocation = nullptr;
     }
 
+    lazy = false;
+    bound = false;
+
     device = nullptr;
 }
 
+//-----------------------------------------------------------------------------
+bool image::rebind(VkImage value) {
+    if (view) {
+        device->vkDestroyImageView(view);
+        view = 0;
+    }
+
+    device->call().vkDestroyImage(device->get(), vk_image, memory::alloc());
+    vk_image = value;
+
+    view_info.image = vk_image;
+    view_info.subresourceRange = subresource_range;
+
+    return device->vkCreateImageView(&view_info, &view);
+}
+
 //-----------------------------------------------------------------------------
 image::ptr make_image(VkFormat format, VkImage vk_image) {
     return std::make_shared<image>(format, vk_image);
@@ -108,4 +177,68 @@ image::ptr make_image(VkFormat format, device_ptr device, uv2 size, VkImage vk_i
     return result;
 }
 
+//-----------------------------------------------------------------------------
+void blit_mip_levels(VkCommandBuffer cmd_buf, image::ptr image, VkFilter filter, VkPipelineStageFlags dst_stage_mask) {
+    auto device = image->get_device();
+    auto const& range = image->get_subresource_range();
+
+    VkImageSubresourceRange level_range{
+        .aspectMask = range.aspectMask,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = range.layerCount,
+    };
+
+    auto size = image->get_size();
+
+    for (auto level = 1u; level < range.levelCount; ++level) {
+        level_range.baseMipLevel = level - 1;
+
+        // previous level is ready as blit source
+        insert_image_memory_barrier(device, cmd_buf, image->get(),
+                                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, level_range);
+
+        uv2 const level_size = { std::max(size.x / 2, 1u), std::max(size.y / 2, 1u) };
+
+        VkImageBlit blit{
+            .srcSubresource = {
+                .aspectMask = range.aspectMask,
+                .mipLevel = level - 1,
+                .baseArrayLayer = 0,
+                .layerCount = range.layerCount,
+            },
+            .srcOffsets = { {}, { i32(size.x), i32(size.y), 1 } },
+            .dstSubresource = {
+                .aspectMask = range.aspectMask,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = range.layerCount,
+            },
+            .dstOffsets = { {}, { i32(level_size.x), i32(level_size.y), 1 } },
+        };
+
+        device->call().vkCmdBlitImage(cmd_buf, image->get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                      image->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      1, &blit, filter);
+
+        insert_image_memory_barrier(device, cmd_buf, image->get(),
+                                    VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage_mask, level_range);
+
+        size = level_size;
+    }
+
+    // last level was only written
+    level_range.baseMipLevel = range.levelCount - 1;
+
+    insert_image_memory_barrier(device, cmd_buf, image->get(),
+                                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage_mask, level_range);
+}
+
 } // namespace lava
@@ -11,6 +11,18 @@
 
 namespace lava {
 
+/**
+ * @brief Get the number of mip levels for a full mip chain
+ *
+ * @param size     Image size
+ *
+ * @return ui32    Number of mip levels
+ */
+inline ui32 get_mip_level_count(uv2 size) {
+    auto const max_size = std::max(size.x, size.y);
+    return max_size > 0 ? to_ui32(std::floor(std::log2(max_size))) + 1 : 1;
+}
+
 /**
  * @brief Image
  */
@@ -38,13 +50,28 @@ struct image : entity {
      * @param device                   Vulkan device
      * @param size                     Image size
      * @param memory_usage             Memory usage
-     * @param mip_levels_generation    Enable mip levels generation
+     * @param mip_levels_generation    Enable mip levels generation (full mip chain)
      * 
      * @return true                    Create was successful
      * @return false                   Create failed
      */
     bool create(device_ptr device, uv2 size, VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_GPU_ONLY, bool mip_levels_generation = false);
 
+    /**
+     * @brief Create a new image in memory of an existing allocation (see aliasing_allocator)
+     * 
+     * The image does not own the memory, destroy only releases the image and view.
+     * 
+     * @param device        Vulkan device
+     * @param size          Image size
+     * @param memory        Allocation to bind
+     * @param offset        Offset in allocation
+     * 
+     * @return true         Create was successful
+     * @return false        Create failed
+     */
+    bool create(device_ptr device, uv2 size, VmaAllocation memory, VkDeviceSize offset);
+
     /**
      * @brief Destroy the image
      * 
@@ -140,6 +167,48 @@ struct image : entity {
         return subresource_range;
     }
 
+    /**
+     * @brief Get the allocation
+     * 
+     * @return VmaAllocation const&    Allocation
+     */
+    VmaAllocation const& get_allocation() const {
+        return allocation;
+    }
+
+    /**
+     * @brief Check if the image is backed by lazily allocated memory
+     * 
+     * @return true     Memory is committed on demand (tile memory)
+     * @return false    Regular device memory
+     */
+    bool lazily_allocated() const {
+        return lazy;
+    }
+
+    /**
+     * @brief Check if the image is bound to memory it does not own
+     * 
+     * @return true     Image aliases an allocation
+     * @return false    Image owns its allocation
+     */
+    bool aliased() const {
+        return bound;
+    }
+
+    /**
+     * @brief Replace the image handle after its allocation was moved (see defragmenter)
+     * 
+     * The previous handle and view are destroyed, a new view is created.
+     * Descriptor sets using the image need to be updated.
+     * 
+     * @param value     Image bound to the moved allocation
+     * 
+     * @return true     Rebind was successful
+     * @return false    Create view failed
+     */
+    bool rebind(VkImage value);
+
     /**
      * @brief Set the image create flags
      * 
@@ -167,6 +236,29 @@ struct image : entity {
         info.usage = usage;
     }
 
+    /**
+     * @brief Make the image a transient attachment
+     * 
+     * Only attachment usage is kept. The contents must not leave the render pass
+     * (store op don't care), memory is then lazily allocated where supported.
+     */
+    void set_transient() {
+        info.usage &= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+                      | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+                      | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+        info.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    }
+
+    /**
+     * @brief Check if the image is a transient attachment
+     * 
+     * @return true     Transient attachment
+     * @return false    Regular image
+     */
+    bool transient() const {
+        return (info.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+    }
+
     /**
      * @brief Set the initial layout of the image
      * 
@@ -236,6 +328,12 @@ private:
     /// Allocation
     VmaAllocation allocation = nullptr;
 
+    /// Lazily allocated memory
+    bool lazy = false;
+
+    /// Bound to memory of another allocation
+    bool bound = false;
+
     /// Vulkan image view
     VkImageView view = VK_NULL_HANDLE;
 
@@ -268,4 +366,17 @@ image::ptr make_image(VkFormat format, VkImage vk_image = 0);
  */
 image::ptr make_image(VkFormat format, device_ptr device, uv2 size, VkImage vk_image = 0);
 
+/**
+ * @brief Generate all mip levels of an image from level 0 with a blit chain
+ * 
+ * All levels must be in transfer destination layout, they end up in shader read only layout.
+ * 
+ * @param cmd_buf           Command buffer
+ * @param image             Target image
+ * @param filter            Blit filter
+ * @param dst_stage_mask    Destination pipeline stage flags
+ */
+void blit_mip_levels(VkCommandBuffer cmd_buf, image::ptr image, VkFilter filter = VK_FILTER_LINEAR,
+                     VkPipelineStageFlags dst_stage_mask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
 } // namespace lava
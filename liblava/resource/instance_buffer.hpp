@@ -0,0 +1,296 @@
+/**
+ * @file         liblava/resource/instance_buffer.hpp
+ * @brief        Per-instance vertex data
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <deque>
+#include <liblava/resource/buffer.hpp>
+
+namespace lava {
+
+/**
+ * @brief Default instance data (transform and color)
+ */
+struct instance_data {
+    /// List of instance data
+    using list = std::vector<instance_data>;
+
+    /// Instance transform
+    mat4 transform = mat4(1.f);
+
+    /// Instance color
+    v4 color = v4(1.f);
+
+    /**
+     * @brief Get the vertex input attributes (transform: 4 locations, color: 1 location)
+     *
+     * @param binding                               Instance binding
+     * @param location                              First shader location
+     *
+     * @return VkVertexInputAttributeDescriptions    List of attributes
+     */
+    static VkVertexInputAttributeDescriptions get_attributes(ui32 binding, ui32 location) {
+        VkVertexInputAttributeDescriptions result;
+
+        for (auto column = 0u; column < 4; ++column)
+            result.push_back({ location + column, binding, VK_FORMAT_R32G32B32A32_SFLOAT,
+                               to_ui32(offsetof(instance_data, transform) + sizeof(v4) * column) });
+
+        result.push_back({ location + 4, binding, VK_FORMAT_R32G32B32A32_SFLOAT,
+                           to_ui32(offsetof(instance_data, color)) });
+
+        return result;
+    }
+};
+
+/**
+ * @brief Instance buffer
+ *
+ * CPU side list of instances, uploaded once per frame into a persistently mapped buffer
+ * with one region per frame in flight. The buffer grows if needed, replaced buffers are
+ * released after the frames in flight are done.
+ *
+ * @tparam I    Instance data struct
+ */
+template<typename I = instance_data>
+struct instance_buffer_template : entity {
+    /// Shared pointer to instance buffer
+    using ptr = std::shared_ptr<instance_buffer_template<I>>;
+
+    /// List of instances
+    using instance_list = std::vector<I>;
+
+    /**
+     * @brief Destroy the instance buffer
+     */
+    ~instance_buffer_template() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new instance buffer
+     *
+     * @param device         Vulkan device
+     * @param capacity       Initial number of instances per frame
+     * @param frame_count    Number of frames in flight
+     *
+     * @return true          Create was successful
+     * @return false         Create failed
+     */
+    bool create(device_ptr device, ui32 capacity = 1024, ui32 frame_count = 3);
+
+    /**
+     * @brief Destroy the instance buffer
+     */
+    void destroy();
+
+    /**
+     * @brief Add an instance
+     *
+     * @param instance    Instance data
+     */
+    void add(I const& instance) {
+        instances.push_back(instance);
+    }
+
+    /**
+     * @brief Clear all instances
+     */
+    void clear() {
+        instances.clear();
+    }
+
+    /**
+     * @brief Get the instances
+     *
+     * @return instance_list&    List of instances
+     */
+    instance_list& get_instances() {
+        return instances;
+    }
+
+    /**
+     * @brief Get the number of uploaded instances (see update)
+     *
+     * @return ui32    Number of instances
+     */
+    ui32 get_count() const {
+        return count;
+    }
+
+    /**
+     * @brief Upload the instances for a frame
+     *
+     * @param frame     Frame index
+     *
+     * @return true     Update was successful
+     * @return false    Update failed
+     */
+    bool update(index frame);
+
+    /**
+     * @brief Bind the instances of the last update
+     *
+     * @param cmd_buf    Command buffer
+     * @param binding    Instance binding
+     */
+    void bind(VkCommandBuffer cmd_buf, ui32 binding) const;
+
+    /**
+     * @brief Get the vertex input binding
+     *
+     * @param binding                             Instance binding
+     *
+     * @return VkVertexInputBindingDescription    Binding with instance input rate
+     */
+    static VkVertexInputBindingDescription get_binding(ui32 binding) {
+        return { binding, to_ui32(sizeof(I)), VK_VERTEX_INPUT_RATE_INSTANCE };
+    }
+
+    /**
+     * @brief Get the capacity
+     *
+     * @return ui32    Number of instances per frame
+     */
+    ui32 get_capacity() const {
+        return capacity;
+    }
+
+private:
+    /**
+     * @brief Create the ring buffer
+     *
+     * @param value     Number of instances per frame
+     *
+     * @return true     Create was successful
+     * @return false    Create failed
+     */
+    bool create_buffer(ui32 value);
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// CPU side instances
+    instance_list instances;
+
+    /// Mapped buffer with one region per frame
+    lava::buffer::ptr ring_buffer;
+
+    /// Replaced buffers (remaining updates until release)
+    std::deque<std::pair<ui32, lava::buffer::ptr>> retired;
+
+    /// Number of instances per frame
+    ui32 capacity = 0;
+
+    /// Number of frames in flight
+    ui32 frame_count = 3;
+
+    /// Offset of last update
+    VkDeviceSize offset = 0;
+
+    /// Number of instances of last update
+    ui32 count = 0;
+};
+
+/// Instance buffer with default instance data
+using instance_buffer = instance_buffer_template<instance_data>;
+
+/**
+ * @brief Make a new instance buffer
+ *
+ * @tparam I                      Instance data struct
+ *
+ * @return instance_buffer::ptr   Shared pointer to instance buffer
+ */
+template<typename I = instance_data>
+inline typename instance_buffer_template<I>::ptr make_instance_buffer() {
+    return std::make_shared<instance_buffer_template<I>>();
+}
+
+//-----------------------------------------------------------------------------
+template<typename I>
+bool instance_buffer_template<I>::create_buffer(ui32 value) {
+    auto buffer = make_buffer();
+    if (!buffer->create_mapped(device, nullptr, sizeof(I) * size_t(value) * frame_count,
+                               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)) {
+        log()->error("create instance buffer");
+        return false;
+    }
+
+    // frames in flight may still read the old buffer
+    if (ring_buffer)
+        retired.emplace_back(frame_count, ring_buffer);
+
+    ring_buffer = buffer;
+    capacity = value;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+template<typename I>
+bool instance_buffer_template<I>::create(device_ptr d, ui32 c, ui32 frames) {
+    device = d;
+    frame_count = std::max(frames, 1u);
+
+    return create_buffer(std::max(c, 1u));
+}
+
+//-----------------------------------------------------------------------------
+template<typename I>
+void instance_buffer_template<I>::destroy() {
+    ring_buffer = nullptr;
+    retired.clear();
+    instances.clear();
+
+    capacity = 0;
+    offset = 0;
+    count = 0;
+
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+template<typename I>
+bool instance_buffer_template<I>::update(index frame) {
+    for (auto& [updates, buffer] : retired)
+        --updates;
+
+    while (!retired.empty() && retired.front().first == 0)
+        retired.pop_front();
+
+    if (instances.size() > capacity) {
+        auto new_capacity = capacity;
+        while (new_capacity < instances.size())
+            new_capacity *= 2;
+
+        if (!create_buffer(new_capacity))
+            return false;
+    }
+
+    offset = sizeof(I) * VkDeviceSize(capacity) * (frame % frame_count);
+    count = to_ui32(instances.size());
+
+    if (count > 0) {
+        memcpy((char*) ring_buffer->get_mapped_data() + offset, instances.data(), sizeof(I) * instances.size());
+        ring_buffer->flush(offset, sizeof(I) * instances.size());
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+template<typename I>
+void instance_buffer_template<I>::bind(VkCommandBuffer cmd_buf, ui32 binding) const {
+    if (!ring_buffer)
+        return;
+
+    VkBuffer const buffer = ring_buffer->get();
+    vkCmdBindVertexBuffers(cmd_buf, binding, 1, &buffer, &offset);
+}
+
+} // namespace lava
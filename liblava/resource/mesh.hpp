@@ -7,11 +7,196 @@
 
 #pragma once
 
-#include <liblava/resource/buffer.hpp>
 #include <liblava/resource/primitive.hpp>
+#include <liblava/resource/texture.hpp>
 
 namespace lava {
 
+/**
+ * @brief Mesh level of detail
+ */
+struct mesh_lod {
+    /// List of mesh LODs
+    using list = std::vector<mesh_lod>;
+
+    /// First index in the shared index list
+    ui32 first_index = 0;
+
+    /// Number of indices
+    ui32 index_count = 0;
+
+    /// Object space error compared to the full detail mesh
+    r32 error = 0.f;
+};
+
+/**
+ * @brief Mesh vertex layouts
+ *
+ * Interleaved: one stream with whole vertices,
+ * position split: position stream and attribute stream,
+ * soa: one stream per attribute (structure of arrays)
+ */
+enum class mesh_layout : type {
+    interleaved = 0,
+    position_split,
+    soa
+};
+
+/**
+ * @brief Vertex attributes
+ */
+enum class vertex_attribute : type {
+    position = 0,
+    color,
+    uv,
+    normal
+};
+
+/// Map of shader locations by vertex attribute
+using vertex_locations = std::map<vertex_attribute, ui32>;
+
+/// Default shader locations
+inline vertex_locations const default_vertex_locations = {
+    { vertex_attribute::position, 0 },
+    { vertex_attribute::color, 1 },
+    { vertex_attribute::uv, 2 },
+    { vertex_attribute::normal, 3 },
+};
+
+/**
+ * @brief Vertex attribute information
+ */
+struct vertex_attribute_info {
+    /// List of vertex attribute informations
+    using list = std::vector<vertex_attribute_info>;
+
+    /// Vertex attribute
+    vertex_attribute attribute = vertex_attribute::position;
+
+    /// Offset in vertex struct or stream
+    ui32 offset = 0;
+
+    /// Size of attribute
+    ui32 size = 0;
+
+    /// Vertex format
+    VkFormat format = VK_FORMAT_UNDEFINED;
+};
+
+/**
+ * @brief Vertex stream (one vertex buffer)
+ */
+struct vertex_stream {
+    /// List of vertex streams
+    using list = std::vector<vertex_stream>;
+
+    /// Attributes in stream (offsets in stream)
+    vertex_attribute_info::list attributes;
+
+    /// Stride of stream
+    ui32 stride = 0;
+};
+
+/**
+ * @brief Get the vertex format of a vector type
+ *
+ * @tparam V               Vector type (glm vector or std::array of float, double, int or unsigned)
+ *
+ * @return VkFormat        Vertex format (undefined: not supported)
+ */
+template<typename V>
+constexpr VkFormat get_vertex_format() {
+    using C = typename V::value_type;
+
+    // glm vectors and std::array are tightly packed
+    constexpr auto length = sizeof(V) / sizeof(C);
+    static_assert(length >= 1 && length <= 4, "vertex vector with 1 to 4 components");
+
+    if constexpr (std::is_same_v<C, r32>)
+        return std::array{ VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                           VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT }[length - 1];
+    else if constexpr (std::is_same_v<C, r64>)
+        return std::array{ VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT,
+                           VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT }[length - 1];
+    else if constexpr (std::is_same_v<C, i32>)
+        return std::array{ VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                           VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT }[length - 1];
+    else if constexpr (std::is_same_v<C, ui32>)
+        return std::array{ VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                           VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT }[length - 1];
+    else
+        return VK_FORMAT_UNDEFINED;
+}
+
+/**
+ * @brief Get the attributes of a vertex struct
+ *
+ * Vertex structs with packed attributes provide them by a static get_attributes function.
+ *
+ * @tparam T                              Vertex struct with position (color, uv and normal are optional)
+ *
+ * @return vertex_attribute_info::list    Attributes in struct order of vertex_attribute
+ */
+template<typename T>
+vertex_attribute_info::list get_vertex_attributes() {
+    if constexpr (requires { T::get_attributes(); }) {
+        return T::get_attributes();
+    } else {
+        vertex_attribute_info::list result;
+
+        result.push_back({ vertex_attribute::position, to_ui32(offsetof(T, position)),
+                           to_ui32(sizeof(T::position)), get_vertex_format<decltype(T::position)>() });
+
+        if constexpr (requires(T const t) { t.color; })
+            result.push_back({ vertex_attribute::color, to_ui32(offsetof(T, color)),
+                               to_ui32(sizeof(T::color)), get_vertex_format<decltype(T::color)>() });
+
+        if constexpr (requires(T const t) { t.uv; })
+            result.push_back({ vertex_attribute::uv, to_ui32(offsetof(T, uv)),
+                               to_ui32(sizeof(T::uv)), get_vertex_format<decltype(T::uv)>() });
+
+        if constexpr (requires(T const t) { t.normal; })
+            result.push_back({ vertex_attribute::normal, to_ui32(offsetof(T, normal)),
+                               to_ui32(sizeof(T::normal)), get_vertex_format<decltype(T::normal)>() });
+
+        return result;
+    }
+}
+
+/**
+ * @brief Get the vertex streams of a vertex struct
+ *
+ * @tparam T                       Vertex struct
+ *
+ * @param layout                   Mesh vertex layout
+ *
+ * @return vertex_stream::list     Streams (position is always in the first stream)
+ */
+template<typename T>
+vertex_stream::list get_vertex_streams(mesh_layout layout) {
+    auto const attributes = get_vertex_attributes<T>();
+
+    if (layout == mesh_layout::interleaved)
+        return { { attributes, to_ui32(sizeof(T)) } };
+
+    vertex_stream::list result;
+
+    for (auto info : attributes) {
+        // position split: all attributes after the position go into the second stream
+        auto const next_stream = layout == mesh_layout::soa
+                                 || result.size() < (info.attribute == vertex_attribute::position ? 1u : 2u);
+        if (next_stream)
+            result.emplace_back();
+
+        auto& stream = result.back();
+        info.offset = stream.stride;
+        stream.stride += info.size;
+        stream.attributes.push_back(info);
+    }
+
+    return result;
+}
+
 /**
  * @brief Templated mesh data
  *
@@ -25,6 +210,9 @@ struct mesh_data {
     /// List of indices.
     index_list indices;
 
+    /// List of LODs (index ranges into indices, empty: single LOD)
+    mesh_lod::list lods;
+
 public:
     /**
      * @brief Move mesh data by offset
@@ -85,15 +273,22 @@ struct mesh_template : entity {
     /**
      * @brief Create a new mesh
      *
+     * Static meshes (GPU only, not mapped) are uploaded by a transfer copy,
+     * call on the thread that owns the graphics queue. With a staging the copy is
+     * recorded in the next staging pass instead of waiting for it.
+     * Dynamic meshes use host visible memory.
+     *
      * @param device          Vulkan device
-     * @param mapped          Map mesh data
-     * @param memory_usage    Memory usage
+     * @param mapped          Map mesh data (dynamic mesh)
+     * @param memory_usage    Memory usage (GPU only: device local static mesh)
+     * @param staging         Staging to copy the static mesh (optional)
      *
      * @return true           Create was successful
      * @return false          Create failed
      */
     bool create(device_ptr device, bool mapped = false,
-                VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU);
+                VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_GPU_ONLY,
+                staging* staging = nullptr);
 
     /**
      * @brief Destroy the mesh
@@ -101,12 +296,19 @@ struct mesh_template : entity {
     void destroy();
 
     /**
-     * @brief Bind the mesh
+     * @brief Bind the mesh (all vertex streams)
      *
      * @param cmd_buf    Command buffer
      */
     void bind(VkCommandBuffer cmd_buf) const;
 
+    /**
+     * @brief Bind the position stream and the index buffer (e.g. depth pass)
+     *
+     * @param cmd_buf    Command buffer
+     */
+    void bind_positions(VkCommandBuffer cmd_buf) const;
+
     /**
      * @brief Draw the mesh
      *
@@ -114,6 +316,25 @@ struct mesh_template : entity {
      */
     void draw(VkCommandBuffer cmd_buf) const;
 
+    /**
+     * @brief Draw a LOD of the mesh
+     *
+     * @param cmd_buf    Command buffer
+     * @param lod        Index of LOD (clamped to available LODs)
+     */
+    void draw(VkCommandBuffer cmd_buf, index lod) const;
+
+    /**
+     * @brief Draw instances of the mesh
+     *
+     * @param cmd_buf           Command buffer
+     * @param instance_count    Number of instances
+     * @param first_instance    First instance
+     * @param lod               Index of LOD (clamped to available LODs)
+     */
+    void draw_instanced(VkCommandBuffer cmd_buf, ui32 instance_count,
+                        ui32 first_instance = 0, index lod = 0) const;
+
     /**
      * @brief Bind and draw the mesh
      *
@@ -213,6 +434,24 @@ struct mesh_template : entity {
         return to_ui32(data.indices.size());
     }
 
+    /**
+     * @brief Get the LODs of the mesh
+     *
+     * @return mesh_lod::list const&    List of LODs
+     */
+    mesh_lod::list const& get_lods() const {
+        return data.lods;
+    }
+
+    /**
+     * @brief Get the LOD count of the mesh
+     *
+     * @return ui32    Number of LODs
+     */
+    ui32 get_lod_count() const {
+        return data.lods.empty() ? 1 : to_ui32(data.lods.size());
+    }
+
     /**
      * @brief Reload the mesh data
      *
@@ -222,12 +461,69 @@ struct mesh_template : entity {
     bool reload();
 
     /**
-     * @brief Get the vertex buffer of the mesh
+     * @brief Set the vertex layout (before create)
+     *
+     * @param value    Mesh vertex layout
+     */
+    void set_layout(mesh_layout value) {
+        layout = value;
+    }
+
+    /**
+     * @brief Get the vertex layout
+     *
+     * @return mesh_layout    Mesh vertex layout
+     */
+    mesh_layout get_layout() const {
+        return layout;
+    }
+
+    /**
+     * @brief Get the vertex input bindings of the used streams
+     *
+     * @param locations                           Shader locations of used attributes
+     *
+     * @return VkVertexInputBindingDescriptions    List of bindings (binding: stream index)
+     */
+    VkVertexInputBindingDescriptions get_vertex_input_bindings(vertex_locations const& locations = default_vertex_locations) const;
+
+    /**
+     * @brief Get the vertex input attributes
+     *
+     * @param locations                             Shader locations of used attributes
+     *
+     * @return VkVertexInputAttributeDescriptions    List of attributes
+     */
+    VkVertexInputAttributeDescriptions get_vertex_input_attributes(vertex_locations const& locations = default_vertex_locations) const;
+
+    /**
+     * @brief Get the index type
+     *
+     * 16-bit indices only for staged (GPU only) meshes up to 65535 vertices,
+     * mapped meshes keep the ui32 indices of the mesh data.
+     *
+     * @return VkIndexType    Index type
+     */
+    VkIndexType get_index_type() const {
+        return index_type;
+    }
+
+    /**
+     * @brief Get the vertex buffer of the mesh (first stream)
      *
      * @return buffer::ptr    Shared pointer to buffer
      */
     buffer::ptr get_vertex_buffer() {
-        return vertex_buffer;
+        return vertex_buffers.empty() ? nullptr : vertex_buffers.front();
+    }
+
+    /**
+     * @brief Get the vertex buffers of the mesh (one per stream)
+     *
+     * @return buffer::list const&    List of buffers
+     */
+    buffer::list const& get_vertex_buffers() const {
+        return vertex_buffers;
     }
 
     /**
@@ -246,8 +542,8 @@ private:
     /// Mesh data
     mesh_data<T> data;
 
-    /// Vertex buffer
-    buffer::ptr vertex_buffer;
+    /// Vertex buffers (one per stream)
+    buffer::list vertex_buffers;
 
     /// Index buffer
     buffer::ptr index_buffer;
@@ -256,36 +552,112 @@ private:
     bool mapped = false;
 
     /// Memory usage
-    VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    /// Vertex layout
+    mesh_layout layout = mesh_layout::interleaved;
+
+    /// Index type of index buffer
+    VkIndexType index_type = VK_INDEX_TYPE_UINT32;
 };
 
 //-----------------------------------------------------------------------------
 template<typename T>
 void mesh_template<T>::bind(VkCommandBuffer cmd_buf) const {
-    if (vertex_buffer && vertex_buffer->valid()) {
-        std::array<VkDeviceSize, 1> const buffer_offsets = { 0 };
-        std::array<VkBuffer, 1> const buffers = { vertex_buffer->get() };
+    if (!vertex_buffers.empty()) {
+        std::vector<VkDeviceSize> const buffer_offsets(vertex_buffers.size(), 0);
+
+        std::vector<VkBuffer> buffers;
+        for (auto& buffer : vertex_buffers)
+            buffers.push_back(buffer->get());
 
         vkCmdBindVertexBuffers(cmd_buf, 0, to_ui32(buffers.size()), buffers.data(), buffer_offsets.data());
     }
 
     if (index_buffer && index_buffer->valid())
-        vkCmdBindIndexBuffer(cmd_buf, index_buffer->get(), 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(cmd_buf, index_buffer->get(), 0, index_type);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_template<T>::bind_positions(VkCommandBuffer cmd_buf) const {
+    if (!vertex_buffers.empty()) {
+        VkDeviceSize const buffer_offset = 0;
+        VkBuffer const buffer = vertex_buffers.front()->get();
+
+        vkCmdBindVertexBuffers(cmd_buf, 0, 1, &buffer, &buffer_offset);
+    }
+
+    if (index_buffer && index_buffer->valid())
+        vkCmdBindIndexBuffer(cmd_buf, index_buffer->get(), 0, index_type);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+VkVertexInputBindingDescriptions mesh_template<T>::get_vertex_input_bindings(vertex_locations const& locations) const {
+    VkVertexInputBindingDescriptions result;
+
+    auto const streams = get_vertex_streams<T>(layout);
+    for (auto i = 0u; i < streams.size(); ++i) {
+        for (auto& info : streams.at(i).attributes) {
+            if (locations.count(info.attribute)) {
+                result.push_back({ i, streams.at(i).stride, VK_VERTEX_INPUT_RATE_VERTEX });
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+VkVertexInputAttributeDescriptions mesh_template<T>::get_vertex_input_attributes(vertex_locations const& locations) const {
+    VkVertexInputAttributeDescriptions result;
+
+    auto const streams = get_vertex_streams<T>(layout);
+    for (auto i = 0u; i < streams.size(); ++i) {
+        for (auto& info : streams.at(i).attributes) {
+            if (locations.count(info.attribute))
+                result.push_back({ locations.at(info.attribute), i, info.format, info.offset });
+        }
+    }
+
+    return result;
 }
 
 //-----------------------------------------------------------------------------
 template<typename T>
 void mesh_template<T>::draw(VkCommandBuffer cmd_buf) const {
+    draw_instanced(cmd_buf, 1);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_template<T>::draw(VkCommandBuffer cmd_buf, index lod) const {
+    draw_instanced(cmd_buf, 1, 0, lod);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_template<T>::draw_instanced(VkCommandBuffer cmd_buf, ui32 instance_count,
+                                      ui32 first_instance, index lod) const {
+    if (!data.lods.empty()) {
+        auto const& range = data.lods.at(std::min(lod, to_ui32(data.lods.size()) - 1));
+        vkCmdDrawIndexed(cmd_buf, range.index_count, instance_count, range.first_index, 0, first_instance);
+        return;
+    }
+
     if (!data.indices.empty())
-        vkCmdDrawIndexed(cmd_buf, to_ui32(data.indices.size()), 1, 0, 0, 0);
+        vkCmdDrawIndexed(cmd_buf, to_ui32(data.indices.size()), instance_count, 0, 0, first_instance);
     else
-        vkCmdDraw(cmd_buf, to_ui32(data.vertices.size()), 1, 0, 0);
+        vkCmdDraw(cmd_buf, to_ui32(data.vertices.size()), instance_count, 0, first_instance);
 }
 
 //-----------------------------------------------------------------------------
 template<typename T>
 void mesh_template<T>::destroy() {
-    vertex_buffer = nullptr;
+    vertex_buffers.clear();
     index_buffer = nullptr;
     device = nullptr;
 }
@@ -335,33 +707,111 @@ std::shared_ptr<mesh_template<T>> create_mesh(device_ptr& device,
 
 //-----------------------------------------------------------------------------
 template<typename T>
-bool mesh_template<T>::create(device_ptr d, bool m, VmaMemoryUsage mu) {
+bool mesh_template<T>::create(device_ptr d, bool m, VmaMemoryUsage mu, staging* staging) {
     device = d;
     mapped = m;
     memory_usage = mu;
 
+    // mapped meshes need host visible memory
+    if (mapped && memory_usage == VMA_MEMORY_USAGE_GPU_ONLY)
+        memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+    auto const staged = memory_usage == VMA_MEMORY_USAGE_GPU_ONLY;
+    VkBufferUsageFlags const transfer_usage = staged ? VK_BUFFER_USAGE_TRANSFER_DST_BIT : 0;
+
+    buffer_upload::list uploads;
+
+    // stream data of split layouts (kept until uploaded)
+    std::vector<std::vector<char>> stream_data;
+
     if (!data.vertices.empty()) {
-        vertex_buffer = make_buffer();
+        auto const streams = get_vertex_streams<T>(layout);
 
-        if (!vertex_buffer->create(device, data.vertices.data(),
-                                   sizeof(vertex) * data.vertices.size(),
-                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                                   mapped, memory_usage)) {
-            log()->error("create mesh vertex buffer");
-            return false;
+        std::array<ui32, 4> source_offsets = {};
+        for (auto& info : get_vertex_attributes<T>())
+            source_offsets.at(to_ui32(info.attribute)) = info.offset;
+
+        stream_data.resize(streams.size());
+
+        for (auto s = 0u; s < streams.size(); ++s) {
+            auto const& stream = streams.at(s);
+
+            void const* source = data.vertices.data();
+            auto const size = size_t(stream.stride) * data.vertices.size();
+
+            if (layout != mesh_layout::interleaved) {
+                auto& target = stream_data.at(s);
+                target.resize(size);
+
+                for (auto v = 0u; v < data.vertices.size(); ++v) {
+                    auto const* vertex_data = (char const*) &data.vertices[v];
+
+                    for (auto& info : stream.attributes)
+                        memcpy(target.data() + size_t(v) * stream.stride + info.offset,
+                               vertex_data + source_offsets.at(to_ui32(info.attribute)), info.size);
+                }
+
+                source = target.data();
+            }
+
+            auto buffer = make_buffer();
+
+            if (!buffer->create(device, staged ? nullptr : source, size,
+                                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | transfer_usage,
+                                mapped, memory_usage)) {
+                log()->error("create mesh vertex buffer");
+                return false;
+            }
+
+            vertex_buffers.push_back(buffer);
+
+            if (staged)
+                uploads.push_back({ buffer, source, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT });
         }
     }
 
+    // 16-bit indices (kept until uploaded)
+    std::vector<ui16> short_indices;
+
     if (!data.indices.empty()) {
+        // mapped index buffers keep the ui32 layout of the mesh data
+        index_type = staged && data.vertices.size() <= 65535 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+        void const* source = data.indices.data();
+        auto size = sizeof(ui32) * data.indices.size();
+
+        if (index_type == VK_INDEX_TYPE_UINT16) {
+            short_indices.reserve(data.indices.size());
+            for (auto index : data.indices)
+                short_indices.push_back(ui16(index));
+
+            source = short_indices.data();
+            size = sizeof(ui16) * short_indices.size();
+        }
+
         index_buffer = make_buffer();
 
-        if (!index_buffer->create(device, data.indices.data(),
-                                  sizeof(ui32) * data.indices.size(),
-                                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        if (!index_buffer->create(device, staged ? nullptr : source, size,
+                                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT | transfer_usage,
                                   mapped, memory_usage)) {
             log()->error("create mesh index buffer");
             return false;
         }
+
+        if (staged)
+            uploads.push_back({ index_buffer, source, size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT });
+    }
+
+    if (staging) {
+        for (auto const& upload : uploads) {
+            if (!staging->add(upload)) {
+                log()->error("stage mesh buffers");
+                return false;
+            }
+        }
+    } else if (!uploads.empty() && !upload_buffers(device, uploads)) {
+        log()->error("upload mesh buffers");
+        return false;
     }
 
     return true;
@@ -0,0 +1,584 @@
+/**
+ * @file         liblava/resource/mesh_lod.hpp
+ * @brief        Mesh simplification and level of detail
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/mesh.hpp>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace lava {
+
+/**
+ * @brief Get the position of a vertex
+ *
+ * @tparam T     Vertex struct typename
+ *
+ * @param vert   Vertex
+ *
+ * @return v3    Position
+ */
+template<typename T>
+inline v3 get_vertex_position(T const& vert) {
+    return { to_r32(vert.position[0]), to_r32(vert.position[1]), to_r32(vert.position[2]) };
+}
+
+/**
+ * @brief Get the position (pass-through for position lists)
+ *
+ * @param position    Position
+ *
+ * @return v3         Position
+ */
+inline v3 get_vertex_position(v3 const& position) {
+    return position;
+}
+
+/**
+ * @brief Bounding sphere
+ */
+struct bounding_sphere {
+    /// Center of sphere
+    v3 center = v3(0.f);
+
+    /// Radius of sphere
+    r32 radius = 0.f;
+};
+
+/**
+ * @brief Calculate a bounding sphere (Ritter) of the vertices
+ *
+ * @tparam T                  Vertex struct typename
+ *
+ * @param vertices            List of vertices
+ *
+ * @return bounding_sphere    Bounding sphere
+ */
+template<typename T>
+inline bounding_sphere calculate_bounding_sphere(std::vector<T> const& vertices) {
+    bounding_sphere result;
+    if (vertices.empty())
+        return result;
+
+    auto const first = get_vertex_position(vertices.front());
+
+    auto farthest = [&](v3 const& from) {
+        auto max_distance = -1.f;
+        auto result = from;
+        for (auto const& vert : vertices) {
+            auto const position = get_vertex_position(vert);
+            auto const distance = glm::dot(position - from, position - from);
+            if (distance > max_distance) {
+                max_distance = distance;
+                result = position;
+            }
+        }
+        return result;
+    };
+
+    auto const a = farthest(first);
+    auto const b = farthest(a);
+
+    result.center = (a + b) * 0.5f;
+    result.radius = glm::length(b - a) * 0.5f;
+
+    for (auto const& vert : vertices) {
+        auto const position = get_vertex_position(vert);
+        auto const distance = glm::length(position - result.center);
+        if (distance <= result.radius)
+            continue;
+
+        auto const radius = (result.radius + distance) * 0.5f;
+        result.center += (position - result.center) * ((radius - result.radius) / distance);
+        result.radius = radius;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Error quadric (symmetric 4x4 matrix + weight)
+ */
+struct quadric {
+    /**
+     * @brief Add a weighted plane to the quadric
+     *
+     * @param normal    Plane normal
+     * @param d         Plane distance
+     * @param weight    Weight of plane
+     */
+    void add_plane(v3 const& normal, r32 d, r32 weight) {
+        r64 const a = normal.x, b = normal.y, c = normal.z, w = weight;
+
+        m[0] += w * a * a;
+        m[1] += w * a * b;
+        m[2] += w * a * c;
+        m[3] += w * a * d;
+        m[4] += w * b * b;
+        m[5] += w * b * c;
+        m[6] += w * b * d;
+        m[7] += w * c * c;
+        m[8] += w * c * d;
+        m[9] += w * r64(d) * d;
+
+        total_weight += w;
+    }
+
+    /**
+     * @brief Add another quadric
+     *
+     * @param other    Quadric to add
+     */
+    void add(quadric const& other) {
+        for (auto i = 0u; i < m.size(); ++i)
+            m[i] += other.m[i];
+
+        total_weight += other.total_weight;
+    }
+
+    /**
+     * @brief Evaluate the squared distance error at position
+     *
+     * @param p       Position
+     *
+     * @return r64    Weighted squared error
+     */
+    r64 evaluate(v3 const& p) const {
+        r64 const x = p.x, y = p.y, z = p.z;
+
+        auto const result = m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x
+                            + m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y
+                            + m[7] * z * z + 2 * m[8] * z
+                            + m[9];
+
+        return total_weight > 0.0 ? std::max(result / total_weight, 0.0) : 0.0;
+    }
+
+    /// Upper triangle of the matrix
+    std::array<r64, 10> m = {};
+
+    /// Sum of plane weights
+    r64 total_weight = 0.0;
+};
+
+/**
+ * @brief Simplify an indexed triangle list by quadric edge collapse
+ *
+ * Vertices with equal positions are welded, the kept vertices are taken
+ * from the input so the result indexes into the same vertex list.
+ *
+ * @tparam T                    Vertex struct typename
+ *
+ * @param vertices              List of vertices
+ * @param indices               List of triangle indices
+ * @param target_index_count    Stop when reaching this index count
+ * @param target_error          Maximal object space error
+ * @param result_error          Reached object space error (optional)
+ *
+ * @return index_list           Simplified triangle indices
+ */
+template<typename T>
+index_list simplify_mesh(std::vector<T> const& vertices, index_list const& indices,
+                         size_t target_index_count, r32 target_error = std::numeric_limits<r32>::max(),
+                         r32* result_error = nullptr) {
+    if (result_error)
+        *result_error = 0.f;
+
+    auto const triangle_count = indices.size() / 3;
+    if (indices.size() <= target_index_count || triangle_count == 0)
+        return indices;
+
+    // weld vertices by position
+
+    struct position_hash {
+        size_t operator()(v3 const& p) const {
+            std::array<ui32, 3> bits;
+            for (auto i = 0u; i < 3; ++i) {
+                auto const value = p[i] + 0.f; // -0 == +0
+                memcpy(&bits[i], &value, sizeof(ui32));
+            }
+            return (size_t(bits[0]) * 73856093) ^ (size_t(bits[1]) * 19349663) ^ (size_t(bits[2]) * 83492791);
+        }
+    };
+
+    auto const vertex_count = vertices.size();
+    std::vector<v3> positions(vertex_count);
+    index_list weld(vertex_count);
+    index_list next_in_class(vertex_count, no_index);
+
+    std::unordered_map<v3, index, position_hash> position_map;
+    position_map.reserve(vertex_count);
+
+    for (auto i = 0u; i < vertex_count; ++i) {
+        positions[i] = get_vertex_position(vertices[i]);
+
+        auto [itr, inserted] = position_map.emplace(positions[i], i);
+        weld[i] = itr->second;
+
+        if (!inserted) {
+            next_in_class[i] = next_in_class[itr->second];
+            next_in_class[itr->second] = i;
+        }
+    }
+
+    // triangles in welded vertices
+
+    index_list triangles(triangle_count * 3);
+    for (auto i = 0u; i < triangles.size(); ++i)
+        triangles[i] = weld[indices[i]];
+
+    std::vector<bool> removed_triangle(triangle_count, false);
+    std::vector<index_list> adjacency(vertex_count);
+
+    auto live_triangles = triangle_count;
+    for (auto t = 0u; t < triangle_count; ++t) {
+        auto const a = triangles[t * 3], b = triangles[t * 3 + 1], c = triangles[t * 3 + 2];
+        if (a == b || b == c || c == a) {
+            removed_triangle[t] = true;
+            --live_triangles;
+            continue;
+        }
+
+        adjacency[a].push_back(t);
+        adjacency[b].push_back(t);
+        adjacency[c].push_back(t);
+    }
+
+    auto triangle_normal = [&](v3 const& a, v3 const& b, v3 const& c) {
+        return glm::cross(b - a, c - a);
+    };
+
+    // face and border quadrics
+
+    std::vector<quadric> quadrics(vertex_count);
+    std::unordered_map<ui64, ui32> edge_use;
+
+    auto edge_key = [](index a, index b) {
+        return a < b ? (ui64(a) << 32) | b : (ui64(b) << 32) | a;
+    };
+
+    for (auto t = 0u; t < triangle_count; ++t) {
+        if (removed_triangle[t])
+            continue;
+
+        for (auto e = 0u; e < 3; ++e)
+            ++edge_use[edge_key(triangles[t * 3 + e], triangles[t * 3 + (e + 1) % 3])];
+    }
+
+    for (auto t = 0u; t < triangle_count; ++t) {
+        if (removed_triangle[t])
+            continue;
+
+        auto const* tri = &triangles[t * 3];
+        auto const normal = triangle_normal(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+        auto const area = glm::length(normal);
+        if (area <= 0.f)
+            continue;
+
+        auto const n = normal / area;
+        for (auto k = 0u; k < 3; ++k)
+            quadrics[tri[k]].add_plane(n, -glm::dot(n, positions[tri[0]]), area * 0.5f);
+
+        for (auto e = 0u; e < 3; ++e) {
+            auto const a = tri[e], b = tri[(e + 1) % 3];
+            if (edge_use[edge_key(a, b)] != 1)
+                continue;
+
+            // keep open borders in place
+            auto const edge = positions[b] - positions[a];
+            auto const edge_length = glm::length(edge);
+            if (edge_length <= 0.f)
+                continue;
+
+            auto const border_normal = glm::normalize(glm::cross(edge, n));
+            auto const d = -glm::dot(border_normal, positions[a]);
+            auto const weight = edge_length * edge_length * 10.f;
+
+            quadrics[a].add_plane(border_normal, d, weight);
+            quadrics[b].add_plane(border_normal, d, weight);
+        }
+    }
+
+    // collapse queue
+
+    struct collapse {
+        r64 cost = 0.0;
+        index from = no_index;
+        index to = no_index;
+        ui32 from_version = 0;
+        ui32 to_version = 0;
+
+        bool operator>(collapse const& other) const {
+            return cost > other.cost;
+        }
+    };
+
+    std::priority_queue<collapse, std::vector<collapse>, std::greater<collapse>> queue;
+    index_list collapsed_to(vertex_count, no_index);
+    std::vector<ui32> version(vertex_count, 0);
+
+    auto push_edge = [&](index a, index b) {
+        quadric q = quadrics[a];
+        q.add(quadrics[b]);
+
+        auto const cost_ab = q.evaluate(positions[b]);
+        auto const cost_ba = q.evaluate(positions[a]);
+
+        if (cost_ab <= cost_ba)
+            queue.push({ cost_ab, a, b, version[a], version[b] });
+        else
+            queue.push({ cost_ba, b, a, version[b], version[a] });
+    };
+
+    for (auto const& [key, count] : edge_use) {
+        auto const a = index(key >> 32), b = index(key & 0xffffffff);
+        push_edge(a, b);
+    }
+
+    // earlier collapses may have removed the edge of a queued collapse
+
+    auto edge_exists = [&](index a, index b) {
+        for (auto t : adjacency[a]) {
+            if (removed_triangle[t])
+                continue;
+
+            auto const* tri = &triangles[t * 3];
+            if (tri[0] == b || tri[1] == b || tri[2] == b)
+                return true;
+        }
+
+        return false;
+    };
+
+    // collapsing a vertex must not flip any of the remaining triangles
+
+    auto collapse_flips = [&](index from, index to) {
+        for (auto t : adjacency[from]) {
+            if (removed_triangle[t])
+                continue;
+
+            auto const* tri = &triangles[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;
+
+            std::array<v3, 3> moved = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+            for (auto k = 0u; k < 3; ++k)
+                if (tri[k] == from)
+                    moved[k] = positions[to];
+
+            auto const before = triangle_normal(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+            auto const after = triangle_normal(moved[0], moved[1], moved[2]);
+            if (glm::dot(before, after) <= 0.f)
+                return true;
+        }
+
+        return false;
+    };
+
+    auto const max_cost = r64(target_error) * target_error;
+    auto const target_triangles = target_index_count / 3;
+    auto reached_cost = 0.0;
+
+    while (live_triangles > target_triangles && !queue.empty()) {
+        auto const top = queue.top();
+        queue.pop();
+
+        if (collapsed_to[top.from] != no_index || collapsed_to[top.to] != no_index)
+            continue;
+
+        if (!edge_exists(top.from, top.to))
+            continue;
+
+        if (top.from_version != version[top.from] || top.to_version != version[top.to]) {
+            push_edge(top.from, top.to);
+            continue;
+        }
+
+        if (top.cost > max_cost)
+            break;
+
+        if (collapse_flips(top.from, top.to))
+            continue;
+
+        for (auto t : adjacency[top.from]) {
+            if (removed_triangle[t])
+                continue;
+
+            auto* tri = &triangles[t * 3];
+            for (auto k = 0u; k < 3; ++k)
+                if (tri[k] == top.from)
+                    tri[k] = top.to;
+
+            if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+                removed_triangle[t] = true;
+                --live_triangles;
+            } else {
+                adjacency[top.to].push_back(t);
+            }
+        }
+
+        adjacency[top.from].clear();
+        quadrics[top.to].add(quadrics[top.from]);
+        collapsed_to[top.from] = top.to;
+        ++version[top.to];
+
+        reached_cost = std::max(reached_cost, top.cost);
+
+        // compact adjacency and queue the new neighbors
+        auto& list = adjacency[top.to];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](index t) { return removed_triangle[t]; }),
+                   list.end());
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+
+        for (auto t : list)
+            for (auto k = 0u; k < 3; ++k)
+                if (triangles[t * 3 + k] != top.to)
+                    push_edge(top.to, triangles[t * 3 + k]);
+    }
+
+    if (result_error)
+        *result_error = to_r32(std::sqrt(reached_cost));
+
+    // pick vertices of the welded class closest in attributes
+
+    auto attribute_distance = [&](index a, index b) {
+        auto result = 0.f;
+
+        if constexpr (requires(T const t) { t.normal; }) {
+            auto const& na = vertices[a].normal;
+            auto const& nb = vertices[b].normal;
+            for (auto i = 0u; i < 3; ++i)
+                result += std::abs(to_r32(na[i]) - to_r32(nb[i]));
+        }
+
+        if constexpr (requires(T const t) { t.uv; }) {
+            auto const& ua = vertices[a].uv;
+            auto const& ub = vertices[b].uv;
+            for (auto i = 0u; i < 2; ++i)
+                result += std::abs(to_r32(ua[i]) - to_r32(ub[i]));
+        }
+
+        return result;
+    };
+
+    auto pick_vertex = [&](index original, index welded) {
+        if (weld[original] == welded)
+            return original;
+
+        auto result = welded;
+        auto best = std::numeric_limits<r32>::max();
+        for (auto v = welded; v != no_index; v = next_in_class[v]) {
+            auto const distance = attribute_distance(original, v);
+            if (distance < best) {
+                best = distance;
+                result = v;
+            }
+        }
+
+        return result;
+    };
+
+    index_list result;
+    result.reserve(live_triangles * 3);
+
+    for (auto t = 0u; t < triangle_count; ++t) {
+        if (removed_triangle[t])
+            continue;
+
+        for (auto k = 0u; k < 3; ++k)
+            result.push_back(pick_vertex(indices[t * 3 + k], triangles[t * 3 + k]));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Generate LODs of mesh data
+ *
+ * The LOD index ranges are appended to the indices of the mesh data,
+ * all LODs share the same vertices. LOD 0 is the full detail mesh.
+ *
+ * @tparam T             Vertex struct typename
+ *
+ * @param data           Mesh data
+ * @param lod_count      Maximal number of LODs (including full detail)
+ * @param reduction      Index count ratio between successive LODs
+ * @param max_error      Maximal error relative to the mesh radius
+ *
+ * @return ui32          Number of generated LODs
+ */
+template<typename T>
+ui32 generate_lods(mesh_data<T>& data, ui32 lod_count, r32 reduction = 0.5f, r32 max_error = 0.05f) {
+    if (!data.lods.empty()) {
+        data.indices.resize(data.lods.front().index_count);
+        data.lods.clear();
+    }
+
+    if (data.indices.empty() || lod_count == 0)
+        return 0;
+
+    auto const radius = calculate_bounding_sphere(data.vertices).radius;
+
+    data.lods.push_back({ 0, to_ui32(data.indices.size()), 0.f });
+
+    index_list source = data.indices;
+
+    for (auto i = 1u; i < lod_count; ++i) {
+        auto const target_index_count = size_t(to_r32(source.size()) * reduction) / 3 * 3;
+        if (target_index_count < 3)
+            break;
+
+        auto error = 0.f;
+        auto lod_indices = simplify_mesh(data.vertices, source, target_index_count,
+                                         max_error * radius, &error);
+
+        if (lod_indices.empty() || lod_indices.size() >= source.size())
+            break;
+
+        mesh_lod lod;
+        lod.first_index = to_ui32(data.indices.size());
+        lod.index_count = to_ui32(lod_indices.size());
+        lod.error = data.lods.back().error + error;
+        data.lods.push_back(lod);
+
+        data.indices.insert(data.indices.end(), lod_indices.begin(), lod_indices.end());
+        source = std::move(lod_indices);
+    }
+
+    return to_ui32(data.lods.size());
+}
+
+/**
+ * @brief Select the LOD by projected screen size
+ *
+ * @param lods           List of LODs
+ * @param radius         Object space radius of mesh
+ * @param screen_size    Projected size (fraction of viewport height), see camera::get_screen_size
+ * @param threshold      Maximal error as fraction of viewport height
+ *
+ * @return index         Index of LOD
+ */
+inline index select_lod(mesh_lod::list const& lods, r32 radius, r32 screen_size,
+                        r32 threshold = 1.f / 1080.f) {
+    if (lods.empty() || radius <= 0.f)
+        return 0;
+
+    auto result = 0u;
+    for (auto i = 1u; i < lods.size(); ++i) {
+        auto const projected_error = lods[i].error / radius * screen_size * 0.5f;
+        if (projected_error > threshold)
+            break;
+
+        result = i;
+    }
+
+    return result;
+}
+
+} // namespace lava
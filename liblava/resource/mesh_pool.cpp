@@ -0,0 +1,82 @@
+/**
+ * @file         liblava/resource/mesh_pool.cpp
+ * @brief        Shared vertex and index buffers for many meshes
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/mesh_pool.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+void range_allocator::reset(ui32 c, ui32 used) {
+    capacity = c;
+    used = std::min(used, capacity);
+
+    free_ranges.clear();
+    if (used < capacity)
+        free_ranges.emplace(used, capacity - used);
+
+    free_count = capacity - used;
+}
+
+//-----------------------------------------------------------------------------
+bool range_allocator::allocate(ui32 count, ui32& offset) {
+    if (count == 0 || count > free_count)
+        return false;
+
+    for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it) {
+        auto const [range_offset, range_count] = *it;
+        if (range_count < count)
+            continue;
+
+        free_ranges.erase(it);
+        if (range_count > count)
+            free_ranges.emplace(range_offset + count, range_count - count);
+
+        free_count -= count;
+        offset = range_offset;
+        return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+void range_allocator::free(ui32 offset, ui32 count) {
+    if (count == 0)
+        return;
+
+    free_count += count;
+
+    auto next = free_ranges.lower_bound(offset);
+
+    // merge with following range
+    if (next != free_ranges.end() && offset + count == next->first) {
+        count += next->second;
+        next = free_ranges.erase(next);
+    }
+
+    // merge with previous range
+    if (next != free_ranges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += count;
+            return;
+        }
+    }
+
+    free_ranges.emplace(offset, count);
+}
+
+//-----------------------------------------------------------------------------
+ui32 range_allocator::get_largest_free() const {
+    ui32 result = 0;
+    for (auto const& [offset, count] : free_ranges)
+        result = std::max(result, count);
+
+    return result;
+}
+
+} // namespace lava
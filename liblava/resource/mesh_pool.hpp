@@ -0,0 +1,536 @@
+/**
+ * @file         liblava/resource/mesh_pool.hpp
+ * @brief        Shared vertex and index buffers for many meshes
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/mesh.hpp>
+
+namespace lava {
+
+/**
+ * @brief Free list of element ranges (first fit, merged on free)
+ */
+struct range_allocator {
+    /**
+     * @brief Reset the allocator
+     *
+     * @param capacity    Number of elements
+     * @param used        Number of used elements at the front
+     */
+    void reset(ui32 capacity, ui32 used = 0);
+
+    /**
+     * @brief Allocate a range
+     *
+     * @param count     Number of elements
+     * @param offset    First element of range
+     *
+     * @return true     Range allocated
+     * @return false    No free range is big enough
+     */
+    bool allocate(ui32 count, ui32& offset);
+
+    /**
+     * @brief Free a range
+     *
+     * @param offset    First element of range
+     * @param count     Number of elements
+     */
+    void free(ui32 offset, ui32 count);
+
+    /**
+     * @brief Get the capacity
+     *
+     * @return ui32    Number of elements
+     */
+    ui32 get_capacity() const {
+        return capacity;
+    }
+
+    /**
+     * @brief Get the number of free elements
+     *
+     * @return ui32    Number of free elements
+     */
+    ui32 get_free_count() const {
+        return free_count;
+    }
+
+    /**
+     * @brief Get the size of the largest free range
+     *
+     * @return ui32    Number of elements
+     */
+    ui32 get_largest_free() const;
+
+    /**
+     * @brief Get the number of free ranges
+     *
+     * @return size_t    Number of free ranges (1: not fragmented)
+     */
+    size_t get_free_range_count() const {
+        return free_ranges.size();
+    }
+
+private:
+    /// Free ranges (first element, number of elements)
+    std::map<ui32, ui32> free_ranges;
+
+    /// Number of elements
+    ui32 capacity = 0;
+
+    /// Number of free elements
+    ui32 free_count = 0;
+};
+
+/**
+ * @brief Mesh in a mesh pool
+ */
+struct pool_mesh {
+    /// First vertex in pool
+    ui32 vertex_offset = 0;
+
+    /// Number of vertices
+    ui32 vertex_count = 0;
+
+    /// First index in pool
+    ui32 first_index = 0;
+
+    /// Number of indices
+    ui32 index_count = 0;
+
+    /// List of LODs (first index in pool)
+    mesh_lod::list lods;
+};
+
+/**
+ * @brief Mesh pool
+ *
+ * Vertices and indices of many meshes are suballocated from one vertex and one index buffer,
+ * so the whole pool binds once. Indices are relative to the vertex offset of the mesh.
+ *
+ * @tparam T    Vertex struct
+ */
+template<typename T = vertex>
+struct mesh_pool_template : entity {
+    /// Shared pointer to mesh pool
+    using ptr = std::shared_ptr<mesh_pool_template<T>>;
+
+    /**
+     * @brief Destroy the mesh pool
+     */
+    ~mesh_pool_template() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new mesh pool
+     *
+     * @param device            Vulkan device
+     * @param vertex_capacity   Max number of vertices
+     * @param index_capacity    Max number of indices
+     *
+     * @return true             Create was successful
+     * @return false            Create failed
+     */
+    bool create(device_ptr device, ui32 vertex_capacity, ui32 index_capacity);
+
+    /**
+     * @brief Destroy the mesh pool
+     */
+    void destroy();
+
+    /**
+     * @brief Add a mesh (uploaded by a transfer copy)
+     *
+     * With a staging the copy is recorded in the next staging pass instead of waiting for it.
+     *
+     * @param data       Mesh data
+     * @param staging    Staging to copy the mesh (optional)
+     *
+     * @return id        Mesh id (invalid: no space, see compact)
+     */
+    id add(mesh_data<T> const& data, staging* staging = nullptr);
+
+    /**
+     * @brief Remove a mesh
+     *
+     * @param mesh    Mesh id
+     */
+    void remove(id::ref mesh);
+
+    /**
+     * @brief Check if a mesh is in the pool
+     *
+     * @param mesh      Mesh id
+     *
+     * @return true     Mesh found
+     * @return false    Mesh not found
+     */
+    bool has(id::ref mesh) const {
+        return meshes.count(mesh);
+    }
+
+    /**
+     * @brief Get a mesh
+     *
+     * @param mesh                Mesh id
+     *
+     * @return pool_mesh const&   Mesh ranges in pool
+     */
+    pool_mesh const& get(id::ref mesh) const {
+        return meshes.at(mesh);
+    }
+
+    /**
+     * @brief Bind the vertex and index buffer of the pool
+     *
+     * @param cmd_buf    Command buffer
+     */
+    void bind(VkCommandBuffer cmd_buf) const;
+
+    /**
+     * @brief Draw a mesh of the pool (pool must be bound)
+     *
+     * @param cmd_buf           Command buffer
+     * @param mesh              Mesh id
+     * @param lod               Index of LOD (clamped to available LODs)
+     * @param instance_count    Number of instances
+     * @param first_instance    First instance
+     */
+    void draw(VkCommandBuffer cmd_buf, id::ref mesh, index lod = 0,
+              ui32 instance_count = 1, ui32 first_instance = 0) const;
+
+    /**
+     * @brief Get the indirect draw command of a mesh
+     *
+     * @param mesh                            Mesh id
+     * @param lod                             Index of LOD (clamped to available LODs)
+     *
+     * @return VkDrawIndexedIndirectCommand   Draw command (one instance)
+     */
+    VkDrawIndexedIndirectCommand get_draw_command(id::ref mesh, index lod = 0) const;
+
+    /**
+     * @brief Move all meshes to the front of the buffers (removes fragmentation)
+     *
+     * The buffers are replaced, call when the GPU does not use the pool (e.g. after wait for idle).
+     *
+     * @return true     Compact was successful
+     * @return false    Compact failed
+     */
+    bool compact();
+
+    /**
+     * @brief Get the vertex allocator
+     *
+     * @return range_allocator const&    Vertex ranges
+     */
+    range_allocator const& get_vertex_ranges() const {
+        return vertex_ranges;
+    }
+
+    /**
+     * @brief Get the index allocator
+     *
+     * @return range_allocator const&    Index ranges
+     */
+    range_allocator const& get_index_ranges() const {
+        return index_ranges;
+    }
+
+    /**
+     * @brief Get the number of meshes
+     *
+     * @return size_t    Number of meshes
+     */
+    size_t get_mesh_count() const {
+        return meshes.size();
+    }
+
+    /**
+     * @brief Get the vertex buffer
+     *
+     * @return buffer::ptr    Shared pointer to buffer
+     */
+    buffer::ptr get_vertex_buffer() const {
+        return vertex_buffer;
+    }
+
+    /**
+     * @brief Get the index buffer
+     *
+     * @return buffer::ptr    Shared pointer to buffer
+     */
+    buffer::ptr get_index_buffer() const {
+        return index_buffer;
+    }
+
+private:
+    /**
+     * @brief Create the pool buffers
+     *
+     * @param vertices    Target vertex buffer
+     * @param indices     Target index buffer
+     *
+     * @return true       Create was successful
+     * @return false      Create failed
+     */
+    bool create_buffers(buffer::ptr& vertices, buffer::ptr& indices) const;
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Vertex buffer
+    buffer::ptr vertex_buffer;
+
+    /// Index buffer
+    buffer::ptr index_buffer;
+
+    /// Vertex allocator
+    range_allocator vertex_ranges;
+
+    /// Index allocator
+    range_allocator index_ranges;
+
+    /// Meshes in pool
+    std::map<id, pool_mesh> meshes;
+};
+
+/// Mesh pool with default vertex
+using mesh_pool = mesh_pool_template<vertex>;
+
+/**
+ * @brief Make a new mesh pool
+ *
+ * @tparam T                Type of vertex struct
+ *
+ * @return mesh_pool::ptr   Shared pointer to mesh pool
+ */
+template<typename T = vertex>
+inline typename mesh_pool_template<T>::ptr make_mesh_pool() {
+    return std::make_shared<mesh_pool_template<T>>();
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+bool mesh_pool_template<T>::create_buffers(buffer::ptr& vertices, buffer::ptr& indices) const {
+    // transfer source for compaction
+    VkBufferUsageFlags const transfer_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    vertices = make_buffer();
+    if (!vertices->create(device, nullptr, sizeof(T) * size_t(vertex_ranges.get_capacity()),
+                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | transfer_usage)) {
+        log()->error("create mesh pool vertex buffer");
+        return false;
+    }
+
+    indices = make_buffer();
+    if (!indices->create(device, nullptr, sizeof(ui32) * size_t(index_ranges.get_capacity()),
+                         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | transfer_usage)) {
+        log()->error("create mesh pool index buffer");
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+bool mesh_pool_template<T>::create(device_ptr d, ui32 vertex_capacity, ui32 index_capacity) {
+    device = d;
+
+    vertex_ranges.reset(std::max(vertex_capacity, 1u));
+    index_ranges.reset(std::max(index_capacity, 1u));
+
+    return create_buffers(vertex_buffer, index_buffer);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_pool_template<T>::destroy() {
+    meshes.clear();
+
+    vertex_buffer = nullptr;
+    index_buffer = nullptr;
+
+    vertex_ranges.reset(0);
+    index_ranges.reset(0);
+
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+id mesh_pool_template<T>::add(mesh_data<T> const& data, staging* staging) {
+    if (!device || data.vertices.empty())
+        return undef_id;
+
+    pool_mesh mesh;
+    mesh.vertex_count = to_ui32(data.vertices.size());
+    mesh.index_count = to_ui32(data.indices.size());
+
+    if (!vertex_ranges.allocate(mesh.vertex_count, mesh.vertex_offset))
+        return undef_id;
+
+    if (mesh.index_count > 0 && !index_ranges.allocate(mesh.index_count, mesh.first_index)) {
+        vertex_ranges.free(mesh.vertex_offset, mesh.vertex_count);
+        return undef_id;
+    }
+
+    buffer_upload::list uploads;
+    uploads.push_back({ vertex_buffer, data.vertices.data(), sizeof(T) * data.vertices.size(),
+                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(T) * VkDeviceSize(mesh.vertex_offset) });
+
+    if (mesh.index_count > 0)
+        uploads.push_back({ index_buffer, data.indices.data(), sizeof(ui32) * data.indices.size(),
+                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(ui32) * VkDeviceSize(mesh.first_index) });
+
+    auto uploaded = true;
+    if (staging) {
+        for (auto const& upload : uploads)
+            uploaded = uploaded && staging->add(upload);
+    } else {
+        uploaded = upload_buffers(device, uploads);
+    }
+
+    if (!uploaded) {
+        vertex_ranges.free(mesh.vertex_offset, mesh.vertex_count);
+        if (mesh.index_count > 0)
+            index_ranges.free(mesh.first_index, mesh.index_count);
+
+        return undef_id;
+    }
+
+    for (auto lod : data.lods) {
+        lod.first_index += mesh.first_index;
+        mesh.lods.push_back(lod);
+    }
+
+    auto const result = ids::next();
+    meshes.emplace(result, mesh);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_pool_template<T>::remove(id::ref mesh) {
+    auto const it = meshes.find(mesh);
+    if (it == meshes.end())
+        return;
+
+    auto const& range = it->second;
+    vertex_ranges.free(range.vertex_offset, range.vertex_count);
+    if (range.index_count > 0)
+        index_ranges.free(range.first_index, range.index_count);
+
+    meshes.erase(it);
+    ids::free(mesh);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_pool_template<T>::bind(VkCommandBuffer cmd_buf) const {
+    if (!vertex_buffer || !index_buffer)
+        return;
+
+    VkDeviceSize const buffer_offset = 0;
+    VkBuffer const buffer = vertex_buffer->get();
+
+    vkCmdBindVertexBuffers(cmd_buf, 0, 1, &buffer, &buffer_offset);
+    vkCmdBindIndexBuffer(cmd_buf, index_buffer->get(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+VkDrawIndexedIndirectCommand mesh_pool_template<T>::get_draw_command(id::ref mesh, index lod) const {
+    auto const& range = meshes.at(mesh);
+
+    VkDrawIndexedIndirectCommand result{
+        .indexCount = range.index_count,
+        .instanceCount = 1,
+        .firstIndex = range.first_index,
+        .vertexOffset = i32(range.vertex_offset),
+        .firstInstance = 0,
+    };
+
+    if (!range.lods.empty()) {
+        auto const& lod_range = range.lods.at(std::min(lod, to_ui32(range.lods.size()) - 1));
+        result.indexCount = lod_range.index_count;
+        result.firstIndex = lod_range.first_index;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+void mesh_pool_template<T>::draw(VkCommandBuffer cmd_buf, id::ref mesh, index lod,
+                                 ui32 instance_count, ui32 first_instance) const {
+    auto const& range = meshes.at(mesh);
+
+    if (range.index_count == 0) {
+        vkCmdDraw(cmd_buf, range.vertex_count, instance_count, range.vertex_offset, first_instance);
+        return;
+    }
+
+    auto const command = get_draw_command(mesh, lod);
+    vkCmdDrawIndexed(cmd_buf, command.indexCount, instance_count, command.firstIndex,
+                     command.vertexOffset, first_instance);
+}
+
+//-----------------------------------------------------------------------------
+template<typename T>
+bool mesh_pool_template<T>::compact() {
+    buffer::ptr vertices;
+    buffer::ptr indices;
+    if (!create_buffers(vertices, indices))
+        return false;
+
+    buffer_copy vertex_copy{ vertex_buffer, vertices, {}, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT };
+    buffer_copy index_copy{ index_buffer, indices, {}, VK_BUFFER_USAGE_INDEX_BUFFER_BIT };
+
+    auto compacted = meshes;
+
+    ui32 vertex_offset = 0;
+    ui32 index_offset = 0;
+
+    for (auto& [mesh_id, mesh] : compacted) {
+        vertex_copy.regions.push_back({ sizeof(T) * VkDeviceSize(mesh.vertex_offset),
+                                        sizeof(T) * VkDeviceSize(vertex_offset),
+                                        sizeof(T) * VkDeviceSize(mesh.vertex_count) });
+        mesh.vertex_offset = vertex_offset;
+        vertex_offset += mesh.vertex_count;
+
+        if (mesh.index_count == 0)
+            continue;
+
+        index_copy.regions.push_back({ sizeof(ui32) * VkDeviceSize(mesh.first_index),
+                                       sizeof(ui32) * VkDeviceSize(index_offset),
+                                       sizeof(ui32) * VkDeviceSize(mesh.index_count) });
+
+        for (auto& lod : mesh.lods)
+            lod.first_index = lod.first_index - mesh.first_index + index_offset;
+
+        mesh.first_index = index_offset;
+        index_offset += mesh.index_count;
+    }
+
+    if (!copy_buffers(device, { vertex_copy, index_copy }))
+        return false;
+
+    vertex_buffer = vertices;
+    index_buffer = indices;
+    meshes = compacted;
+
+    vertex_ranges.reset(vertex_ranges.get_capacity(), vertex_offset);
+    index_ranges.reset(index_ranges.get_capacity(), index_offset);
+
+    return true;
+}
+
+} // namespace lava
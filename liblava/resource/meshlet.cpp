@@ -0,0 +1,145 @@
+/**
+ * @file         liblava/resource/meshlet.cpp
+ * @brief        Meshlet builder and cluster culling data
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/meshlet.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+void calculate_meshlet_bounds(meshlet_data& data, std::vector<v3> const& positions) {
+    auto const& meshlet = data.meshlets.back();
+
+    auto const sphere = calculate_bounding_sphere(positions);
+    data.spheres.push_back(v4(sphere.center, sphere.radius));
+
+    std::vector<v3> normals;
+    normals.reserve(meshlet.triangle_count);
+
+    for (auto t = 0u; t < meshlet.triangle_count; ++t) {
+        auto const packed = data.triangles[meshlet.triangle_offset + t];
+
+        auto const& a = positions[packed & 0xff];
+        auto const& b = positions[(packed >> 8) & 0xff];
+        auto const& c = positions[(packed >> 16) & 0xff];
+
+        auto const normal = glm::cross(b - a, c - a);
+        auto const area = glm::length(normal);
+        if (area > 0.f)
+            normals.push_back(normal / area);
+    }
+
+    v3 axis(0.f);
+    for (auto const& normal : normals)
+        axis += normal;
+
+    auto const axis_length = glm::length(axis);
+    if (normals.empty() || axis_length <= 0.f) {
+        // degenerate cone, never culled
+        data.cones.push_back(v4(0.f, 0.f, 0.f, 1.f));
+        data.cone_apices.push_back(v4(sphere.center, 0.f));
+        return;
+    }
+
+    axis /= axis_length;
+
+    auto min_dot = 1.f;
+    for (auto const& normal : normals)
+        min_dot = std::min(min_dot, glm::dot(axis, normal));
+
+    if (min_dot <= 0.1f) {
+        // cone is too wide for a useful test
+        data.cones.push_back(v4(axis, 1.f));
+        data.cone_apices.push_back(v4(sphere.center, 0.f));
+        return;
+    }
+
+    // move apex back so that all triangle planes are in front of it
+    auto max_t = 0.f;
+    for (auto t = 0u, n = 0u; t < meshlet.triangle_count; ++t) {
+        auto const packed = data.triangles[meshlet.triangle_offset + t];
+
+        auto const& a = positions[packed & 0xff];
+        auto const& b = positions[(packed >> 8) & 0xff];
+        auto const& c = positions[(packed >> 16) & 0xff];
+
+        if (glm::length(glm::cross(b - a, c - a)) <= 0.f)
+            continue;
+
+        auto const& normal = normals[n++];
+        auto const distance = glm::dot(sphere.center - a, normal);
+        auto const denominator = glm::dot(axis, normal);
+
+        max_t = std::max(max_t, distance / denominator);
+    }
+
+    auto const cutoff = std::sqrt(1.f - min_dot * min_dot);
+
+    data.cones.push_back(v4(axis, cutoff));
+    data.cone_apices.push_back(v4(sphere.center - axis * max_t, 0.f));
+}
+
+//-----------------------------------------------------------------------------
+bool meshlet_cone_culled(meshlet_data const& data, index meshlet_index, v3 const& position) {
+    auto const& cone = data.cones.at(meshlet_index);
+    if (cone.w >= 1.f)
+        return false;
+
+    auto const& apex = data.cone_apices.at(meshlet_index);
+    auto const direction = v3(apex.x, apex.y, apex.z) - position;
+    auto const distance = glm::length(direction);
+    if (distance <= 0.f)
+        return false;
+
+    return glm::dot(direction / distance, v3(cone.x, cone.y, cone.z)) >= cone.w;
+}
+
+//-----------------------------------------------------------------------------
+bool meshlet_buffers::create(device_ptr device, meshlet_data const& data, VmaMemoryUsage memory_usage) {
+    count = data.count();
+    if (count == 0)
+        return false;
+
+    auto create_buffer = [&](meshlet_binding binding, void const* buffer_data, size_t size) {
+        auto& result = buffers.at(to_ui32(binding));
+        result = make_buffer();
+
+        if (!result->create(device, buffer_data, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                            false, memory_usage)) {
+            log()->error("create meshlet buffer {}", to_ui32(binding));
+            return false;
+        }
+
+        return true;
+    };
+
+    if (!create_buffer(meshlet_binding::meshlets, data.meshlets.data(), sizeof(meshlet) * data.meshlets.size()))
+        return false;
+
+    if (!create_buffer(meshlet_binding::vertices, data.vertices.data(), sizeof(index) * data.vertices.size()))
+        return false;
+
+    if (!create_buffer(meshlet_binding::triangles, data.triangles.data(), sizeof(ui32) * data.triangles.size()))
+        return false;
+
+    if (!create_buffer(meshlet_binding::spheres, data.spheres.data(), sizeof(v4) * data.spheres.size()))
+        return false;
+
+    if (!create_buffer(meshlet_binding::cones, data.cones.data(), sizeof(v4) * data.cones.size()))
+        return false;
+
+    return create_buffer(meshlet_binding::cone_apices, data.cone_apices.data(), sizeof(v4) * data.cone_apices.size());
+}
+
+//-----------------------------------------------------------------------------
+void meshlet_buffers::destroy() {
+    for (auto& buffer : buffers)
+        buffer = nullptr;
+
+    count = 0;
+}
+
+} // namespace lava
@@ -0,0 +1,358 @@
+/**
+ * @file         liblava/resource/meshlet.hpp
+ * @brief        Meshlet builder and cluster culling data
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/mesh_lod.hpp>
+
+namespace lava {
+
+/// Maximal number of vertices per meshlet
+constexpr ui32 const meshlet_max_vertices = 64;
+
+/// Maximal number of triangles per meshlet
+constexpr ui32 const meshlet_max_triangles = 124;
+
+/**
+ * @brief Meshlet (std430 layout)
+ */
+struct meshlet {
+    /// List of meshlets
+    using list = std::vector<meshlet>;
+
+    /// First entry in meshlet vertices
+    ui32 vertex_offset = 0;
+
+    /// First entry in meshlet triangles
+    ui32 triangle_offset = 0;
+
+    /// Number of vertices
+    ui32 vertex_count = 0;
+
+    /// Number of triangles
+    ui32 triangle_count = 0;
+};
+
+/**
+ * @brief Meshlet data in structure of arrays
+ */
+struct meshlet_data {
+    /// List of meshlets
+    meshlet::list meshlets;
+
+    /// Meshlet vertices (index into mesh vertices)
+    index_list vertices;
+
+    /// Meshlet triangles (3 local vertex indices packed in 8 bits each)
+    std::vector<ui32> triangles;
+
+    /// Bounding spheres (xyz: center, w: radius)
+    std::vector<v4> spheres;
+
+    /// Normal cones (xyz: axis, w: cutoff)
+    std::vector<v4> cones;
+
+    /// Cone apices (xyz: apex)
+    std::vector<v4> cone_apices;
+
+    /**
+     * @brief Get the number of meshlets
+     *
+     * @return ui32    Number of meshlets
+     */
+    ui32 count() const {
+        return to_ui32(meshlets.size());
+    }
+
+    /**
+     * @brief Clear the meshlet data
+     */
+    void clear() {
+        meshlets.clear();
+        vertices.clear();
+        triangles.clear();
+        spheres.clear();
+        cones.clear();
+        cone_apices.clear();
+    }
+};
+
+/**
+ * @brief Pack a meshlet triangle
+ *
+ * @param a        First local vertex index
+ * @param b        Second local vertex index
+ * @param c        Third local vertex index
+ *
+ * @return ui32    Packed triangle
+ */
+inline ui32 pack_meshlet_triangle(ui32 a, ui32 b, ui32 c) {
+    return a | (b << 8) | (c << 16);
+}
+
+/**
+ * @brief Calculate bounds and normal cone of the last meshlet
+ *
+ * @param data         Meshlet data
+ * @param positions    Positions of the meshlet vertices
+ */
+void calculate_meshlet_bounds(meshlet_data& data, std::vector<v3> const& positions);
+
+/**
+ * @brief Check if a meshlet is back facing for the viewer
+ *
+ * @param data             Meshlet data
+ * @param meshlet_index    Index of meshlet
+ * @param position         Viewer position (same space as mesh)
+ *
+ * @return true            All triangles are back facing
+ * @return false           Meshlet may be visible
+ */
+bool meshlet_cone_culled(meshlet_data const& data, index meshlet_index, v3 const& position);
+
+/**
+ * @brief Build meshlets from mesh data
+ *
+ * Uses the full detail LOD if the mesh data has LODs.
+ *
+ * @tparam T                Vertex struct typename
+ *
+ * @param data              Mesh data
+ * @param max_vertices      Maximal vertices per meshlet (up to 256)
+ * @param max_triangles     Maximal triangles per meshlet
+ *
+ * @return meshlet_data     Meshlet data
+ */
+template<typename T>
+meshlet_data build_meshlets(mesh_data<T> const& data,
+                            ui32 max_vertices = meshlet_max_vertices,
+                            ui32 max_triangles = meshlet_max_triangles) {
+    meshlet_data result;
+
+    auto const index_count = data.lods.empty() ? data.indices.size() : data.lods.front().index_count;
+    auto const triangle_count = to_ui32(index_count / 3);
+    auto const vertex_count = to_ui32(data.vertices.size());
+
+    max_vertices = std::clamp(max_vertices, 3u, 256u);
+    max_triangles = std::max(max_triangles, 1u);
+
+    if (triangle_count == 0)
+        return result;
+
+    auto const& indices = data.indices;
+
+    // vertex to triangle adjacency
+    index_list adjacency_offsets(vertex_count + 1, 0);
+    for (auto i = 0u; i < triangle_count * 3; ++i)
+        ++adjacency_offsets[indices[i] + 1];
+
+    for (auto v = 0u; v < vertex_count; ++v)
+        adjacency_offsets[v + 1] += adjacency_offsets[v];
+
+    index_list adjacency(triangle_count * 3);
+    {
+        auto fill = adjacency_offsets;
+        for (auto i = 0u; i < triangle_count * 3; ++i)
+            adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<bool> used_triangle(triangle_count, false);
+    index_list local_index(vertex_count, no_index);
+    std::vector<v3> positions;
+
+    meshlet current;
+
+    auto new_vertex_count = [&](index triangle) {
+        auto result = 0u;
+        for (auto k = 0u; k < 3; ++k)
+            if (local_index[indices[triangle * 3 + k]] == no_index)
+                ++result;
+        return result;
+    };
+
+    auto finish_meshlet = [&]() {
+        if (current.triangle_count == 0)
+            return;
+
+        positions.clear();
+        for (auto i = 0u; i < current.vertex_count; ++i) {
+            auto const vertex = result.vertices[current.vertex_offset + i];
+            positions.push_back(get_vertex_position(data.vertices[vertex]));
+            local_index[vertex] = no_index;
+        }
+
+        result.meshlets.push_back(current);
+        calculate_meshlet_bounds(result, positions);
+
+        current = {};
+        current.vertex_offset = to_ui32(result.vertices.size());
+        current.triangle_offset = to_ui32(result.triangles.size());
+    };
+
+    auto add_triangle = [&](index triangle) {
+        if (current.vertex_count + new_vertex_count(triangle) > max_vertices
+            || current.triangle_count + 1 > max_triangles)
+            finish_meshlet();
+
+        std::array<ui32, 3> local;
+        for (auto k = 0u; k < 3; ++k) {
+            auto const vertex = indices[triangle * 3 + k];
+            if (local_index[vertex] == no_index) {
+                local_index[vertex] = current.vertex_count++;
+                result.vertices.push_back(vertex);
+            }
+
+            local[k] = local_index[vertex];
+        }
+
+        result.triangles.push_back(pack_meshlet_triangle(local[0], local[1], local[2]));
+        ++current.triangle_count;
+        used_triangle[triangle] = true;
+    };
+
+    // grow meshlets greedily over neighbor triangles sharing the most vertices
+
+    auto next_unused = 0u;
+    while (true) {
+        while (next_unused < triangle_count && used_triangle[next_unused])
+            ++next_unused;
+
+        if (next_unused == triangle_count)
+            break;
+
+        add_triangle(next_unused);
+
+        while (true) {
+            auto best = no_index;
+            auto best_new = 4u;
+
+            for (auto i = 0u; i < current.vertex_count && best_new > 0; ++i) {
+                auto const vertex = result.vertices[current.vertex_offset + i];
+
+                for (auto a = adjacency_offsets[vertex]; a < adjacency_offsets[vertex + 1]; ++a) {
+                    auto const triangle = adjacency[a];
+                    if (used_triangle[triangle])
+                        continue;
+
+                    auto const count = new_vertex_count(triangle);
+                    if (count < best_new) {
+                        best_new = count;
+                        best = triangle;
+
+                        if (count == 0)
+                            break;
+                    }
+                }
+            }
+
+            if (best == no_index)
+                break;
+
+            add_triangle(best);
+        }
+    }
+
+    finish_meshlet();
+
+    return result;
+}
+
+/**
+ * @brief Meshlet storage buffer bindings
+ */
+enum class meshlet_binding : index {
+    meshlets = 0,
+    vertices,
+    triangles,
+    spheres,
+    cones,
+    cone_apices,
+    count
+};
+
+/**
+ * @brief Meshlet storage buffers for compute culling passes
+ */
+struct meshlet_buffers : entity {
+    /// Shared pointer to meshlet buffers
+    using ptr = std::shared_ptr<meshlet_buffers>;
+
+    /**
+     * @brief Destroy the meshlet buffers
+     */
+    ~meshlet_buffers() {
+        destroy();
+    }
+
+    /**
+     * @brief Create storage buffers from meshlet data
+     *
+     * @param device          Vulkan device
+     * @param data            Meshlet data
+     * @param memory_usage    Memory usage
+     *
+     * @return true           Create was successful
+     * @return false          Create failed
+     */
+    bool create(device_ptr device, meshlet_data const& data,
+                VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+    /**
+     * @brief Destroy the meshlet buffers
+     */
+    void destroy();
+
+    /**
+     * @brief Get the buffer of a binding
+     *
+     * @param binding         Meshlet binding
+     *
+     * @return buffer::ptr    Shared pointer to buffer
+     */
+    buffer::ptr get(meshlet_binding binding) const {
+        return buffers.at(to_ui32(binding));
+    }
+
+    /**
+     * @brief Get the descriptor buffer info of a binding
+     *
+     * @param binding                           Meshlet binding
+     *
+     * @return VkDescriptorBufferInfo const*    Descriptor buffer info
+     */
+    VkDescriptorBufferInfo const* get_descriptor_info(meshlet_binding binding) const {
+        auto const& buffer = get(binding);
+        return buffer ? buffer->get_descriptor_info() : nullptr;
+    }
+
+    /**
+     * @brief Get the number of meshlets
+     *
+     * @return ui32    Number of meshlets
+     */
+    ui32 get_count() const {
+        return count;
+    }
+
+private:
+    /// Storage buffers
+    std::array<buffer::ptr, size_t(meshlet_binding::count)> buffers;
+
+    /// Number of meshlets
+    ui32 count = 0;
+};
+
+/**
+ * @brief Make new meshlet buffers
+ *
+ * @return meshlet_buffers::ptr    Shared pointer to meshlet buffers
+ */
+inline meshlet_buffers::ptr make_meshlet_buffers() {
+    return std::make_shared<meshlet_buffers>();
+}
+
+} // namespace lava
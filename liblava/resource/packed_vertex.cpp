@@ -0,0 +1,91 @@
+/**
+ * @file         liblava/resource/packed_vertex.cpp
+ * @brief        Quantized vertex format
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <glm/gtc/packing.hpp>
+#include <liblava/resource/packed_vertex.hpp>
+
+namespace lava {
+
+/**
+ * @brief Get the sign of a value (zero is positive)
+ *
+ * @param value    Value
+ *
+ * @return v2      Sign per component (-1 or 1)
+ */
+v2 sign_not_zero(v2 value) {
+    return { value.x >= 0.f ? 1.f : -1.f, value.y >= 0.f ? 1.f : -1.f };
+}
+
+//-----------------------------------------------------------------------------
+v2 encode_octahedral(v3 normal) {
+    auto const length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length == 0.f)
+        return v2(0.f);
+
+    auto result = v2(normal.x, normal.y) / length;
+
+    // lower hemisphere is folded over the diagonals
+    if (normal.z < 0.f)
+        result = (1.f - glm::abs(v2(result.y, result.x))) * sign_not_zero(result);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+v3 decode_octahedral(v2 value) {
+    v3 result(value.x, value.y, 1.f - std::abs(value.x) - std::abs(value.y));
+
+    if (result.z < 0.f) {
+        auto const folded = (1.f - glm::abs(v2(result.y, result.x))) * sign_not_zero(v2(result.x, result.y));
+        result.x = folded.x;
+        result.y = folded.y;
+    }
+
+    return glm::normalize(result);
+}
+
+//-----------------------------------------------------------------------------
+packed_vertex pack_vertex(v3 position, v4 color, v2 uv, v3 normal,
+                          vertex_dequantization const& dequantization) {
+    packed_vertex result;
+
+    auto const normalized = glm::clamp((position - dequantization.offset) / dequantization.scale, v3(-1.f), v3(1.f));
+
+    auto const packed_position = glm::packSnorm4x16(v4(normalized, 0.f));
+    memcpy(result.position.data(), &packed_position, sizeof(result.position));
+
+    auto const packed_normal = glm::packSnorm2x16(encode_octahedral(normal));
+    memcpy(result.normal.data(), &packed_normal, sizeof(result.normal));
+
+    auto const packed_color = glm::packUnorm4x8(glm::clamp(color, v4(0.f), v4(1.f)));
+    memcpy(result.color.data(), &packed_color, sizeof(result.color));
+
+    auto const packed_uv = glm::packHalf2x16(uv);
+    memcpy(result.uv.data(), &packed_uv, sizeof(result.uv));
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+v3 get_position(packed_vertex const& vertex, vertex_dequantization const& dequantization) {
+    ui64 packed_position = 0;
+    memcpy(&packed_position, vertex.position.data(), sizeof(vertex.position));
+
+    auto const normalized = v3(glm::unpackSnorm4x16(packed_position));
+    return dequantization.offset + normalized * dequantization.scale;
+}
+
+//-----------------------------------------------------------------------------
+v3 get_normal(packed_vertex const& vertex) {
+    ui32 packed_normal = 0;
+    memcpy(&packed_normal, vertex.normal.data(), sizeof(vertex.normal));
+
+    return decode_octahedral(glm::unpackSnorm2x16(packed_normal));
+}
+
+} // namespace lava
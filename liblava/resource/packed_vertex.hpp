@@ -0,0 +1,179 @@
+/**
+ * @file         liblava/resource/packed_vertex.hpp
+ * @brief        Quantized vertex format
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/mesh.hpp>
+
+namespace lava {
+
+/**
+ * @brief Packed vertex (20 bytes)
+ *
+ * Position is normalized to the mesh bounds, normal is octahedral encoded.
+ */
+struct packed_vertex {
+    /// List of packed vertices
+    using list = std::vector<packed_vertex>;
+
+    /// Position in mesh bounds (snorm16, w: 0)
+    std::array<i16, 4> position = {};
+
+    /// Octahedral normal (snorm16)
+    std::array<i16, 2> normal = {};
+
+    /// Color (unorm8)
+    std::array<ui8, 4> color = {};
+
+    /// Uv (half float)
+    std::array<ui16, 2> uv = {};
+
+    /**
+     * @brief Get the vertex attributes
+     *
+     * @return vertex_attribute_info::list    Attributes with packed formats
+     */
+    static vertex_attribute_info::list get_attributes() {
+        return {
+            { vertex_attribute::position, to_ui32(offsetof(packed_vertex, position)),
+              to_ui32(sizeof(position)), VK_FORMAT_R16G16B16A16_SNORM },
+            { vertex_attribute::color, to_ui32(offsetof(packed_vertex, color)),
+              to_ui32(sizeof(color)), VK_FORMAT_R8G8B8A8_UNORM },
+            { vertex_attribute::uv, to_ui32(offsetof(packed_vertex, uv)),
+              to_ui32(sizeof(uv)), VK_FORMAT_R16G16_SFLOAT },
+            { vertex_attribute::normal, to_ui32(offsetof(packed_vertex, normal)),
+              to_ui32(sizeof(normal)), VK_FORMAT_R16G16_SNORM },
+        };
+    }
+};
+
+/**
+ * @brief Dequantization of packed positions
+ *
+ * position = offset + scale * packed position (shader: push constant or uniform)
+ */
+struct vertex_dequantization {
+    /// Center of mesh bounds
+    v3 offset = v3(0.f);
+
+    /// Half extent of mesh bounds
+    v3 scale = v3(1.f);
+};
+
+/**
+ * @brief Packed mesh data
+ */
+struct packed_mesh_data {
+    /// Mesh data with packed vertices
+    mesh_data<packed_vertex> data;
+
+    /// Position dequantization
+    vertex_dequantization dequantization;
+};
+
+/**
+ * @brief Encode a normal with octahedral mapping
+ *
+ * @param normal    Unit normal
+ *
+ * @return v2       Octahedral coordinates in [-1, 1]
+ */
+v2 encode_octahedral(v3 normal);
+
+/**
+ * @brief Decode an octahedral normal
+ *
+ * @param value    Octahedral coordinates in [-1, 1]
+ *
+ * @return v3      Unit normal
+ */
+v3 decode_octahedral(v2 value);
+
+/**
+ * @brief Pack a vertex
+ *
+ * @param position          Vertex position
+ * @param color             Vertex color
+ * @param uv                Vertex uv
+ * @param normal            Vertex normal
+ * @param dequantization    Position dequantization of mesh
+ *
+ * @return packed_vertex    Packed vertex
+ */
+packed_vertex pack_vertex(v3 position, v4 color, v2 uv, v3 normal,
+                          vertex_dequantization const& dequantization);
+
+/**
+ * @brief Get the dequantized position of a packed vertex
+ *
+ * @param vertex            Packed vertex
+ * @param dequantization    Position dequantization of mesh
+ *
+ * @return v3               Vertex position
+ */
+v3 get_position(packed_vertex const& vertex, vertex_dequantization const& dequantization);
+
+/**
+ * @brief Get the normal of a packed vertex
+ *
+ * @param vertex    Packed vertex
+ *
+ * @return v3       Unit normal
+ */
+v3 get_normal(packed_vertex const& vertex);
+
+/**
+ * @brief Pack mesh data (quantized positions, octahedral normals, RGBA8 colors and half uvs)
+ *
+ * @tparam T                    Vertex struct (missing color: white, missing normal: +z)
+ *
+ * @param data                  Mesh data to pack
+ *
+ * @return packed_mesh_data     Packed mesh data with position dequantization
+ */
+template<typename T = vertex>
+packed_mesh_data pack_mesh(mesh_data<T> const& data) {
+    packed_mesh_data result;
+    result.data.indices = data.indices;
+    result.data.lods = data.lods;
+
+    if (data.vertices.empty())
+        return result;
+
+    v3 min = data.vertices.front().position;
+    v3 max = min;
+    for (auto const& vertex : data.vertices) {
+        min = glm::min(min, v3(vertex.position));
+        max = glm::max(max, v3(vertex.position));
+    }
+
+    // flat bounds keep a scale to avoid a division by zero
+    result.dequantization.offset = (min + max) * 0.5f;
+    result.dequantization.scale = glm::max((max - min) * 0.5f, v3(1e-6f));
+
+    result.data.vertices.reserve(data.vertices.size());
+
+    for (auto const& vertex : data.vertices) {
+        auto color = v4(1.f);
+        auto uv = v2(0.f);
+        auto normal = v3(0.f, 0.f, 1.f);
+
+        if constexpr (requires(T const t) { t.color; })
+            color = v4(vertex.color);
+        if constexpr (requires(T const t) { t.uv; })
+            uv = v2(vertex.uv);
+        if constexpr (requires(T const t) { t.normal; })
+            normal = v3(vertex.normal);
+
+        result.data.vertices.push_back(pack_vertex(v3(vertex.position), color, uv, normal,
+                                                   result.dequantization));
+    }
+
+    return result;
+}
+
+} // namespace lava
@@ -7,11 +7,12 @@
 
 #include <liblava/resource/format.hpp>
 #include <liblava/resource/texture.hpp>
+#include <numeric>
 
 namespace lava {
 
 //-----------------------------------------------------------------------------
-bool texture::create(device_ptr device, uv2 size, VkFormat format, layer::list const& l, texture_type t) {
+bool texture::create(device_ptr device, uv2 size, VkFormat format, layer::list const& l, texture_type t, bool mip_levels) {
     layers = l;
     type = t;
 
@@ -25,11 +26,32 @@ bool texture::create(device_ptr device, uv2 size, VkFormat format, layer::list c
         layers.push_back(layer);
     }
 
+    auto level_count = to_ui32(layers.front().levels.size());
+
+    mip_levels_generation = false;
+    mip_filter = VK_FILTER_LINEAR;
+
+    if (mip_levels && level_count == 1) {
+        auto const physical_device = device->get_vk_physical_device();
+
+        if (format_blit_supported(physical_device, format)) {
+            mip_levels_generation = true;
+        } else if (format_blit_supported(physical_device, format, false)) {
+            mip_levels_generation = true;
+            mip_filter = VK_FILTER_NEAREST;
+        } else {
+            log()->warn("texture format does not support blit, skip mip levels generation");
+        }
+
+        if (mip_levels_generation)
+            level_count = get_mip_level_count(size);
+    }
+
     VkSamplerAddressMode sampler_address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     if (type == texture_type::array || type == texture_type::cube_map)
         sampler_address_mode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
 
-    VkSamplerCreateInfo sampler_info{
+    sampler_info = {
         .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
         .magFilter = VK_FILTER_LINEAR,
         .minFilter = VK_FILTER_LINEAR,
@@ -43,12 +65,13 @@ bool texture::create(device_ptr device, uv2 size, VkFormat format, layer::list c
         .compareEnable = VK_FALSE,
         .compareOp = VK_COMPARE_OP_NEVER,
         .minLod = 0.f,
-        .maxLod = to_r32(layers.front().levels.size()),
+        .maxLod = to_r32(level_count),
         .borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
         .unnormalizedCoordinates = VK_FALSE,
     };
 
-    if (!device->vkCreateSampler(&sampler_info, &sampler)) {
+    sampler = device->get_sampler_cache().acquire(sampler_info);
+    if (!sampler) {
         log()->error("create texture sampler");
         return false;
     }
@@ -69,11 +92,14 @@ bool texture::create(device_ptr device, uv2 size, VkFormat format, layer::list c
     img->set_layer_count(to_ui32(layers.size()));
     img->set_view_type(view_type);
 
-    if (!img->create(device, size, VMA_MEMORY_USAGE_GPU_ONLY)) {
+    if (!img->create(device, size, VMA_MEMORY_USAGE_GPU_ONLY, mip_levels_generation)) {
         log()->error("create texture image");
         return false;
     }
 
+    stream_data.clear();
+    resident_level = 0;
+
     descriptor.sampler = sampler;
     descriptor.imageView = img->get_view();
     descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -85,10 +111,16 @@ bool texture::create(device_ptr device, uv2 size, VkFormat format, layer::list c
 void texture::destroy() {
     destroy_upload_buffer();
 
+    while (!stream_releases.empty())
+        release_stream(stream_releases.begin()->first);
+
+    stream_data.clear();
+    resident_level = 0;
+
     if (sampler) {
         if (img)
             if (auto device = img->get_device())
-                device->vkDestroySampler(sampler);
+                device->get_sampler_cache().release(sampler);
 
         sampler = VK_NULL_HANDLE;
     }
@@ -101,19 +133,78 @@ void texture::destroy() {
 
 //-----------------------------------------------------------------------------
 void texture::destroy_upload_buffer() {
-    upload_buffer = nullptr;
+    release_upload(upload_memory);
 }
 
 //-----------------------------------------------------------------------------
 bool texture::upload(void const* data, size_t data_size) {
-    upload_buffer = make_buffer();
+    release_upload(upload_memory);
+
+    upload_memory = allocate_upload(img->get_device(), data_size, get_upload_alignment());
+    if (!upload_memory.valid())
+        return false;
+
+    if (data) {
+        memcpy(upload_memory.data, data, data_size);
+        upload_memory.flush();
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool texture::upload_stream(void const* data, size_t data_size, ui32 tail_size) {
+    auto const level_count = to_ui32(layers.front().levels.size());
+    if (mip_levels_generation || level_count < 2)
+        return upload(data, data_size);
+
+    if (data_size != get_level_size(0, level_count)) {
+        log()->error("stream texture data size");
+        return false;
+    }
+
+    auto tail_level = level_count - 1;
+    while (tail_level > 0) {
+        auto const extent = layers.front().levels[tail_level - 1].extent;
+        if (std::max(extent.x, extent.y) > tail_size)
+            break;
+
+        --tail_level;
+    }
 
-    return upload_buffer->create(img->get_device(), data, data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, false, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    if (tail_level == 0)
+        return upload(data, data_size);
+
+    stream_data.assign((char const*) data, (char const*) data + data_size);
+
+    upload_memory = create_level_buffer(tail_level, level_count);
+    if (!upload_memory.valid()) {
+        stream_data.clear();
+        return false;
+    }
+
+    // texture is not in use yet
+    img->get_device()->get_sampler_cache().release(sampler);
+    sampler = VK_NULL_HANDLE;
+
+    resident_level = tail_level;
+
+    return create_sampler(to_r32(resident_level));
 }
 
 //-----------------------------------------------------------------------------
 bool texture::stage(VkCommandBuffer cmd_buf) {
-    if (!upload_buffer || !upload_buffer->valid()) {
+    if (!stage_copy(cmd_buf))
+        return false;
+
+    stage_finish(cmd_buf);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool texture::stage_copy(VkCommandBuffer cmd_buf) {
+    if (!upload_memory.valid()) {
         log()->error("stage texture");
         return false;
     }
@@ -121,7 +212,7 @@ bool texture::stage(VkCommandBuffer cmd_buf) {
     VkImageSubresourceRange subresource_range{
         .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
         .baseMipLevel = 0,
-        .levelCount = to_ui32(layers.front().levels.size()),
+        .levelCount = get_level_count(),
         .baseArrayLayer = 0,
         .layerCount = to_ui32(layers.size()),
     };
@@ -131,10 +222,16 @@ bool texture::stage(VkCommandBuffer cmd_buf) {
     set_image_layout(device, cmd_buf, img->get(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_range,
                      VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
+    if (!stream_data.empty()) {
+        // tail levels only, the other levels are not sampled until streamed (min LOD)
+        copy_levels(cmd_buf, upload_memory, resident_level, get_level_count());
+        return true;
+    }
+
     std::vector<VkBufferImageCopy> regions;
 
     if (to_ui32(layers.front().levels.size()) > 1) {
-        auto offset = 0u;
+        auto offset = upload_memory.offset;
 
         for (auto layer = 0u; layer < layers.size(); ++layer) {
             for (auto level = 0u; level < to_ui32(layers.front().levels.size()); ++level) {
@@ -173,7 +270,7 @@ bool texture::stage(VkCommandBuffer cmd_buf) {
         auto size = img->get_size();
 
         VkBufferImageCopy region{
-            .bufferOffset = 0,
+            .bufferOffset = upload_memory.offset,
             .bufferRowLength = size.x,
             .bufferImageHeight = size.y,
             .imageSubresource = subresource_layers,
@@ -184,16 +281,328 @@ bool texture::stage(VkCommandBuffer cmd_buf) {
         regions.push_back(region);
     }
 
-    device->call().vkCmdCopyBufferToImage(cmd_buf, upload_buffer->get(), img->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    device->call().vkCmdCopyBufferToImage(cmd_buf, upload_memory.buffer->get(), img->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                           to_ui32(regions.size()), regions.data());
 
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void texture::stage_finish(VkCommandBuffer cmd_buf) {
+    if (mip_levels_generation && stream_data.empty()) {
+        blit_mip_levels(cmd_buf, img, mip_filter);
+        return;
+    }
+
+    VkImageSubresourceRange const subresource_range{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = get_level_count(),
+        .baseArrayLayer = 0,
+        .layerCount = to_ui32(layers.size()),
+    };
+
+    auto device = img->get_device();
+
     set_image_layout(device, cmd_buf, img->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresource_range,
                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
+//-----------------------------------------------------------------------------
+size_t texture::stream(VkCommandBuffer cmd_buf, index frame, size_t budget, bool force) {
+    release_stream(frame);
+
+    if (stream_data.empty() || resident_level == 0)
+        return 0;
+
+    auto first_level = resident_level;
+    size_t size = 0;
+
+    while (first_level > 0) {
+        auto const level_size = get_level_size(first_level - 1, first_level);
+        if (size + level_size > budget && !(force && size == 0))
+            break;
+
+        size += level_size;
+        --first_level;
+    }
+
+    if (first_level == resident_level)
+        return 0;
+
+    auto upload_levels = create_level_buffer(first_level, resident_level);
+    if (!upload_levels.valid())
+        return 0;
+
+    VkImageSubresourceRange const subresource_range{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = first_level,
+        .levelCount = resident_level - first_level,
+        .baseArrayLayer = 0,
+        .layerCount = to_ui32(layers.size()),
+    };
+
+    auto device = img->get_device();
+
+    // levels above the resident level are not sampled, their content can be discarded
+    set_image_layout(device, cmd_buf, img->get(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_range,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    copy_levels(cmd_buf, upload_levels, first_level, resident_level);
 
+    set_image_layout(device, cmd_buf, img->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresource_range,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    auto& release = stream_releases[frame];
+    release.upload = upload_levels;
+
+    auto const previous_sampler = sampler;
+
+    if (create_sampler(to_r32(first_level))) {
+        release.sampler = previous_sampler;
+        resident_level = first_level;
+    } else {
+        sampler = previous_sampler;
+        descriptor.sampler = sampler;
+    }
+
+    if (resident_level == 0)
+        std::vector<char>().swap(stream_data);
+
+    if (on_resident)
+        on_resident(resident_level);
+
+    return size;
+}
+
+//-----------------------------------------------------------------------------
+bool texture::create_sampler(r32 min_lod) {
+    sampler_info.minLod = min_lod;
+
+    sampler = img->get_device()->get_sampler_cache().acquire(sampler_info);
+    if (!sampler) {
+        log()->error("create texture sampler");
+        return false;
+    }
+
+    descriptor.sampler = sampler;
     return true;
 }
 
+//-----------------------------------------------------------------------------
+bool texture::set_sampler_info(VkSamplerCreateInfo const& info) {
+    if (!img)
+        return false;
+
+    auto const previous_info = sampler_info;
+    auto const previous_sampler = sampler;
+
+    sampler_info = info;
+    if (!create_sampler(to_r32(resident_level))) {
+        sampler_info = previous_info;
+        sampler = previous_sampler;
+        descriptor.sampler = sampler;
+        return false;
+    }
+
+    img->get_device()->get_sampler_cache().release(previous_sampler);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+size_t texture::get_level_size(ui32 first_level, ui32 last_level) const {
+    size_t result = 0;
+
+    for (auto const& layer : layers)
+        for (auto level = first_level; level < last_level; ++level)
+            result += layer.levels[level].size;
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+upload_allocation texture::create_level_buffer(ui32 first_level, ui32 last_level) const {
+    auto result = allocate_upload(img->get_device(), get_level_size(first_level, last_level), get_upload_alignment());
+    if (!result.valid()) {
+        log()->error("create texture level buffer");
+        return {};
+    }
+
+    // stream data is layer major, upload buffer is level major
+    auto* target = result.data;
+
+    for (auto level = first_level; level < last_level; ++level) {
+        size_t offset = 0;
+
+        for (auto const& layer : layers) {
+            for (auto m = 0u; m < layer.levels.size(); ++m) {
+                if (m == level) {
+                    memcpy(target, stream_data.data() + offset, layer.levels[m].size);
+                    target += layer.levels[m].size;
+                }
+
+                offset += layer.levels[m].size;
+            }
+        }
+    }
+
+    result.flush();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+VkDeviceSize texture::get_upload_alignment() const {
+    // buffer offsets of image copies need a multiple of the texel block size
+    return std::lcm(VkDeviceSize(16), VkDeviceSize(format_block_size(get_format())));
+}
+
+//-----------------------------------------------------------------------------
+void texture::copy_levels(VkCommandBuffer cmd_buf, upload_allocation const& upload_levels, ui32 first_level, ui32 last_level) const {
+    std::vector<VkBufferImageCopy> regions;
+
+    auto offset = upload_levels.offset;
+
+    for (auto level = first_level; level < last_level; ++level) {
+        for (auto layer = 0u; layer < layers.size(); ++layer) {
+            auto const& mip_level = layers[layer].levels[level];
+
+            VkBufferImageCopy region{
+                .bufferOffset = offset,
+                .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = level,
+                    .baseArrayLayer = layer,
+                    .layerCount = 1,
+                },
+                .imageExtent = { mip_level.extent.x, mip_level.extent.y, 1 },
+            };
+
+            regions.push_back(region);
+
+            offset += mip_level.size;
+        }
+    }
+
+    img->get_device()->call().vkCmdCopyBufferToImage(cmd_buf, upload_levels.buffer->get(), img->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                     to_ui32(regions.size()), regions.data());
+}
+
+//-----------------------------------------------------------------------------
+void texture::release_stream(index frame) {
+    if (!stream_releases.count(frame))
+        return;
+
+    auto& release = stream_releases.at(frame);
+
+    if (release.sampler)
+        img->get_device()->get_sampler_cache().release(release.sampler);
+
+    release_upload(release.upload);
+
+    stream_releases.erase(frame);
+}
+
+//-----------------------------------------------------------------------------
+bool staging::add(buffer_upload const& upload) {
+    if (upload.size == 0)
+        return false;
+
+    if (!(upload.buffer->get_usage() & VK_BUFFER_USAGE_TRANSFER_DST_BIT)) {
+        log()->error("staging - buffer without transfer destination usage");
+        return false;
+    }
+
+    staged_buffer item;
+    item.buffer = upload.buffer;
+    item.usage = upload.usage;
+    item.offset = upload.offset;
+
+    item.memory = allocate_upload(upload.buffer->get_device(), upload.size);
+    if (!item.memory.valid())
+        return false;
+
+    if (upload.data)
+        memcpy(item.memory.data, upload.data, upload.size);
+
+    item.memory.flush();
+
+    buffer_todo.push_back(item);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void staging::clear() {
+    todo.clear();
+    staged.clear();
+    streaming.clear();
+
+    for (auto& item : buffer_todo)
+        release_upload(item.memory);
+
+    buffer_todo.clear();
+
+    for (auto& [frame, items] : buffer_staged)
+        for (auto& item : items)
+            release_upload(item.memory);
+
+    buffer_staged.clear();
+}
+
+//-----------------------------------------------------------------------------
+void staging::stage_buffers(VkCommandBuffer cmd_buf, index frame) {
+    if (buffer_staged.count(frame)) {
+        for (auto& item : buffer_staged.at(frame))
+            release_upload(item.memory);
+
+        buffer_staged.erase(frame);
+    }
+
+    if (buffer_todo.empty())
+        return;
+
+    auto device = buffer_todo.front().buffer->get_device();
+
+    std::vector<VkBufferMemoryBarrier> barriers;
+    VkPipelineStageFlags dst_stages = 0;
+
+    for (auto const& item : buffer_todo) {
+        VkBufferCopy const region{
+            .srcOffset = item.memory.offset,
+            .dstOffset = item.offset,
+            .size = item.memory.size,
+        };
+
+        device->call().vkCmdCopyBuffer(cmd_buf, item.memory.buffer->get(), item.buffer->get(), 1, &region);
+
+        barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = buffer::usage_to_possible_access(item.usage),
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = item.buffer->get(),
+            .offset = item.offset,
+            .size = item.memory.size,
+        });
+
+        dst_stages |= buffer::usage_to_possible_stages(item.usage);
+    }
+
+    device->call().vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                        dst_stages ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                        0, 0, nullptr, to_ui32(barriers.size()), barriers.data(), 0, nullptr);
+
+    // upload memory is released when the frame comes back
+    auto& items = buffer_staged[frame];
+    items.insert(items.end(), buffer_todo.begin(), buffer_todo.end());
+    buffer_todo.clear();
+}
+
 //-----------------------------------------------------------------------------
 bool staging::stage(VkCommandBuffer cmd_buf, index frame) {
     if (!staged.empty() && staged.count(frame) && !staged.at(frame).empty()) {
@@ -203,8 +612,11 @@ bool staging::stage(VkCommandBuffer cmd_buf, index frame) {
         staged.erase(frame);
     }
 
-    if (todo.empty())
-        return false;
+    auto const buffers = !buffer_todo.empty();
+    stage_buffers(cmd_buf, frame);
+
+    if (todo.empty() && streaming.empty())
+        return buffers;
 
     texture::list stage_done;
 
@@ -215,7 +627,7 @@ bool staging::stage(VkCommandBuffer cmd_buf, index frame) {
         stage_done.push_back(texture);
     }
 
-    if (!staged.count(frame))
+    if (!stage_done.empty() && !staged.count(frame))
         staged.emplace(frame, texture::list());
 
     for (auto& texture : stage_done) {
@@ -223,8 +635,27 @@ bool staging::stage(VkCommandBuffer cmd_buf, index frame) {
             staged.at(frame).push_back(texture);
 
         remove(todo, texture);
+
+        if (texture->streaming() && !contains(streaming, texture))
+            streaming.push_back(texture);
+    }
+
+    // first stream step of a frame may exceed the budget (large mip levels), no budget pauses streaming
+    auto budget = stream_budget;
+    auto first_step = stream_budget > 0;
+
+    for (auto& texture : streaming) {
+        auto const size = texture->stream(cmd_buf, frame, budget, first_step);
+        budget -= std::min(size, budget);
+
+        if (size > 0)
+            first_step = false;
     }
 
+    std::erase_if(streaming, [](texture::ptr const& texture) {
+        return !texture->streaming();
+    });
+
     return true;
 }
 
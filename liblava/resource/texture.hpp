@@ -7,8 +7,8 @@
 
 #pragma once
 
-#include <liblava/resource/buffer.hpp>
 #include <liblava/resource/image.hpp>
+#include <liblava/resource/upload_ring.hpp>
 
 namespace lava {
 
@@ -74,6 +74,9 @@ struct texture : entity {
         mip_level::list levels;
     };
 
+    /// Resident function (with most detailed resident mip level)
+    using resident_func = std::function<void(ui32)>;
+
     /**
      * @brief Destroy the texture
      */
@@ -84,17 +87,22 @@ struct texture : entity {
     /**
      * @brief Create a new texture
      * 
-     * @param device    Vulkan device
-     * @param size      Texture size
-     * @param format    Texture format
-     * @param layers    List of layers
-     * @param type      Texture type
+     * If mip levels generation is set and the layers have only one level,
+     * all mip levels are generated on the GPU when the texture is staged.
+     * 
+     * @param device                   Vulkan device
+     * @param size                     Texture size
+     * @param format                   Texture format
+     * @param layers                   List of layers
+     * @param type                     Texture type
+     * @param mip_levels_generation    Generate mip levels with a blit chain
      * 
-     * @return true     Create was successful
-     * @return false    Create failed
+     * @return true                    Create was successful
+     * @return false                   Create failed
      */
     bool create(device_ptr device, uv2 size, VkFormat format,
-                layer::list const& layers = {}, texture_type type = texture_type::tex_2d);
+                layer::list const& layers = {}, texture_type type = texture_type::tex_2d,
+                bool mip_levels_generation = false);
 
     /**
      * @brief Destroy the texture
@@ -112,6 +120,22 @@ struct texture : entity {
      */
     bool upload(void const* data, size_t data_size);
 
+    /**
+     * @brief Upload data to texture and stream the mip levels
+     * 
+     * Mip levels up to the tail size are staged at once, the other levels are
+     * streamed by the staging from the smallest to the largest one.
+     * The sampler min LOD tracks the resident mip levels.
+     * 
+     * @param data         Data to upload (all layers and mip levels)
+     * @param data_size    Size of data
+     * @param tail_size    Max extent of mip levels staged at once
+     * 
+     * @return true        Upload was successful
+     * @return false       Upload failed
+     */
+    bool upload_stream(void const* data, size_t data_size, ui32 tail_size = 128);
+
     /**
      * @brief Stage the texture
      * 
@@ -122,6 +146,61 @@ struct texture : entity {
      */
     bool stage(VkCommandBuffer cmd_buffer);
 
+    /**
+     * @brief Record the copy of the upload buffer (first part of stage)
+     * 
+     * The image is left in transfer destination layout, a transfer queue can record it.
+     * 
+     * @param cmd_buf    Command buffer
+     * 
+     * @return true      Copy was recorded
+     * @return false     No upload buffer
+     */
+    bool stage_copy(VkCommandBuffer cmd_buf);
+
+    /**
+     * @brief Record the transition to shader read layout or the mip levels generation
+     *        (second part of stage, graphics queue)
+     * 
+     * @param cmd_buf    Command buffer
+     */
+    void stage_finish(VkCommandBuffer cmd_buf);
+
+    /**
+     * @brief Stream the next mip levels (after stage)
+     * 
+     * The sampler is recreated with the new min LOD, descriptor sets using
+     * the texture need to be updated (see on_resident). Upload buffers and
+     * samplers of a previous step are released when the frame index comes back.
+     * 
+     * @param cmd_buf     Command buffer
+     * @param frame       Frame index
+     * @param budget      Max number of bytes to upload
+     * @param force       Upload at least one mip level (even over budget)
+     * 
+     * @return size_t     Number of uploaded bytes
+     */
+    size_t stream(VkCommandBuffer cmd_buf, index frame, size_t budget, bool force = false);
+
+    /**
+     * @brief Check if the texture is streaming
+     * 
+     * @return true     Mip levels or releases are pending
+     * @return false    Texture is resident
+     */
+    bool streaming() const {
+        return !stream_data.empty() || !stream_releases.empty();
+    }
+
+    /**
+     * @brief Get the most detailed resident mip level
+     * 
+     * @return ui32    Resident mip level (min LOD)
+     */
+    ui32 get_resident_level() const {
+        return resident_level;
+    }
+
     /**
      * @brief Destroy the upload buffer
      */
@@ -136,6 +215,35 @@ struct texture : entity {
         return &descriptor;
     }
 
+    /**
+     * @brief Update the descriptor image view (after the image was rebound)
+     */
+    void update_descriptor() {
+        descriptor.imageView = img ? img->get_view() : VK_NULL_HANDLE;
+    }
+
+    /**
+     * @brief Override the sampler of the texture (shared by the device sampler cache)
+     * 
+     * The min LOD is kept at the resident mip level. Descriptor sets using
+     * the texture need to be updated.
+     * 
+     * @param info      Sampler create information
+     * 
+     * @return true     Sampler was replaced
+     * @return false    Sampler create failed (previous sampler is kept)
+     */
+    bool set_sampler_info(VkSamplerCreateInfo const& info);
+
+    /**
+     * @brief Get the sampler create information
+     * 
+     * @return VkSamplerCreateInfo const&    Sampler create information
+     */
+    VkSamplerCreateInfo const& get_sampler_info() const {
+        return sampler_info;
+    }
+
     /**
      * @brief Get the image of the texture
      * 
@@ -172,7 +280,94 @@ struct texture : entity {
         return img ? img->get_format() : VK_FORMAT_UNDEFINED;
     }
 
+    /**
+     * @brief Get the number of mip levels of the texture
+     * 
+     * @return ui32    Number of mip levels
+     */
+    ui32 get_level_count() const {
+        return img ? img->get_info().mipLevels : 0;
+    }
+
+    /**
+     * @brief Check if mip levels are generated on the GPU
+     * 
+     * @return true     Mip levels are generated when staged
+     * @return false    Mip levels are uploaded
+     */
+    bool mip_levels_generated() const {
+        return mip_levels_generation;
+    }
+
+    /// Called on resident mip level changed
+    resident_func on_resident;
+
 private:
+    /**
+     * @brief Acquire the sampler from the device sampler cache
+     * 
+     * @param min_lod    Min LOD of sampler
+     * 
+     * @return true      Create was successful
+     * @return false     Create failed
+     */
+    bool create_sampler(r32 min_lod);
+
+    /**
+     * @brief Get the size of mip levels of all layers
+     * 
+     * @param first_level    First mip level
+     * @param last_level     Last mip level (exclusive)
+     * 
+     * @return size_t        Size of mip levels
+     */
+    size_t get_level_size(ui32 first_level, ui32 last_level) const;
+
+    /**
+     * @brief Create an upload buffer with mip levels of all layers from the stream data
+     * 
+     * @param first_level     First mip level
+     * @param last_level      Last mip level (exclusive)
+     * 
+     * @return upload_allocation    Upload memory (level major)
+     */
+    upload_allocation create_level_buffer(ui32 first_level, ui32 last_level) const;
+
+    /**
+     * @brief Copy mip levels of all layers from an upload buffer
+     * 
+     * @param cmd_buf          Command buffer
+     * @param upload_levels    Upload memory (see create_level_buffer)
+     * @param first_level      First mip level
+     * @param last_level       Last mip level (exclusive)
+     */
+    void copy_levels(VkCommandBuffer cmd_buf, upload_allocation const& upload_levels, ui32 first_level, ui32 last_level) const;
+
+    /**
+     * @brief Get the alignment of upload memory
+     * 
+     * @return VkDeviceSize    Offset alignment for buffer to image copies
+     */
+    VkDeviceSize get_upload_alignment() const;
+
+    /**
+     * @brief Release the resources of a previous stream step
+     * 
+     * @param frame    Frame index
+     */
+    void release_stream(index frame);
+
+    /**
+     * @brief Stream resources released with the frame
+     */
+    struct stream_release {
+        /// Upload memory
+        upload_allocation upload;
+
+        /// Previous sampler
+        VkSampler sampler = VK_NULL_HANDLE;
+    };
+
     /// Texture image
     image::ptr img;
 
@@ -182,14 +377,32 @@ private:
     /// List of layers
     layer::list layers;
 
-    /// Texture sampler
-    VkSampler sampler = 0;
+    /// Generate mip levels when staged
+    bool mip_levels_generation = false;
+
+    /// Mip levels generation filter
+    VkFilter mip_filter = VK_FILTER_LINEAR;
+
+    /// Texture sampler (owned by the device sampler cache)
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    /// Sampler create information
+    VkSamplerCreateInfo sampler_info = {};
 
     /// Descriptor image information
     VkDescriptorImageInfo descriptor = {};
 
-    /// Upload buffer
-    buffer::ptr upload_buffer;
+    /// Upload memory (upload ring of device or dedicated buffer)
+    upload_allocation upload_memory;
+
+    /// Data of streamed mip levels
+    std::vector<char> stream_data;
+
+    /// Most detailed resident mip level
+    ui32 resident_level = 0;
+
+    /// Map of stream releases by frame index
+    std::map<index, stream_release> stream_releases;
 };
 
 /**
@@ -203,6 +416,9 @@ inline texture::ptr make_texture() {
 
 /**
  * @brief Texture staging
+ * 
+ * Buffer uploads are copied in the same pass, the target buffers can be used
+ * by the commands recorded after the staging.
  */
 struct staging {
     /**
@@ -214,6 +430,18 @@ struct staging {
         todo.push_back(texture);
     }
 
+    /**
+     * @brief Add data to upload into a buffer
+     * 
+     * The data is copied into upload memory, released when the frame comes back.
+     * 
+     * @param upload    Buffer upload (target needs transfer destination usage)
+     * 
+     * @return true     Upload was added
+     * @return false    Empty upload or allocate upload memory failed
+     */
+    bool add(buffer_upload const& upload);
+
     /**
      * @brief Stage textures
      * 
@@ -228,10 +456,7 @@ struct staging {
     /**
      * @brief Clear staging
      */
-    void clear() {
-        todo.clear();
-        staged.clear();
-    }
+    void clear();
 
     /**
      * @brief Check if staging is busy
@@ -240,10 +465,57 @@ struct staging {
      * @return false    Staging is not busy
      */
     bool busy() const {
-        return !todo.empty() || !staged.empty();
+        return !todo.empty() || !staged.empty() || !streaming.empty()
+               || !buffer_todo.empty() || !buffer_staged.empty();
+    }
+
+    /**
+     * @brief Set the stream budget
+     * 
+     * @param budget    Bytes of streamed mip levels per frame (0: streaming paused)
+     */
+    void set_stream_budget(size_t budget) {
+        stream_budget = budget;
+    }
+
+    /**
+     * @brief Get the stream budget
+     * 
+     * @return size_t    Bytes of streamed mip levels per frame
+     */
+    size_t get_stream_budget() const {
+        return stream_budget;
     }
 
 private:
+    /**
+     * @brief Buffer upload in upload memory
+     */
+    struct staged_buffer {
+        /// List of staged buffers
+        using list = std::vector<staged_buffer>;
+
+        /// Target buffer
+        lava::buffer::ptr buffer;
+
+        /// Usage of target buffer
+        VkBufferUsageFlags usage = 0;
+
+        /// Offset in target buffer
+        VkDeviceSize offset = 0;
+
+        /// Upload memory
+        upload_allocation memory;
+    };
+
+    /**
+     * @brief Record the copies of the buffer uploads
+     * 
+     * @param cmd_buf    Command buffer
+     * @param frame      Frame index
+     */
+    void stage_buffers(VkCommandBuffer cmd_buf, index frame);
+
     /// List of textures to stage
     texture::list todo;
 
@@ -252,6 +524,18 @@ private:
 
     /// Map of staged textures
     frame_stage_map staged;
+
+    /// List of streaming textures
+    texture::list streaming;
+
+    /// List of buffer uploads to stage
+    staged_buffer::list buffer_todo;
+
+    /// Map of staged buffer uploads by frame index
+    std::map<index, staged_buffer::list> buffer_staged;
+
+    /// Bytes of streamed mip levels per frame
+    size_t stream_budget = 4 << 20;
 };
 
 /// Texture registry
@@ -0,0 +1,333 @@
+/**
+ * @file         liblava/resource/texture_atlas.cpp
+ * @brief        Pack small textures into an atlas or texture array
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/format.hpp>
+#include <liblava/resource/texture_atlas.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+void atlas_packer::reset(uv2 s) {
+    size = s;
+
+    skyline.clear();
+    skyline.push_back({ 0, 0, size.x });
+
+    used_area = 0;
+}
+
+//-----------------------------------------------------------------------------
+bool atlas_packer::fit(index node_index, uv2 rect_size, ui32& y) const {
+    auto const x = skyline[node_index].x;
+    if (x + rect_size.x > size.x)
+        return false;
+
+    y = skyline[node_index].y;
+
+    // segments cover the whole width, the loop ends inside the bin
+    i64 remaining = rect_size.x;
+    for (auto i = node_index; remaining > 0; ++i) {
+        y = std::max(y, skyline[i].y);
+        if (y + rect_size.y > size.y)
+            return false;
+
+        remaining -= skyline[i].width;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool atlas_packer::insert(uv2 rect_size, uv2& position) {
+    if (rect_size.x == 0 || rect_size.y == 0 || rect_size.x > size.x || rect_size.y > size.y)
+        return false;
+
+    auto best_index = no_index;
+    auto best_top = std::numeric_limits<ui32>::max();
+    auto best_width = std::numeric_limits<ui32>::max();
+
+    for (auto i = 0u; i < skyline.size(); ++i) {
+        ui32 y = 0;
+        if (!fit(i, rect_size, y))
+            continue;
+
+        auto const top = y + rect_size.y;
+        if (top < best_top || (top == best_top && skyline[i].width < best_width)) {
+            best_index = i;
+            best_top = top;
+            best_width = skyline[i].width;
+            position = { skyline[i].x, y };
+        }
+    }
+
+    if (best_index == no_index)
+        return false;
+
+    skyline.insert(skyline.begin() + best_index, { position.x, position.y + rect_size.y, rect_size.x });
+
+    // cut the segments below the new one
+    for (auto i = best_index + 1; i < skyline.size();) {
+        auto const& previous = skyline[i - 1];
+        auto const previous_end = previous.x + previous.width;
+        if (skyline[i].x >= previous_end)
+            break;
+
+        auto const shrink = previous_end - skyline[i].x;
+        if (skyline[i].width <= shrink) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        break;
+    }
+
+    // merge segments of same height
+    for (auto i = 0u; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+
+    used_area += ui64(rect_size.x) * rect_size.y;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+r32 atlas_packer::get_occupancy() const {
+    auto const area = ui64(size.x) * size.y;
+    return area > 0 ? r32(r64(used_area) / area) : 0.f;
+}
+
+//-----------------------------------------------------------------------------
+bool texture_atlas::create(device_ptr d, uv2 s, texture_type t, VkFormat f, ui32 p, ui32 layers, ui32 frames) {
+    if (format_block_size(f) != 4) {
+        log()->error("texture atlas format (RGBA8 only)");
+        return false;
+    }
+
+    if (t != texture_type::tex_2d && t != texture_type::array) {
+        log()->error("texture atlas type (tex_2d or array only)");
+        return false;
+    }
+
+    device = d;
+    page_size = s;
+    type = t;
+    format = f;
+    padding = p;
+    max_layers = type == texture_type::array ? std::max(layers, 1u) : 1;
+    frame_count = std::max(frames, 1u);
+
+    // largest power of two <= padding
+    alignment = 1;
+    while (alignment * 2 <= padding)
+        alignment *= 2;
+
+    pages.clear();
+    pixels.clear();
+    regions.clear();
+    lookup.clear();
+    changed = false;
+
+    return add_page();
+}
+
+//-----------------------------------------------------------------------------
+void texture_atlas::destroy() {
+    if (atlas) {
+        atlas->destroy();
+        atlas = nullptr;
+    }
+
+    for (auto& [updates, texture] : retired)
+        texture->destroy();
+
+    retired.clear();
+
+    pages.clear();
+    std::vector<ui8>().swap(pixels);
+    regions.clear();
+    lookup.clear();
+
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool texture_atlas::add_page() {
+    if (pages.size() >= max_layers)
+        return false;
+
+    atlas_packer packer;
+    packer.reset(page_size);
+    pages.push_back(packer);
+
+    pixels.resize(get_page_size() * pages.size());
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+index texture_atlas::add(file_format const& key, data_cptr data, uv2 size) {
+    if (auto const existing = get_index(key); existing != no_index)
+        return existing;
+
+    if (!data || size.x == 0 || size.y == 0)
+        return no_index;
+
+    // padded and aligned, positions stay aligned
+    auto const align = [&](ui32 value) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    };
+    uv2 const rect_size = { align(size.x + padding * 2), align(size.y + padding * 2) };
+    if (rect_size.x > page_size.x || rect_size.y > page_size.y) {
+        log()->warn("texture atlas image too large - {}", key.path);
+        return no_index;
+    }
+
+    uv2 position{};
+    auto layer = to_ui32(pages.size()) - 1;
+
+    // earlier pages first
+    auto placed = false;
+    for (auto i = 0u; i < pages.size() && !placed; ++i) {
+        if (pages[i].insert(rect_size, position)) {
+            layer = i;
+            placed = true;
+        }
+    }
+
+    if (!placed) {
+        if (!add_page() || !pages.back().insert(rect_size, position)) {
+            log()->warn("texture atlas full - {}", key.path);
+            return no_index;
+        }
+
+        layer = to_ui32(pages.size()) - 1;
+    }
+
+    auto const target = pixels.data() + get_page_size() * layer;
+    auto const row_size = size_t(page_size.x) * 4;
+    auto const source = (ui8 const*) data;
+
+    // copy rows with clamped edges into the padding
+    for (auto y = 0u; y < size.y + padding * 2; ++y) {
+        auto const source_y = std::min(y > padding ? y - padding : 0u, size.y - 1);
+        auto const source_row = source + size_t(source_y) * size.x * 4;
+        auto target_row = target + (position.y + y) * row_size + size_t(position.x) * 4;
+
+        for (auto x = 0u; x < padding; ++x)
+            memcpy(target_row + x * 4, source_row, 4);
+
+        memcpy(target_row + padding * 4, source_row, size_t(size.x) * 4);
+
+        for (auto x = 0u; x < padding; ++x)
+            memcpy(target_row + (padding + size.x + x) * 4, source_row + (size.x - 1) * 4, 4);
+    }
+
+    atlas_region region;
+    region.layer = layer;
+    region.position = position + uv2(padding);
+    region.size = size;
+    region.uv_offset = v2(region.position) / v2(page_size);
+    region.uv_scale = v2(size) / v2(page_size);
+
+    auto const result = to_ui32(regions.size());
+    regions.push_back(region);
+    lookup.emplace(std::make_pair(key.path, key.format), result);
+
+    changed = true;
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+bool texture_atlas::build() {
+    if (!device || pages.empty())
+        return false;
+
+    texture::layer::list layers(pages.size());
+    for (auto& layer : layers)
+        layer.levels.push_back({ page_size, to_ui32(get_page_size()) });
+
+    auto result = make_texture();
+    if (!result->create(device, page_size, format, layers, type, get_level_count() > 1)) {
+        log()->error("create texture atlas");
+        return false;
+    }
+
+    if (!result->upload(pixels.data(), pixels.size()))
+        return false;
+
+    // limit the sampler to the mip levels covered by the padding
+    auto sampler_info = result->get_sampler_info();
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.maxLod = to_r32(get_level_count() - 1);
+    if (!result->set_sampler_info(sampler_info))
+        return false;
+
+    // frames in flight may still read the old texture
+    if (atlas)
+        retired.emplace_back(frame_count, atlas);
+
+    atlas = result;
+    changed = false;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void texture_atlas::update() {
+    for (auto& [updates, texture] : retired)
+        --updates;
+
+    while (!retired.empty() && retired.front().first == 0) {
+        retired.front().second->destroy();
+        retired.pop_front();
+    }
+}
+
+//-----------------------------------------------------------------------------
+index texture_atlas::get_index(file_format const& key) const {
+    auto it = lookup.find(std::make_pair(key.path, key.format));
+    return it != lookup.end() ? it->second : no_index;
+}
+
+//-----------------------------------------------------------------------------
+atlas_region const* texture_atlas::find(file_format const& key) const {
+    auto const region_index = get_index(key);
+    return region_index != no_index ? &regions[region_index] : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<v4> texture_atlas::get_uv_table() const {
+    std::vector<v4> result;
+    result.reserve(regions.size());
+
+    for (auto const& region : regions)
+        result.emplace_back(region.uv_offset, region.uv_scale);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+ui32 texture_atlas::get_level_count() const {
+    auto result = 1u;
+    for (auto value = alignment; value > 1; value /= 2)
+        ++result;
+
+    return std::min(result, get_mip_level_count(page_size));
+}
+
+} // namespace lava
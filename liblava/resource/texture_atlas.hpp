@@ -0,0 +1,338 @@
+/**
+ * @file         liblava/resource/texture_atlas.hpp
+ * @brief        Pack small textures into an atlas or texture array
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <deque>
+#include <liblava/resource/texture.hpp>
+
+namespace lava {
+
+/**
+ * @brief Skyline bin packer (bottom left)
+ */
+struct atlas_packer {
+    /**
+     * @brief Reset the packer
+     *
+     * @param size    Size of the bin
+     */
+    void reset(uv2 size);
+
+    /**
+     * @brief Insert a rectangle
+     *
+     * @param rect_size    Size of rectangle
+     * @param position     Position of rectangle
+     *
+     * @return true        Insert was successful
+     * @return false       Rectangle does not fit
+     */
+    bool insert(uv2 rect_size, uv2& position);
+
+    /**
+     * @brief Get the occupancy
+     *
+     * @return r32    Used area / bin area
+     */
+    r32 get_occupancy() const;
+
+    /**
+     * @brief Get the size of the bin
+     *
+     * @return uv2    Bin size
+     */
+    uv2 get_size() const {
+        return size;
+    }
+
+private:
+    /**
+     * @brief Skyline segment
+     */
+    struct node {
+        /// Left edge
+        ui32 x = 0;
+
+        /// Height of skyline
+        ui32 y = 0;
+
+        /// Width of segment
+        ui32 width = 0;
+    };
+
+    /**
+     * @brief Check if a rectangle fits on top of a skyline segment
+     *
+     * @param node_index    First segment
+     * @param rect_size     Size of rectangle
+     * @param y             Resulting top of rectangle
+     *
+     * @return true         Rectangle fits
+     * @return false        Rectangle does not fit
+     */
+    bool fit(index node_index, uv2 rect_size, ui32& y) const;
+
+    /// Size of the bin
+    uv2 size = {};
+
+    /// Skyline segments (left to right)
+    std::vector<node> skyline;
+
+    /// Used area
+    ui64 used_area = 0;
+};
+
+/**
+ * @brief Region of a texture in the atlas
+ */
+struct atlas_region {
+    /// Layer of texture array (0: 2D atlas)
+    ui32 layer = 0;
+
+    /// Position in pixels (without padding)
+    uv2 position = {};
+
+    /// Size in pixels
+    uv2 size = {};
+
+    /// UV offset
+    v2 uv_offset = {};
+
+    /// UV scale
+    v2 uv_scale = {};
+
+    /**
+     * @brief Remap a texture UV into the atlas
+     *
+     * @param uv     Original UV (0 - 1)
+     *
+     * @return v2    Atlas UV
+     */
+    v2 remap(v2 uv) const {
+        return uv_offset + uv * uv_scale;
+    }
+};
+
+/**
+ * @brief Texture atlas
+ *
+ * RGBA8 images are packed into pages with a skyline packer. A 2D atlas has one page,
+ * an array atlas adds pages (layers) when a page is full. Each image is surrounded by
+ * a padding of clamped edge pixels and aligned to the padding, so mip levels up to
+ * log2(padding) do not bleed between images. Images can be added after build,
+ * build again to create the texture with all images.
+ */
+struct texture_atlas : entity {
+    /// Shared pointer to texture atlas
+    using ptr = std::shared_ptr<texture_atlas>;
+
+    /// List of regions
+    using region_list = std::vector<atlas_region>;
+
+    /**
+     * @brief Destroy the texture atlas
+     */
+    ~texture_atlas() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new texture atlas
+     *
+     * @param device        Vulkan device
+     * @param page_size     Size of atlas page
+     * @param type          Type of atlas (tex_2d or array)
+     * @param format        Texture format (RGBA8 UNORM or sRGB)
+     * @param padding       Padding around images in pixels
+     * @param max_layers    Max number of pages (array)
+     * @param frame_count   Number of frames in flight
+     *
+     * @return true         Create was successful
+     * @return false        Create failed
+     */
+    bool create(device_ptr device, uv2 page_size = { 2048, 2048 },
+                texture_type type = texture_type::tex_2d,
+                VkFormat format = VK_FORMAT_R8G8B8A8_SRGB,
+                ui32 padding = 4, ui32 max_layers = 16, ui32 frame_count = 3);
+
+    /**
+     * @brief Destroy the texture atlas
+     */
+    void destroy();
+
+    /**
+     * @brief Add an image
+     *
+     * @param key        File and format of image (lookup key)
+     * @param data       RGBA8 pixels
+     * @param size       Size of image
+     *
+     * @return index     Region index (no_index: image does not fit)
+     */
+    index add(file_format const& key, data_cptr data, uv2 size);
+
+    /**
+     * @brief Build the atlas texture with all images
+     *
+     * The previous texture is replaced, descriptor sets need to be updated
+     * and the texture needs to be staged. Frames in flight may still read the
+     * previous texture, it is released by update after the frame count.
+     *
+     * @return true     Build was successful
+     * @return false    Build failed
+     */
+    bool build();
+
+    /**
+     * @brief Release replaced textures (call once per frame)
+     */
+    void update();
+
+    /**
+     * @brief Find the region of an image
+     *
+     * @param key                     File and format of image
+     *
+     * @return atlas_region const*    Region (nullptr: not in atlas)
+     */
+    atlas_region const* find(file_format const& key) const;
+
+    /**
+     * @brief Get the region index of an image
+     *
+     * @param key       File and format of image
+     *
+     * @return index    Region index (no_index: not in atlas)
+     */
+    index get_index(file_format const& key) const;
+
+    /**
+     * @brief Get the regions
+     *
+     * @return region_list const&    List of regions (by region index)
+     */
+    region_list const& get_regions() const {
+        return regions;
+    }
+
+    /**
+     * @brief Get the UV remap table (for a shader buffer)
+     *
+     * @return std::vector<v4>    Offset (xy) and scale (zw) by region index
+     */
+    std::vector<v4> get_uv_table() const;
+
+    /**
+     * @brief Get the texture of the last build
+     *
+     * @return texture::ptr    Shared pointer to texture
+     */
+    texture::ptr get_texture() const {
+        return atlas;
+    }
+
+    /**
+     * @brief Check if images were added since the last build
+     *
+     * @return true     Build is needed
+     * @return false    Texture is up to date
+     */
+    bool dirty() const {
+        return changed;
+    }
+
+    /**
+     * @brief Get the number of pages
+     *
+     * @return ui32    Number of pages
+     */
+    ui32 get_layer_count() const {
+        return to_ui32(pages.size());
+    }
+
+    /**
+     * @brief Get the number of mip levels without bleeding
+     *
+     * @return ui32    Number of mip levels
+     */
+    ui32 get_level_count() const;
+
+private:
+    /**
+     * @brief Add a new page
+     *
+     * @return true     Page was added
+     * @return false    Max number of pages reached
+     */
+    bool add_page();
+
+    /**
+     * @brief Get the size of a page in bytes
+     *
+     * @return size_t    Page size
+     */
+    size_t get_page_size() const {
+        return size_t(page_size.x) * page_size.y * 4;
+    }
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Size of page
+    uv2 page_size = {};
+
+    /// Type of atlas
+    texture_type type = texture_type::tex_2d;
+
+    /// Texture format
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+
+    /// Padding around images
+    ui32 padding = 4;
+
+    /// Alignment of images (power of two)
+    ui32 alignment = 4;
+
+    /// Max number of pages
+    ui32 max_layers = 16;
+
+    /// Packer by page
+    std::vector<atlas_packer> pages;
+
+    /// RGBA8 pixels of all pages (layer major)
+    std::vector<ui8> pixels;
+
+    /// Regions by index
+    region_list regions;
+
+    /// Region index by file and format
+    std::map<std::pair<string, VkFormat>, index> lookup;
+
+    /// Atlas texture
+    texture::ptr atlas;
+
+    /// Replaced textures (remaining updates until release)
+    std::deque<std::pair<ui32, texture::ptr>> retired;
+
+    /// Number of frames in flight
+    ui32 frame_count = 3;
+
+    /// Images added since last build
+    bool changed = false;
+};
+
+/**
+ * @brief Make a new texture atlas
+ *
+ * @return texture_atlas::ptr    Shared pointer to texture atlas
+ */
+inline texture_atlas::ptr make_texture_atlas() {
+    return std::make_shared<texture_atlas>();
+}
+
+} // namespace lava
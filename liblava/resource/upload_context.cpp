@@ -0,0 +1,376 @@
+/**
+ * @file         liblava/resource/upload_context.cpp
+ * @brief        Uploads on a dedicated transfer queue
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/upload_context.hpp>
+
+namespace lava {
+
+//-----------------------------------------------------------------------------
+bool upload_context::create(device_ptr d, queue::ref graphics_queue) {
+    device = d;
+    graphics_family = graphics_queue.family;
+
+    if (!device->timeline_semaphore_enabled()) {
+        log()->error("upload context - timeline semaphores not enabled");
+        return false;
+    }
+
+    transfer_queue = {};
+
+    // dedicated transfer family first
+    for (auto& queue : device->get_transfer_queues()) {
+        if (queue.family == graphics_family)
+            continue;
+
+        if (!transfer_queue.valid() || !(queue.flags & VK_QUEUE_GRAPHICS_BIT))
+            transfer_queue = queue;
+    }
+
+    if (!transfer_queue.valid()) {
+        for (auto& queue : device->get_transfer_queues()) {
+            if (queue.vk_queue != graphics_queue.vk_queue) {
+                transfer_queue = queue;
+                break;
+            }
+        }
+    }
+
+    if (!transfer_queue.valid()) {
+        log()->error("upload context - no transfer queue (see add_dedicated_queues)");
+        return false;
+    }
+
+    if (!device->vkCreateCommandPool(transfer_queue.family, &pool))
+        return false;
+
+    VkSemaphoreTypeCreateInfoKHR const type_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo const create_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+    };
+
+    if (!device->vkCreateSemaphore(&create_info, &semaphore))
+        return false;
+
+    submitted_value = 0;
+
+    log()->debug("upload context - transfer queue family {} (graphics {})",
+                 transfer_queue.family, graphics_family);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void upload_context::destroy() {
+    if (!device)
+        return;
+
+    if (semaphore && submitted_value > 0) {
+        VkSemaphoreWaitInfoKHR const wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &submitted_value,
+        };
+
+        device->call().vkWaitSemaphoresKHR(device->get(), &wait_info, UINT64_MAX);
+    }
+
+    while (!submits.empty()) {
+        free_batch(submits.front());
+        submits.pop_front();
+    }
+
+    for (auto& item : added)
+        release_upload(item.memory);
+
+    added.clear();
+
+    if (semaphore) {
+        device->vkDestroySemaphore(semaphore);
+        semaphore = VK_NULL_HANDLE;
+    }
+
+    if (pool) {
+        device->vkDestroyCommandPool(pool);
+        pool = VK_NULL_HANDLE;
+    }
+
+    device = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool upload_context::add(texture::ptr texture, ready_func on_ready) {
+    if (texture->streaming()) {
+        log()->warn("upload context - streamed texture (use staging)");
+        return false;
+    }
+
+    item item;
+    item.texture = texture;
+    item.on_ready = on_ready;
+
+    added.push_back(item);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool upload_context::add(buffer_upload const& upload, ready_func on_ready) {
+    if (upload.size == 0)
+        return false;
+
+    if (!(upload.buffer->get_usage() & VK_BUFFER_USAGE_TRANSFER_DST_BIT)) {
+        log()->error("upload context - buffer without transfer destination usage");
+        return false;
+    }
+
+    item item;
+    item.buffer = upload.buffer;
+    item.usage = upload.usage;
+    item.offset = upload.offset;
+    item.on_ready = on_ready;
+
+    item.memory = allocate_upload(device, upload.size);
+    if (!item.memory.valid())
+        return false;
+
+    if (upload.data)
+        memcpy(item.memory.data, upload.data, upload.size);
+
+    item.memory.flush();
+
+    added.push_back(item);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool upload_context::submit() {
+    if (added.empty())
+        return false;
+
+    VkCommandBuffer cmd_buf = VK_NULL_HANDLE;
+    if (!device->vkAllocateCommandBuffers(pool, 1, &cmd_buf, VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+        return false;
+
+    VkCommandBufferBeginInfo const begin_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    if (!check(device->call().vkBeginCommandBuffer(cmd_buf, &begin_info))) {
+        device->vkFreeCommandBuffers(pool, 1, &cmd_buf);
+        return false;
+    }
+
+    std::erase_if(added, [&](item const& item) {
+        if (!item.texture)
+            return false;
+
+        return !item.texture->stage_copy(cmd_buf);
+    });
+
+    for (auto const& item : added) {
+        if (!item.buffer)
+            continue;
+
+        VkBufferCopy const region{
+            .srcOffset = item.memory.offset,
+            .dstOffset = item.offset,
+            .size = item.memory.size,
+        };
+
+        device->call().vkCmdCopyBuffer(cmd_buf, item.memory.buffer->get(), item.buffer->get(), 1, &region);
+    }
+
+    record_release(cmd_buf, added);
+
+    device->call().vkEndCommandBuffer(cmd_buf);
+
+    auto const value = submitted_value + 1;
+
+    VkTimelineSemaphoreSubmitInfoKHR const timeline_info{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &value,
+    };
+
+    VkSubmitInfo const submit_info{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_info,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd_buf,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &semaphore,
+    };
+
+    if (!device->vkQueueSubmit(transfer_queue.vk_queue, 1, &submit_info, VK_NULL_HANDLE)) {
+        log()->error("upload context - submit {} uploads", added.size());
+
+        device->vkFreeCommandBuffers(pool, 1, &cmd_buf);
+        return false;
+    }
+
+    submitted_value = value;
+
+    batch batch;
+    batch.value = value;
+    batch.cmd_buf = cmd_buf;
+    batch.items = std::move(added);
+    submits.push_back(std::move(batch));
+
+    added.clear();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void upload_context::record_release(VkCommandBuffer cmd_buf, item::list const& items) const {
+    if (!ownership_transfer())
+        return;
+
+    std::vector<VkImageMemoryBarrier> image_barriers;
+    std::vector<VkBufferMemoryBarrier> buffer_barriers;
+
+    for (auto const& item : items) {
+        if (item.texture) {
+            // layout stays, the graphics queue finishes the texture
+            image_barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = 0,
+                .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = transfer_queue.family,
+                .dstQueueFamilyIndex = graphics_family,
+                .image = item.texture->get_image()->get(),
+                .subresourceRange = item.texture->get_image()->get_subresource_range(),
+            });
+        } else {
+            buffer_barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = 0,
+                .srcQueueFamilyIndex = transfer_queue.family,
+                .dstQueueFamilyIndex = graphics_family,
+                .buffer = item.buffer->get(),
+                .offset = item.offset,
+                .size = item.memory.size,
+            });
+        }
+    }
+
+    device->call().vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                        0, nullptr,
+                                        to_ui32(buffer_barriers.size()), buffer_barriers.data(),
+                                        to_ui32(image_barriers.size()), image_barriers.data());
+}
+
+//-----------------------------------------------------------------------------
+ui64 upload_context::acquire(VkCommandBuffer cmd_buf) {
+    if (submits.empty())
+        return 0;
+
+    auto const completed = get_completed_value();
+    auto const ownership = ownership_transfer();
+
+    ui64 result = 0;
+
+    // only completed submits, the graphics queue never waits for copies
+    while (!submits.empty() && submits.front().value <= completed) {
+        auto& batch = submits.front();
+
+        std::vector<VkImageMemoryBarrier> image_barriers;
+        std::vector<VkBufferMemoryBarrier> buffer_barriers;
+        VkPipelineStageFlags dst_stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        for (auto const& item : batch.items) {
+            if (item.texture) {
+                if (!ownership)
+                    continue;
+
+                image_barriers.push_back({
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask = 0,
+                    .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .srcQueueFamilyIndex = transfer_queue.family,
+                    .dstQueueFamilyIndex = graphics_family,
+                    .image = item.texture->get_image()->get(),
+                    .subresourceRange = item.texture->get_image()->get_subresource_range(),
+                });
+            } else {
+                buffer_barriers.push_back({
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                    .srcAccessMask = ownership ? VkAccessFlags(0) : VkAccessFlags(VK_ACCESS_TRANSFER_WRITE_BIT),
+                    .dstAccessMask = buffer::usage_to_possible_access(item.usage),
+                    .srcQueueFamilyIndex = ownership ? transfer_queue.family : VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = ownership ? graphics_family : VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = item.buffer->get(),
+                    .offset = item.offset,
+                    .size = item.memory.size,
+                });
+
+                dst_stages |= buffer::usage_to_possible_stages(item.usage);
+            }
+        }
+
+        if (!image_barriers.empty() || !buffer_barriers.empty())
+            device->call().vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stages, 0,
+                                                0, nullptr,
+                                                to_ui32(buffer_barriers.size()), buffer_barriers.data(),
+                                                to_ui32(image_barriers.size()), image_barriers.data());
+
+        for (auto const& item : batch.items) {
+            if (item.texture)
+                item.texture->stage_finish(cmd_buf);
+
+            if (item.on_ready)
+                item.on_ready();
+        }
+
+        result = batch.value;
+
+        free_batch(batch);
+        submits.pop_front();
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+void upload_context::free_batch(batch& batch) {
+    device->vkFreeCommandBuffers(pool, 1, &batch.cmd_buf);
+    batch.cmd_buf = VK_NULL_HANDLE;
+
+    for (auto& item : batch.items) {
+        if (item.texture)
+            item.texture->destroy_upload_buffer();
+        else
+            release_upload(item.memory);
+    }
+
+    batch.items.clear();
+}
+
+//-----------------------------------------------------------------------------
+ui64 upload_context::get_completed_value() const {
+    ui64 result = 0;
+    if (failed(device->call().vkGetSemaphoreCounterValueKHR(device->get(), semaphore, &result)))
+        return 0;
+
+    return result;
+}
+
+} // namespace lava
@@ -0,0 +1,247 @@
+/**
+ * @file         liblava/resource/upload_context.hpp
+ * @brief        Uploads on a dedicated transfer queue
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <liblava/resource/texture.hpp>
+
+namespace lava {
+
+/**
+ * @brief Upload context
+ *
+ * Copies of textures and buffers are recorded and submitted on a transfer queue
+ * and signal a timeline semaphore. When a submit is complete, acquire records the
+ * queue family ownership transfer (and the shader read transition or mip levels
+ * generation of textures) into a graphics command buffer. The graphics submit waits
+ * on the semaphore value of the acquired uploads (see renderer::add_wait_semaphore),
+ * as the copies are already done rendering is not blocked.
+ *
+ * Target buffers are written before use on the graphics queue, streamed textures
+ * stay on the staging.
+ */
+struct upload_context : entity {
+    /// Shared pointer to upload context
+    using ptr = std::shared_ptr<upload_context>;
+
+    /// Ready function (resource can be used by the following commands)
+    using ready_func = std::function<void()>;
+
+    /**
+     * @brief Destroy the upload context
+     */
+    ~upload_context() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new upload context
+     *
+     * Picks a transfer queue of another family (or another queue of the graphics family).
+     * Needs timeline semaphores (see device::timeline_semaphore_enabled).
+     *
+     * @param device            Vulkan device
+     * @param graphics_queue    Graphics queue that acquires the uploads
+     *
+     * @return true             Create was successful
+     * @return false            No transfer queue or timeline semaphores
+     */
+    bool create(device_ptr device, queue::ref graphics_queue);
+
+    /**
+     * @brief Destroy the upload context (waits for pending uploads)
+     */
+    void destroy();
+
+    /**
+     * @brief Add a texture to upload
+     *
+     * @param texture     Texture with upload buffer (not streamed)
+     * @param on_ready    Called after acquire
+     *
+     * @return true       Texture was added
+     * @return false      Texture is streamed
+     */
+    bool add(texture::ptr texture, ready_func on_ready = {});
+
+    /**
+     * @brief Add data to upload into a buffer
+     *
+     * The data is copied into upload memory.
+     *
+     * @param upload      Buffer upload (target needs transfer destination usage)
+     * @param on_ready    Called after acquire
+     *
+     * @return true       Upload was added
+     * @return false      Empty upload or allocate upload memory failed
+     */
+    bool add(buffer_upload const& upload, ready_func on_ready = {});
+
+    /**
+     * @brief Submit the added uploads on the transfer queue
+     *
+     * @return true     Uploads were submitted
+     * @return false    Nothing to submit or submit failed
+     */
+    bool submit();
+
+    /**
+     * @brief Acquire the completed uploads on the graphics queue
+     *
+     * Releases the upload memory of completed submits.
+     *
+     * @param cmd_buf    Graphics command buffer
+     *
+     * @return ui64      Semaphore value to wait on (0: nothing acquired)
+     */
+    ui64 acquire(VkCommandBuffer cmd_buf);
+
+    /**
+     * @brief Check if uploads are pending
+     *
+     * @return true     Uploads are added or in flight
+     * @return false    All uploads are acquired
+     */
+    bool busy() const {
+        return !added.empty() || !submits.empty();
+    }
+
+    /**
+     * @brief Get the timeline semaphore
+     *
+     * @return VkSemaphore    Timeline semaphore
+     */
+    VkSemaphore get_semaphore() const {
+        return semaphore;
+    }
+
+    /**
+     * @brief Get the value of the last submit
+     *
+     * @return ui64    Semaphore value
+     */
+    ui64 get_submitted_value() const {
+        return submitted_value;
+    }
+
+    /**
+     * @brief Get the completed semaphore value
+     *
+     * @return ui64    Semaphore value
+     */
+    ui64 get_completed_value() const;
+
+    /**
+     * @brief Get the transfer queue
+     *
+     * @return queue::ref    Transfer queue
+     */
+    queue::ref get_queue() const {
+        return transfer_queue;
+    }
+
+    /**
+     * @brief Check if uploads change the queue family
+     *
+     * @return true     Ownership transfer
+     * @return false    Same queue family
+     */
+    bool ownership_transfer() const {
+        return transfer_queue.family != graphics_family;
+    }
+
+private:
+    /**
+     * @brief Added upload
+     */
+    struct item {
+        /// List of items
+        using list = std::vector<item>;
+
+        /// Texture (or nullptr)
+        lava::texture::ptr texture;
+
+        /// Target buffer (or nullptr)
+        lava::buffer::ptr buffer;
+
+        /// Usage of target buffer
+        VkBufferUsageFlags usage = 0;
+
+        /// Upload memory of buffer
+        upload_allocation memory;
+
+        /// Offset in target buffer
+        VkDeviceSize offset = 0;
+
+        /// Called after acquire
+        ready_func on_ready;
+    };
+
+    /**
+     * @brief Submitted uploads
+     */
+    struct batch {
+        /// Semaphore value
+        ui64 value = 0;
+
+        /// Transfer command buffer
+        VkCommandBuffer cmd_buf = VK_NULL_HANDLE;
+
+        /// Uploads
+        item::list items;
+    };
+
+    /**
+     * @brief Record the release barriers of the transfer queue
+     *
+     * @param cmd_buf    Transfer command buffer
+     * @param items      Uploads
+     */
+    void record_release(VkCommandBuffer cmd_buf, item::list const& items) const;
+
+    /**
+     * @brief Free the memory of a batch
+     *
+     * @param batch    Submitted uploads
+     */
+    void free_batch(batch& batch);
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Transfer queue
+    queue transfer_queue;
+
+    /// Queue family of the graphics queue
+    index graphics_family = 0;
+
+    /// Command pool of transfer queue
+    VkCommandPool pool = VK_NULL_HANDLE;
+
+    /// Timeline semaphore
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+
+    /// Value of last submit
+    ui64 submitted_value = 0;
+
+    /// Uploads to submit
+    item::list added;
+
+    /// Submitted uploads (ordered by value)
+    std::deque<batch> submits;
+};
+
+/**
+ * @brief Make a new upload context
+ *
+ * @return upload_context::ptr    Shared pointer to upload context
+ */
+inline upload_context::ptr make_upload_context() {
+    return std::make_shared<upload_context>();
+}
+
+} // namespace lava
@@ -0,0 +1,268 @@
+/**
+ * @file         liblava/resource/upload_ring.cpp
+ * @brief        Upload ring buffer
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#include <liblava/resource/upload_ring.hpp>
+
+namespace lava {
+
+/**
+ * @brief Create a dedicated upload buffer
+ *
+ * @param device                 Vulkan device
+ * @param size                   Size of buffer
+ *
+ * @return upload_allocation     Allocation (invalid on failure)
+ */
+upload_allocation create_dedicated_upload(device_ptr device, VkDeviceSize size) {
+    auto buffer = make_buffer();
+    if (!buffer->create_mapped(device, nullptr, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT)) {
+        log()->error("create upload buffer");
+        return {};
+    }
+
+    upload_allocation result;
+    result.buffer = buffer;
+    result.size = size;
+    result.data = (data_ptr) buffer->get_mapped_data();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+bool upload_ring::create(device_ptr d, VkDeviceSize ring_size) {
+    device = d;
+
+    ring_buffer = make_buffer();
+    if (!ring_buffer->create_mapped(device, nullptr, ring_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT)) {
+        log()->error("create upload ring");
+        ring_buffer = nullptr;
+        return false;
+    }
+
+    if (!device->vkCreateCommandPool(device->get_graphics_queue().family, &pool)) {
+        log()->error("create upload ring command pool");
+        ring_buffer = nullptr;
+        return false;
+    }
+
+    size = ring_size;
+    head = 0;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void upload_ring::destroy() {
+    std::unique_lock<std::mutex> command_lock(command_mutex);
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // live allocations keep the buffer until released
+    ring_buffer = nullptr;
+    ranges.clear();
+
+    if (pool) {
+        device->vkDestroyCommandPool(pool);
+        pool = VK_NULL_HANDLE;
+    }
+
+    size = 0;
+    head = 0;
+}
+
+//-----------------------------------------------------------------------------
+bool upload_ring::find_space(VkDeviceSize alloc_size, VkDeviceSize alignment, VkDeviceSize& offset) const {
+    if (ranges.empty()) {
+        offset = 0;
+        return alloc_size <= size;
+    }
+
+    auto const tail = ranges.front().begin;
+    auto const aligned = (head + alignment - 1) / alignment * alignment;
+
+    // free space: [head, size) and [0, tail)
+    if (head >= tail) {
+        if (aligned + alloc_size <= size) {
+            offset = aligned;
+            return true;
+        }
+
+        // head must not reach the tail (full and empty are not distinguishable)
+        if (alloc_size < tail) {
+            offset = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    // free space: [head, tail)
+    if (aligned + alloc_size < tail) {
+        offset = aligned;
+        return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+upload_allocation upload_ring::allocate(VkDeviceSize alloc_size, VkDeviceSize alignment) {
+    alloc_size = std::max(alloc_size, VkDeviceSize(1));
+    alignment = std::max(alignment, VkDeviceSize(1));
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        VkDeviceSize offset = 0;
+        if (ring_buffer && alloc_size <= size / 4 && find_space(alloc_size, alignment, offset)) {
+            ranges.push_back({ offset, offset + alloc_size });
+            head = offset + alloc_size;
+
+            upload_allocation result;
+            result.buffer = ring_buffer;
+            result.offset = offset;
+            result.size = alloc_size;
+            result.data = (data_ptr) ring_buffer->get_mapped_data() + offset;
+            result.ring = weak_from_this();
+            return result;
+        }
+
+        ++dedicated_count;
+    }
+
+    return create_dedicated_upload(device, alloc_size);
+}
+
+//-----------------------------------------------------------------------------
+void upload_ring::free(upload_allocation& allocation) {
+    if (allocation.ring.lock().get() == this) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (auto& range : ranges) {
+            if (range.begin == allocation.offset && !range.freed) {
+                range.freed = true;
+                break;
+            }
+        }
+
+        while (!ranges.empty() && ranges.front().freed)
+            ranges.pop_front();
+
+        if (ranges.empty())
+            head = 0;
+    }
+
+    allocation = {};
+}
+
+//-----------------------------------------------------------------------------
+upload_allocation allocate_upload(device_ptr device, VkDeviceSize size, VkDeviceSize alignment) {
+    if (auto ring = device->get_upload_ring())
+        return ring->allocate(size, alignment);
+
+    return create_dedicated_upload(device, size);
+}
+
+//-----------------------------------------------------------------------------
+void release_upload(upload_allocation& allocation) {
+    if (auto ring = allocation.ring.lock())
+        ring->free(allocation);
+    else
+        allocation = {};
+}
+
+//-----------------------------------------------------------------------------
+bool upload_buffers(device_ptr device, buffer_upload::list const& uploads) {
+    VkDeviceSize const alignment = 16;
+
+    VkDeviceSize total_size = 0;
+    for (auto& upload : uploads)
+        total_size += (upload.size + alignment - 1) / alignment * alignment;
+
+    if (total_size == 0)
+        return true;
+
+    auto memory = allocate_upload(device, total_size, alignment);
+    if (!memory.valid())
+        return false;
+
+    std::vector<VkDeviceSize> offsets;
+
+    auto offset = memory.offset;
+    for (auto& upload : uploads) {
+        if (upload.data)
+            memcpy(memory.data + (offset - memory.offset), upload.data, upload.size);
+        offsets.push_back(offset);
+
+        offset += (upload.size + alignment - 1) / alignment * alignment;
+    }
+
+    memory.flush();
+
+    auto const& queue = device->get_graphics_queue();
+
+    // transient pool only without upload ring
+    auto ring = device->get_upload_ring();
+    VkCommandPool pool = ring ? ring->get_command_pool() : VK_NULL_HANDLE;
+
+    std::unique_lock<std::mutex> pool_lock;
+    if (pool)
+        pool_lock = ring->lock_command_pool();
+
+    auto const transient = pool == VK_NULL_HANDLE;
+    if (transient && !device->vkCreateCommandPool(queue.family, &pool)) {
+        release_upload(memory);
+        return false;
+    }
+
+    auto const result = one_time_command_buffer(device, pool, queue, [&](VkCommandBuffer cmd_buf) {
+        std::vector<VkBufferMemoryBarrier> barriers;
+        VkPipelineStageFlags dst_stages = 0;
+
+        for (auto i = 0u; i < uploads.size(); ++i) {
+            auto const& upload = uploads.at(i);
+
+            VkBufferCopy const region{
+                .srcOffset = offsets.at(i),
+                .dstOffset = upload.offset,
+                .size = upload.size,
+            };
+
+            device->call().vkCmdCopyBuffer(cmd_buf, memory.buffer->get(), upload.buffer->get(), 1, &region);
+
+            barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = buffer::usage_to_possible_access(upload.usage),
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = upload.buffer->get(),
+                .offset = 0,
+                .size = VK_WHOLE_SIZE,
+            });
+
+            dst_stages |= buffer::usage_to_possible_stages(upload.usage);
+        }
+
+        device->call().vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            dst_stages ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                            0, 0, nullptr, to_ui32(barriers.size()), barriers.data(), 0, nullptr);
+    });
+
+    if (transient)
+        device->vkDestroyCommandPool(pool);
+    else
+        pool_lock.unlock();
+
+    // submit waited for completion
+    release_upload(memory);
+
+    if (!result)
+        log()->error("upload buffers");
+
+    return result;
+}
+
+} // namespace lava
@@ -0,0 +1,298 @@
+/**
+ * @file         liblava/resource/upload_ring.hpp
+ * @brief        Upload ring buffer
+ * @authors      Lava Block OÜ and contributors
+ * @copyright    Copyright (c) 2018-present, MIT License
+ */
+
+#pragma once
+
+#include <deque>
+#include <liblava/resource/buffer.hpp>
+
+namespace lava {
+
+/// Default size of upload ring
+constexpr VkDeviceSize const default_upload_ring_size = 32 << 20;
+
+/// Upload ring
+struct upload_ring;
+
+/**
+ * @brief Upload allocation (range of mapped transfer source memory)
+ */
+struct upload_allocation {
+    /// Source buffer (ring or dedicated buffer)
+    lava::buffer::ptr buffer;
+
+    /// Offset in buffer
+    VkDeviceSize offset = 0;
+
+    /// Size of allocation
+    VkDeviceSize size = 0;
+
+    /// Mapped data
+    data_ptr data = nullptr;
+
+    /// Ring of allocation (empty: dedicated buffer or ring is gone)
+    std::weak_ptr<upload_ring> ring;
+
+    /**
+     * @brief Check if the allocation is valid
+     *
+     * @return true     Allocation is valid
+     * @return false    Allocation is invalid
+     */
+    bool valid() const {
+        return buffer != nullptr;
+    }
+
+    /**
+     * @brief Flush the written data
+     */
+    void flush() {
+        if (buffer)
+            buffer->flush(offset, size);
+    }
+};
+
+/**
+ * @brief Upload ring buffer
+ *
+ * One persistently mapped transfer source buffer, suballocated in order.
+ * Allocations are freed after the GPU is done with them (e.g. staging frame comes back),
+ * freed space is reused from the oldest allocation on. Oversized uploads and uploads
+ * while the ring is full get dedicated buffers. Allocations only keep a weak reference
+ * to the ring, releasing after the ring is gone just drops the buffer reference.
+ */
+struct upload_ring : no_copy_no_move, std::enable_shared_from_this<upload_ring> {
+    /// Shared pointer to upload ring
+    using ptr = std::shared_ptr<upload_ring>;
+
+    /**
+     * @brief Destroy the upload ring
+     */
+    ~upload_ring() {
+        destroy();
+    }
+
+    /**
+     * @brief Create a new upload ring (owned by a shared pointer, see make_upload_ring)
+     *
+     * @param device    Vulkan device
+     * @param size      Size of ring buffer
+     *
+     * @return true     Create was successful
+     * @return false    Create failed
+     */
+    bool create(device_ptr device, VkDeviceSize size = default_upload_ring_size);
+
+    /**
+     * @brief Destroy the upload ring
+     */
+    void destroy();
+
+    /**
+     * @brief Allocate upload memory (thread safe)
+     *
+     * @param size                   Size of allocation
+     * @param alignment              Alignment of offset
+     *
+     * @return upload_allocation     Allocation (dedicated buffer if oversized or ring is full)
+     */
+    upload_allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    /**
+     * @brief Free upload memory (thread safe)
+     *
+     * @param allocation    Allocation to free (reset)
+     */
+    void free(upload_allocation& allocation);
+
+    /**
+     * @brief Get the size of the ring buffer
+     *
+     * @return VkDeviceSize    Ring size
+     */
+    VkDeviceSize get_size() const {
+        return size;
+    }
+
+    /**
+     * @brief Get the number of live ring allocations
+     *
+     * @return size_t    Number of allocations
+     */
+    size_t get_allocation_count() const {
+        return ranges.size();
+    }
+
+    /**
+     * @brief Get the command pool of the graphics queue (see upload_buffers)
+     *
+     * Hold lock_command_pool while recording and submitting with it.
+     *
+     * @return VkCommandPool    Command pool
+     */
+    VkCommandPool get_command_pool() const {
+        return pool;
+    }
+
+    /**
+     * @brief Lock the command pool (externally synchronized in Vulkan)
+     *
+     * @return std::unique_lock<std::mutex>    Command pool lock
+     */
+    std::unique_lock<std::mutex> lock_command_pool() {
+        return std::unique_lock<std::mutex>(command_mutex);
+    }
+
+    /**
+     * @brief Get the number of dedicated fallback buffers
+     *
+     * @return ui32    Number of dedicated buffers
+     */
+    ui32 get_dedicated_count() const {
+        return dedicated_count;
+    }
+
+private:
+    /**
+     * @brief Range in ring buffer
+     */
+    struct range {
+        /// First byte
+        VkDeviceSize begin = 0;
+
+        /// End (exclusive)
+        VkDeviceSize end = 0;
+
+        /// Range is freed
+        bool freed = false;
+    };
+
+    /**
+     * @brief Find free space in the ring
+     *
+     * @param size            Size of allocation
+     * @param alignment       Alignment of offset
+     * @param offset          Found offset
+     *
+     * @return true           Space found
+     * @return false          Ring is full
+     */
+    bool find_space(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) const;
+
+    /// Vulkan device
+    device_ptr device = nullptr;
+
+    /// Ring buffer
+    lava::buffer::ptr ring_buffer;
+
+    /// Command pool of graphics queue
+    VkCommandPool pool = VK_NULL_HANDLE;
+
+    /// Size of ring buffer
+    VkDeviceSize size = 0;
+
+    /// Next free byte
+    VkDeviceSize head = 0;
+
+    /// Live ranges (allocation order)
+    std::deque<range> ranges;
+
+    /// Ring mutex
+    std::mutex mutex;
+
+    /// Command pool mutex
+    std::mutex command_mutex;
+
+    /// Number of dedicated fallback buffers
+    ui32 dedicated_count = 0;
+};
+
+/**
+ * @brief Make a new upload ring
+ *
+ * @return upload_ring::ptr    Shared pointer to upload ring
+ */
+inline upload_ring::ptr make_upload_ring() {
+    return std::make_shared<upload_ring>();
+}
+
+/**
+ * @brief Create a new upload ring
+ *
+ * @param device               Vulkan device
+ * @param size                 Size of ring buffer
+ *
+ * @return upload_ring::ptr    Shared pointer to upload ring
+ */
+inline upload_ring::ptr create_upload_ring(device_ptr device, VkDeviceSize size = default_upload_ring_size) {
+    auto result = make_upload_ring();
+    if (!result->create(device, size))
+        return nullptr;
+
+    return result;
+}
+
+/**
+ * @brief Allocate upload memory from the upload ring of a device
+ *
+ * @param device                 Vulkan device
+ * @param size                   Size of allocation
+ * @param alignment              Alignment of offset
+ *
+ * @return upload_allocation     Allocation (dedicated buffer without upload ring)
+ */
+upload_allocation allocate_upload(device_ptr device, VkDeviceSize size, VkDeviceSize alignment = 16);
+
+/**
+ * @brief Release upload memory (after the GPU is done)
+ *
+ * @param allocation    Allocation to release (reset)
+ */
+void release_upload(upload_allocation& allocation);
+
+/**
+ * @brief Buffer data to upload
+ */
+struct buffer_upload {
+    /// List of buffer uploads
+    using list = std::vector<buffer_upload>;
+
+    /// Target buffer (transfer destination)
+    lava::buffer::ptr buffer;
+
+    /// Data to upload
+    void const* data = nullptr;
+
+    /// Size of data
+    VkDeviceSize size = 0;
+
+    /// Usage of target buffer (barrier after the copy)
+    VkBufferUsageFlags usage = 0;
+
+    /// Offset in target buffer
+    VkDeviceSize offset = 0;
+};
+
+/**
+ * @brief Upload data into device local buffers
+ *
+ * Copies all uploads in one submit on the graphics queue and waits for completion.
+ * The command pool of the upload ring is reused and locked while recording and submitting,
+ * the graphics queue is not: call on the thread that owns the queue (or while no other
+ * thread submits to it).
+ * Batch the uploads of a loader into one call, or add them to the staging to copy
+ * them in the next frame without waiting (see staging::add).
+ *
+ * @param device     Vulkan device
+ * @param uploads    List of buffer uploads
+ *
+ * @return true      Upload was successful
+ * @return false     Upload failed
+ */
+bool upload_buffers(device_ptr device, buffer_upload::list const& uploads);
+
+} // namespace lava
@@ -62,6 +62,10 @@ struct thread_pool {
             worker.join();
 
         workers.clear();
+
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        tasks.clear();
+        stop = false;
     }
 
     /**
@@ -416,3 +416,1171 @@ LAVA_TEST(8, "imgui demo") {
 
     return app.run();
 }
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <filesystem>
+#include <stb_image_write.h>
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(9, "texture loading benchmark") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    auto const file_count = 500u;
+    uv2 const size = { 256, 256 };
+
+    auto const path = std::filesystem::temp_directory_path() / "lava_texture_benchmark";
+    std::filesystem::create_directories(path);
+
+    file_format::list files;
+
+    std::vector<ui8> pixels(size.x * size.y * 4);
+    for (auto i = 0u; i < file_count; ++i) {
+        for (auto p = 0u; p < size.x * size.y; ++p) {
+            pixels[p * 4] = ui8((p % size.x + i) & 0xff);
+            pixels[p * 4 + 1] = ui8((p / size.x) & 0xff);
+            pixels[p * 4 + 2] = ui8(random(0, 255));
+            pixels[p * 4 + 3] = 255;
+        }
+
+        auto const filename = (path / fmt::format("{}.png", i)).string();
+        if (!stbi_write_png(str(filename), size.x, size.y, 4, pixels.data(), size.x * 4))
+            return error::create_failed;
+
+        files.push_back({ filename, VK_FORMAT_R8G8B8A8_SRGB });
+    }
+
+    timer timer;
+
+    texture::list serial;
+    for (auto& file : files)
+        serial.push_back(load_texture(device, file));
+
+    auto const serial_time = timer.elapsed();
+
+    timer.reset();
+
+    auto parallel = load_textures(device, files);
+
+    auto const parallel_time = timer.elapsed();
+
+    auto failed = 0u;
+    for (auto i = 0u; i < file_count; ++i)
+        if (!serial[i] || !parallel[i])
+            ++failed;
+
+    log()->info("{} textures - serial: {} ms, parallel: {} ms ({:.2f}x), failed: {}",
+                file_count, serial_time.count(), parallel_time.count(),
+                to_r64(serial_time.count()) / std::max(to_r64(parallel_time.count()), 1.0), failed);
+
+    serial.clear();
+    parallel.clear();
+
+    std::filesystem::remove_all(path);
+
+    return failed == 0 ? 0 : error::load_failed;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(10, "mip chain benchmark") {
+    uv2 const size = { 4096, 4096 };
+    auto const megapixels = to_r64(size.x * size.y) / 1000000.0;
+
+    auto const levels = get_mip_levels(size);
+
+    std::vector<char> chain(get_mip_chain_size(size));
+    for (auto i = 0u; i < levels.front().size; ++i)
+        chain[i] = char(random(0, 255));
+
+    auto const run_count = 10u;
+
+    for (auto srgb : { false, true }) {
+        // first run warms up the conversion tables
+        generate_mip_chain(chain.data(), levels, srgb);
+
+        timer timer;
+
+        for (auto i = 0u; i < run_count; ++i)
+            generate_mip_chain(chain.data(), levels, srgb);
+
+        auto const time = to_r64(timer.elapsed().count()) / run_count;
+
+        log()->info("{} mip chain {}x{} ({} levels): {:.2f} ms, {:.3f} ms per megapixel",
+                    srgb ? "sRGB" : "UNORM", size.x, size.y, levels.size(), time, time / megapixels);
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(11, "gpu mip generation") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    uv2 const size = { 256, 256 };
+    auto const format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    // black and white checkerboard, every mip level is mid gray
+    std::vector<ui8> pixels(size.x * size.y * 4);
+    for (auto y = 0u; y < size.y; ++y) {
+        for (auto x = 0u; x < size.x; ++x) {
+            auto const value = (x + y) % 2 ? 255 : 0;
+            auto* pixel = &pixels[(y * size.x + x) * 4];
+            pixel[0] = pixel[1] = pixel[2] = ui8(value);
+            pixel[3] = 255;
+        }
+    }
+
+    auto texture = make_texture();
+    if (!texture->create(device, size, format, {}, texture_type::tex_2d, true))
+        return error::create_failed;
+
+    if (!texture->upload(pixels.data(), pixels.size()))
+        return error::create_failed;
+
+    auto const level_count = texture->get_level_count();
+    log()->info("mip levels: {} (generated: {})", level_count, texture->mip_levels_generated());
+
+    auto readback = make_buffer();
+    if (!readback->create_mapped(device, nullptr, 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 VMA_MEMORY_USAGE_GPU_TO_CPU))
+        return error::create_failed;
+
+    auto const& queue = device->get_graphics_queue();
+
+    VkCommandPool pool = VK_NULL_HANDLE;
+    if (!device->vkCreateCommandPool(queue.family, &pool))
+        return error::create_failed;
+
+    auto const result = one_time_command_buffer(device, pool, queue, [&](VkCommandBuffer cmd_buf) {
+        texture->stage(cmd_buf);
+
+        VkImageSubresourceRange const last_level{
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = level_count - 1,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        };
+
+        set_image_layout(device, cmd_buf, texture->get_image()->get(),
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         last_level, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkBufferImageCopy const region{
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level_count - 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageExtent = { 1, 1, 1 },
+        };
+
+        device->call().vkCmdCopyImageToBuffer(cmd_buf, texture->get_image()->get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                              readback->get(), 1, &region);
+    });
+
+    device->vkDestroyCommandPool(pool);
+
+    if (!result)
+        return error::run_aborted;
+
+    vmaInvalidateAllocation(device->alloc(), readback->get_allocation(), 0, VK_WHOLE_SIZE);
+
+    auto const* pixel = (ui8 const*) readback->get_mapped_data();
+    log()->info("last mip level: {} {} {} {}", pixel[0], pixel[1], pixel[2], pixel[3]);
+
+    auto const passed = level_count == get_mip_level_count(size)
+                        && std::abs(pixel[0] - 128) <= 2 && pixel[3] == 255;
+
+    texture->destroy();
+    readback->destroy();
+
+    return passed ? 0 : error::load_failed;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(12, "block compression benchmark") {
+    uv2 const size = { 2048, 2048 };
+    auto const megapixels = to_r64(size.x * size.y) / 1000000.0;
+
+    // smooth gradients with some noise
+    std::vector<char> pixels(size.x * size.y * 4);
+    for (auto y = 0u; y < size.y; ++y) {
+        for (auto x = 0u; x < size.x; ++x) {
+            auto* pixel = (ui8*) &pixels[(y * size.x + x) * 4];
+            pixel[0] = ui8(std::clamp(128.0 + 100.0 * std::sin(x * 0.02) * std::cos(y * 0.03) + random(-6, 6), 0.0, 255.0));
+            pixel[1] = ui8(std::clamp(i32(x * 255 / size.x) + random(-6, 6), 0, 255));
+            pixel[2] = ui8(std::clamp(i32(y * 255 / size.y) + random(-6, 6), 0, 255));
+            pixel[3] = ui8(200 + 50 * std::sin((x + y) * 0.01));
+        }
+    }
+
+    struct bc_test {
+        name label;
+        VkFormat format;
+        ui32 channel_mask;
+    };
+
+    std::vector<bc_test> const tests = {
+        { "BC1", VK_FORMAT_BC1_RGB_UNORM_BLOCK, 0x7 },
+        { "BC3", VK_FORMAT_BC3_UNORM_BLOCK, 0xf },
+        { "BC4", VK_FORMAT_BC4_UNORM_BLOCK, 0x1 },
+        { "BC5", VK_FORMAT_BC5_UNORM_BLOCK, 0x3 },
+        { "BC7", VK_FORMAT_BC7_UNORM_BLOCK, 0xf },
+    };
+
+    std::vector<char> decoded(pixels.size());
+
+    for (auto const& test : tests) {
+        std::vector<char> encoded(get_bc_size(test.format, size));
+
+        timer timer;
+
+        if (!encode_bc(test.format, pixels.data(), size, encoded.data(), 1))
+            return error::create_failed;
+
+        auto const single_time = to_r64(timer.elapsed().count());
+
+        timer.reset();
+
+        encode_bc(test.format, pixels.data(), size, encoded.data());
+
+        auto const parallel_time = to_r64(timer.elapsed().count());
+
+        decode_bc(test.format, encoded.data(), size, decoded.data());
+
+        log()->info("{}: {:.2f} dB PSNR - single thread: {:.1f} MP/s, parallel: {:.1f} MP/s",
+                    test.label, calculate_psnr(pixels.data(), decoded.data(), size, test.channel_mask),
+                    megapixels * 1000.0 / std::max(single_time, 1.0),
+                    megapixels * 1000.0 / std::max(parallel_time, 1.0));
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(13, "texture streaming") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    uv2 const size = { 2048, 2048 };
+
+    texture::layer layer;
+    layer.levels = get_mip_levels(size);
+
+    std::vector<char> pixels(get_mip_chain_size(size));
+    for (auto i = 0u; i < size.x * size.y; ++i)
+        *(ui32*) &pixels[i * 4] = random(0xffffffffu);
+
+    generate_mip_chain(pixels.data(), layer.levels, false);
+
+    auto texture = make_texture();
+    if (!texture->create(device, size, VK_FORMAT_R8G8B8A8_UNORM, { layer }))
+        return error::create_failed;
+
+    if (!texture->upload_stream(pixels.data(), pixels.size()))
+        return error::create_failed;
+
+    log()->info("mip levels: {} - resident: {}", texture->get_level_count(), texture->get_resident_level());
+
+    auto frame_index = 0u;
+
+    texture->on_resident = [&](ui32 level) {
+        log()->info("frame {}: resident mip level {} ({}x{})", frame_index, level,
+                    layer.levels[level].extent.x, layer.levels[level].extent.y);
+    };
+
+    staging staging;
+    staging.set_stream_budget(1 << 20);
+    staging.add(texture);
+
+    auto const& queue = device->get_graphics_queue();
+
+    VkCommandPool pool = VK_NULL_HANDLE;
+    if (!device->vkCreateCommandPool(queue.family, &pool))
+        return error::create_failed;
+
+    auto const frame_count = 3u;
+
+    for (; staging.busy() && frame_index < 100; ++frame_index) {
+        timer timer;
+
+        auto const result = one_time_command_buffer(device, pool, queue, [&](VkCommandBuffer cmd_buf) {
+            staging.stage(cmd_buf, frame_index % frame_count);
+        });
+
+        if (!result)
+            break;
+
+        log()->info("frame {}: {:.3f} ms", frame_index, to_r64(timer.elapsed().count()));
+    }
+
+    device->vkDestroyCommandPool(pool);
+
+    auto const passed = texture->get_resident_level() == 0 && !texture->streaming();
+
+    texture->destroy();
+
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(14, "half float conversion benchmark") {
+    uv2 const size = { 4096, 2048 };
+    auto const pixel_count = size_t(size.x) * size.y;
+    auto const megapixels = to_r64(pixel_count) / 1000000.0;
+
+    // HDR range with a bright spot
+    std::vector<r32> pixels(pixel_count * 4);
+    for (auto i = 0u; i < pixel_count; ++i) {
+        auto const intensity = i % 997 == 0 ? 5000.f : 1.f;
+        pixels[i * 4] = random(0.f, 4.f) * intensity;
+        pixels[i * 4 + 1] = random(0.f, 2.f) * intensity;
+        pixels[i * 4 + 2] = random(0.f, 1.f) * intensity;
+        pixels[i * 4 + 3] = 1.f;
+    }
+
+    std::vector<ui16> half_pixels(pixel_count * 4);
+    std::vector<ui32> packed_pixels(pixel_count);
+
+    auto benchmark = [&](name label, auto convert) {
+        timer timer;
+        convert(false);
+        auto const scalar_time = std::max(to_r64(timer.elapsed().count()), 1.0);
+
+        timer.reset();
+        convert(true);
+        auto const simd_time = std::max(to_r64(timer.elapsed().count()), 1.0);
+
+        log()->info("{}: scalar {:.1f} MP/s, simd {:.1f} MP/s ({:.1f}x)", label,
+                    megapixels * 1000.0 / scalar_time, megapixels * 1000.0 / simd_time, scalar_time / simd_time);
+    };
+
+    benchmark("R16G16B16A16_SFLOAT", [&](bool simd) {
+        convert_to_half(pixels.data(), half_pixels.data(), pixels.size(), simd);
+    });
+
+    benchmark("B10G11R11_UFLOAT", [&](bool simd) {
+        convert_to_b10g11r11(pixels.data(), packed_pixels.data(), pixel_count, simd);
+    });
+
+    r64 half_error = 0.0;
+    r64 packed_error = 0.0;
+
+    for (auto i = 0u; i < pixel_count; ++i) {
+        auto const value = pixels[i * 4];
+        if (value <= 0.f)
+            continue;
+
+        half_error = std::max(half_error, to_r64(std::abs(half_to_float(half_pixels[i * 4]) - value) / value));
+        packed_error = std::max(packed_error, to_r64(std::abs(unpack_b10g11r11(packed_pixels[i]).x - value) / value));
+    }
+
+    log()->info("max relative error - half: {:.5f}, packed: {:.5f}", half_error, packed_error);
+    log()->info("memory - float: {} MB, half: {} MB, packed: {} MB",
+                pixels.size() * sizeof(r32) >> 20, half_pixels.size() * sizeof(ui16) >> 20,
+                packed_pixels.size() * sizeof(ui32) >> 20);
+
+    return half_error < 0.001 && packed_error < 0.02 ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(15, "gltf loading") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    // grid with interleaved position / normal and packed 32 bit indices
+    auto const grid_size = 512u;
+    auto const vertex_count = grid_size * grid_size;
+
+    std::vector<r32> vertices;
+    vertices.reserve(vertex_count * 6);
+    for (auto y = 0u; y < grid_size; ++y) {
+        for (auto x = 0u; x < grid_size; ++x) {
+            for (auto value : { r32(x), 0.f, r32(y), 0.f, 1.f, 0.f })
+                vertices.push_back(value);
+        }
+    }
+
+    std::vector<ui32> indices;
+    for (auto y = 0u; y + 1 < grid_size; ++y) {
+        for (auto x = 0u; x + 1 < grid_size; ++x) {
+            auto const i = y * grid_size + x;
+            for (auto value : { i, i + grid_size, i + 1, i + 1, i + grid_size, i + grid_size + 1 })
+                indices.push_back(value);
+        }
+    }
+
+    auto const vertex_size = vertices.size() * sizeof(r32);
+    auto const index_size = indices.size() * sizeof(ui32);
+
+    json root;
+    root["asset"]["version"] = "2.0";
+    root["buffers"] = { { { "byteLength", vertex_size + index_size } } };
+    root["bufferViews"] = {
+        { { "buffer", 0 }, { "byteLength", vertex_size }, { "byteStride", 6 * sizeof(r32) } },
+        { { "buffer", 0 }, { "byteOffset", vertex_size }, { "byteLength", index_size } },
+    };
+    root["accessors"] = {
+        { { "bufferView", 0 }, { "componentType", 5126 }, { "count", vertex_count }, { "type", "VEC3" } },
+        { { "bufferView", 0 }, { "byteOffset", 3 * sizeof(r32) }, { "componentType", 5126 }, { "count", vertex_count }, { "type", "VEC3" } },
+        { { "bufferView", 1 }, { "componentType", 5125 }, { "count", indices.size() }, { "type", "SCALAR" } },
+    };
+    root["meshes"] = { { { "primitives", { { { "attributes", { { "POSITION", 0 }, { "NORMAL", 1 } } }, { "indices", 2 } } } } } };
+    root["nodes"] = { { { "mesh", 0 } } };
+    root["scenes"] = { { { "nodes", { 0 } } } };
+
+    auto text = root.dump();
+    text.resize(align_up(text.size(), size_t(4)), ' ');
+
+    auto const filename = (fs::temp_directory_path() / "lava_test.glb").string();
+
+    {
+        std::ofstream stream(filename, std::ios::binary);
+
+        auto write = [&](void const* data, size_t size) {
+            stream.write((char const*) data, size);
+        };
+
+        ui32 const header[] = { 0x46546c67, 2, to_ui32(12 + 8 + text.size() + 8 + vertex_size + index_size) };
+        write(header, sizeof(header));
+
+        ui32 const json_chunk[] = { to_ui32(text.size()), 0x4e4f534a };
+        write(json_chunk, sizeof(json_chunk));
+        write(text.data(), text.size());
+
+        ui32 const bin_chunk[] = { to_ui32(vertex_size + index_size), 0x004e4942 };
+        write(bin_chunk, sizeof(bin_chunk));
+        write(vertices.data(), vertex_size);
+        write(indices.data(), index_size);
+    }
+
+    timer timer;
+
+    auto model = load_gltf(device, filename, false);
+    if (!model)
+        return error::load_failed;
+
+    log()->info("gltf loaded: {} vertices, {} indices in {:.3f} ms",
+                vertex_count, indices.size(), to_r64(timer.elapsed().count()));
+
+    auto passed = false;
+    model->traverse([&](index node, mat4 const&) {
+        auto const mesh = model->nodes[node].mesh;
+        if (mesh < 0)
+            return;
+
+        auto const& primitive = model->meshes[mesh].primitives.front();
+        passed = primitive.mesh->get_indices() == indices
+                 && primitive.mesh->get_vertices().back().normal == v3(0.f, 1.f, 0.f);
+    });
+
+    for (auto& mesh : model->meshes)
+        for (auto& primitive : mesh.primitives)
+            primitive.mesh->destroy();
+
+    fs::remove(filename);
+
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(16, "asset manager") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    auto const file_count = 48u;
+    uv2 const size = { 512, 512 };
+
+    auto const path = std::filesystem::temp_directory_path() / "lava_asset_manager";
+    std::filesystem::create_directories(path);
+
+    std::vector<ui8> pixels(size.x * size.y * 4);
+    for (auto& pixel : pixels)
+        pixel = ui8(random(0, 255));
+
+    file_format::list files;
+    for (auto i = 0u; i < file_count; ++i) {
+        auto const filename = (path / fmt::format("{}.png", i)).string();
+        if (!stbi_write_png(str(filename), size.x, size.y, 4, pixels.data(), size.x * 4))
+            return error::create_failed;
+
+        files.push_back({ filename, VK_FORMAT_R8G8B8A8_UNORM });
+    }
+
+    asset_manager manager;
+    if (!manager.create(device))
+        return error::create_failed;
+
+    VkDeviceSize const budget = 16 << 20;
+    manager.set_budget(budget);
+
+    id::list requests;
+    for (auto& file : files)
+        requests.push_back(manager.request_texture(file));
+
+    auto const& queue = device->get_graphics_queue();
+
+    VkCommandPool pool = VK_NULL_HANDLE;
+    if (!device->vkCreateCommandPool(queue.family, &pool))
+        return error::create_failed;
+
+    staging staging;
+
+    auto loaded = 0u;
+    auto max_resident = VkDeviceSize(0);
+
+    for (auto frame_index = 0u; (manager.loading() || staging.busy()) && frame_index < 1000; ++frame_index) {
+        auto const result = one_time_command_buffer(device, pool, queue, [&](VkCommandBuffer cmd_buf) {
+            manager.update(staging);
+            staging.stage(cmd_buf, frame_index % 3);
+        });
+
+        if (!result)
+            break;
+
+        // use each texture once, then drop the reference
+        for (auto& request : requests) {
+            if (!request.valid())
+                continue;
+
+            auto const state = manager.get_state(request);
+            if (state == asset_state::queued || state == asset_state::loading)
+                continue;
+
+            if (manager.get_texture(request))
+                ++loaded;
+
+            manager.release(request);
+            request.invalidate();
+        }
+
+        max_resident = std::max(max_resident, manager.get_resident_size());
+    }
+
+    log()->info("asset manager - loaded: {}, evicted: {}, max resident: {} MB, resident: {} MB (budget: {} MB)",
+                loaded, manager.get_eviction_count(), max_resident >> 20,
+                manager.get_resident_size() >> 20, budget >> 20);
+
+    device->wait_for_idle();
+    device->vkDestroyCommandPool(pool);
+
+    manager.destroy();
+
+    std::filesystem::remove_all(path);
+
+    auto const passed = loaded == file_count && manager.get_eviction_count() > 0;
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(17, "upload ring") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    auto ring = device->get_upload_ring();
+    if (!ring)
+        return error::create_failed;
+
+    auto const texture_count = 2000u;
+    auto const textures_per_frame = 200u;
+    uv2 const size = { 64, 64 };
+
+    std::vector<ui8> pixels(size.x * size.y * 4);
+    for (auto& pixel : pixels)
+        pixel = ui8(random(0, 255));
+
+    auto const& queue = device->get_graphics_queue();
+
+    VkCommandPool pool = VK_NULL_HANDLE;
+    if (!device->vkCreateCommandPool(queue.family, &pool))
+        return error::create_failed;
+
+    staging staging;
+    texture::list textures;
+
+    auto max_allocations = size_t(0);
+
+    timer timer;
+
+    for (auto frame_index = 0u; (textures.size() < texture_count || staging.busy()) && frame_index < 1000; ++frame_index) {
+        for (auto i = 0u; i < textures_per_frame && textures.size() < texture_count; ++i) {
+            auto texture = make_texture();
+            if (!texture->create(device, size, VK_FORMAT_R8G8B8A8_UNORM)
+                || !texture->upload(pixels.data(), pixels.size()))
+                return error::create_failed;
+
+            staging.add(texture);
+            textures.push_back(texture);
+        }
+
+        max_allocations = std::max(max_allocations, ring->get_allocation_count());
+
+        auto const result = one_time_command_buffer(device, pool, queue, [&](VkCommandBuffer cmd_buf) {
+            staging.stage(cmd_buf, frame_index % 3);
+        });
+
+        if (!result)
+            break;
+    }
+
+    auto const upload_time = timer.elapsed();
+
+    log()->info("{} textures - {} ms, ring: {} MB, max live allocations: {}, dedicated buffers: {}",
+                textures.size(), upload_time.count(), ring->get_size() >> 20,
+                max_allocations, ring->get_dedicated_count());
+
+    device->wait_for_idle();
+    device->vkDestroyCommandPool(pool);
+
+    for (auto& texture : textures)
+        texture->destroy();
+
+    auto const passed = textures.size() == texture_count && ring->get_dedicated_count() == 0
+                        && ring->get_allocation_count() == 0;
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(18, "mesh memory benchmark") {
+    app app("lava mesh memory", argh);
+    if (!app.setup())
+        return error::not_ready;
+
+    // dense grid of small triangles, drawn several times per frame
+    auto const grid_size = 512u;
+    auto const draw_count = 16u;
+
+    mesh_data<> data;
+    data.vertices.reserve((grid_size + 1) * (grid_size + 1));
+
+    for (auto y = 0u; y <= grid_size; ++y) {
+        for (auto x = 0u; x <= grid_size; ++x) {
+            vertex vert{};
+            vert.position = v3(to_r32(x) / grid_size * 1.6f - 0.8f, to_r32(y) / grid_size * 1.6f - 0.8f, 0.f);
+            vert.color = v4(to_r32(x) / grid_size, to_r32(y) / grid_size, 1.f, 1.f);
+            data.vertices.push_back(vert);
+        }
+    }
+
+    for (auto y = 0u; y < grid_size; ++y) {
+        for (auto x = 0u; x < grid_size; ++x) {
+            auto const i = y * (grid_size + 1) + x;
+            data.indices.insert(data.indices.end(), { i, i + 1, i + grid_size + 1,
+                                                      i + 1, i + grid_size + 2, i + grid_size + 1 });
+        }
+    }
+
+    auto device_local = make_mesh();
+    device_local->set_data(data);
+    if (!device_local->create(app.device))
+        return error::create_failed;
+
+    auto host_visible = make_mesh();
+    host_visible->set_data(data);
+    if (!host_visible->create(app.device, false, VMA_MEMORY_USAGE_CPU_TO_GPU))
+        return error::create_failed;
+
+    graphics_pipeline::ptr pipeline;
+    pipeline_layout::ptr layout;
+
+    auto host = false;
+
+    app.on_create = [&]() {
+        pipeline = make_graphics_pipeline(app.device);
+
+        layout = make_pipeline_layout();
+        if (!layout->create(app.device))
+            return false;
+
+        pipeline->on_process = [&](VkCommandBuffer cmd_buf) {
+            auto& mesh = host ? host_visible : device_local;
+
+            mesh->bind(cmd_buf);
+            for (auto i = 0u; i < draw_count; ++i)
+                mesh->draw(cmd_buf);
+        };
+
+        if (!pipeline->add_shader(file_data("triangle/vertex.spirv"), VK_SHADER_STAGE_VERTEX_BIT))
+            return false;
+
+        if (!pipeline->add_shader(file_data("triangle/fragment.spirv"), VK_SHADER_STAGE_FRAGMENT_BIT))
+            return false;
+
+        pipeline->add_color_blend_attachment();
+
+        pipeline->set_vertex_input_binding({ 0, sizeof(vertex), VK_VERTEX_INPUT_RATE_VERTEX });
+        pipeline->set_vertex_input_attributes({
+            { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, to_ui32(offsetof(vertex, position)) },
+            { 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, to_ui32(offsetof(vertex, color)) },
+        });
+
+        render_pass::ptr render_pass = app.shading.get_pass();
+
+        pipeline->set_layout(layout);
+
+        if (!pipeline->create(render_pass->get()))
+            return false;
+
+        render_pass->add_front(pipeline);
+
+        return true;
+    };
+
+    app.on_destroy = [&]() {
+        pipeline->destroy();
+        layout->destroy();
+    };
+
+    auto const warm_up_frames = 50u;
+    auto const measure_frames = 500u;
+
+    auto frame_count = 0u;
+    std::array<r64, 2> frame_times = {};
+
+    timer timer;
+
+    app.on_update = [&](delta dt) {
+        ++frame_count;
+
+        if (frame_count == warm_up_frames)
+            timer.reset();
+
+        if (frame_count == warm_up_frames + measure_frames) {
+            frame_times[host ? 1 : 0] = to_r64(timer.elapsed().count()) / measure_frames;
+
+            if (host)
+                return app.shut_down();
+
+            host = true;
+            frame_count = 0;
+        }
+
+        return true;
+    };
+
+    app.add_run_end([&]() {
+        device_local->destroy();
+        host_visible->destroy();
+    });
+
+    auto const result = app.run();
+    if (result != 0)
+        return result;
+
+    log()->info("{} vertices x {} draws - device local: {:.2f} ms, host visible: {:.2f} ms ({:.2f}x)",
+                data.vertices.size(), draw_count, frame_times[0], frame_times[1],
+                frame_times[1] / std::max(frame_times[0], 0.001));
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(19, "mesh pool") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    auto const mesh_count = 1000u;
+
+    mesh_data<> quad;
+    quad.vertices.resize(4);
+    quad.indices = { 0, 1, 2, 2, 3, 0 };
+
+    mesh_pool pool;
+    if (!pool.create(device, mesh_count * 4, mesh_count * 6))
+        return error::create_failed;
+
+    id::list meshes;
+    for (auto i = 0u; i < mesh_count; ++i) {
+        auto const mesh = pool.add(quad);
+        if (!mesh.valid())
+            return error::create_failed;
+
+        meshes.push_back(mesh);
+    }
+
+    // every other quad removed: enough space, but fragmented
+    for (auto i = 0u; i < mesh_count; i += 2)
+        pool.remove(meshes.at(i));
+
+    mesh_data<> large;
+    large.vertices.resize(mesh_count);
+    for (auto i = 0u; i < mesh_count; ++i)
+        large.indices.push_back(i);
+
+    auto const fragmented = !pool.add(large).valid();
+    auto const free_ranges = pool.get_vertex_ranges().get_free_range_count();
+
+    if (!pool.compact())
+        return error::run_aborted;
+
+    auto const large_mesh = pool.add(large);
+
+    log()->info("mesh pool - meshes: {}, free ranges: {} -> {}, large mesh fragmented: {}, after compact: {}",
+                pool.get_mesh_count(), free_ranges, pool.get_vertex_ranges().get_free_range_count(),
+                fragmented, large_mesh.valid());
+
+    auto const draw = pool.get_draw_command(meshes.at(1));
+    auto const passed = fragmented && large_mesh.valid() && draw.firstIndex == 0 && draw.vertexOffset == 0;
+
+    pool.destroy();
+
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(20, "frame allocator") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    auto const frame_count = 3u;
+    auto const draws_per_frame = 10000u;
+
+    frame_allocator allocator;
+    if (!allocator.create(device, sizeof(mat4) * draws_per_frame * 2, frame_count))
+        return error::create_failed;
+
+    auto passed = true;
+    std::vector<index> first_offsets;
+
+    timer timer;
+
+    for (auto frame_index = 0u; frame_index < frame_count * 2; ++frame_index) {
+        allocator.begin_frame(frame_index);
+
+        pipeline_layout::offset_list offsets;
+        for (auto i = 0u; i < draws_per_frame; ++i) {
+            auto const allocation = allocator.push(mat4(r32(i)));
+            if (!allocation.valid() || allocation.offset % allocator.get_alignment() != 0) {
+                passed = false;
+                break;
+            }
+
+            offsets.push_back(allocation.offset);
+        }
+
+        allocator.flush();
+
+        // same frame index reuses the same region
+        if (frame_index < frame_count)
+            first_offsets.push_back(offsets.front());
+        else if (first_offsets[frame_index % frame_count] != offsets.front())
+            passed = false;
+    }
+
+    log()->info("{} allocations - {} ms, alignment: {}, used per frame: {} KB",
+                draws_per_frame * frame_count * 2, timer.elapsed().count(),
+                allocator.get_alignment(), allocator.get_used() >> 10);
+
+    // region full
+    if (allocator.allocate(allocator.get_size()).valid())
+        passed = false;
+
+    allocator.destroy();
+
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(21, "memory defragmentation") {
+    frame frame(argh);
+    if (!frame.ready())
+        return error::not_ready;
+
+    device_ptr device = frame.create_device();
+    if (!device)
+        return error::create_failed;
+
+    auto const log_stats = [&]() {
+        for (auto const& heap : memory_stats(device))
+            log()->info("heap {} - usage: {} KB, budget: {} MB, blocks: {}, allocations: {}",
+                        heap.heap, heap.usage >> 10, heap.budget >> 20, heap.block_count, heap.allocation_count);
+    };
+
+    auto const usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    auto const buffer_size = 256u << 10;
+
+    buffer::list buffers;
+    for (auto i = 0u; i < 256; ++i) {
+        std::vector<ui32> data(buffer_size / sizeof(ui32), i);
+
+        auto buffer = make_buffer();
+        if (!buffer->create_mapped(device, data.data(), buffer_size, usage))
+            return error::create_failed;
+
+        buffers.push_back(buffer);
+    }
+
+    // leave holes
+    buffer::list remaining;
+    for (auto i = 0u; i < buffers.size(); ++i) {
+        if (i % 3 == 0)
+            buffers[i]->destroy();
+        else
+            remaining.push_back(buffers[i]);
+    }
+
+    log()->info("budget extension: {}", device->get_allocator()->budget_supported());
+    log_stats();
+
+    defragmenter defrag;
+    if (!defrag.create(device, 4 << 20, 16))
+        return error::create_failed;
+
+    auto moved = 0u;
+    for (auto& buffer : remaining)
+        defrag.add(buffer, [&]() { ++moved; });
+
+    if (!defrag.begin())
+        return error::create_failed;
+
+    auto steps = 0u;
+    while (defrag.step())
+        ++steps;
+
+    log()->info("{} steps, {} moved callbacks", steps, moved);
+    log_stats();
+
+    auto passed = moved == defrag.get_move_count();
+
+    for (auto i = 0u, r = 0u; i < buffers.size(); ++i) {
+        if (i % 3 == 0)
+            continue;
+
+        auto const data = (ui32 const*) remaining[r++]->get_mapped_data();
+        if (data[0] != i || data[buffer_size / sizeof(ui32) - 1] != i)
+            passed = false;
+    }
+
+    defrag.destroy();
+
+    for (auto& buffer : remaining)
+        buffer->destroy();
+
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(22, "upload context") {
+    app app("lava upload context", argh);
+
+    // transfer queue next to the graphics queue
+    app.manager.on_create_param = [](device::create_param& param) {
+        param.add_dedicated_queues();
+    };
+
+    if (!app.setup())
+        return error::not_ready;
+
+    if (!app.uploads) {
+        log()->error("upload context - no dedicated transfer queue or timeline semaphores");
+        return error::not_ready;
+    }
+
+    auto const file_count = 16u;
+    uv2 const size = { 256, 256 };
+
+    auto const path = std::filesystem::temp_directory_path() / "lava_upload_context";
+    std::filesystem::create_directories(path);
+
+    std::vector<ui8> pixels(size.x * size.y * 4);
+    for (auto& pixel : pixels)
+        pixel = ui8(random(0, 255));
+
+    file_format::list files;
+    for (auto i = 0u; i < file_count; ++i) {
+        auto const filename = (path / fmt::format("{}.png", i)).string();
+        if (!stbi_write_png(str(filename), size.x, size.y, 4, pixels.data(), size.x * 4))
+            return error::create_failed;
+
+        files.push_back({ filename, VK_FORMAT_R8G8B8A8_UNORM });
+    }
+
+    auto batch = make_texture_batch();
+    batch->set_upload_context(app.uploads);
+
+    auto loaded = 0u;
+    batch->on_loaded = [&](index, texture::ptr texture) {
+        if (texture)
+            ++loaded;
+    };
+
+    if (!batch->start(app.device, files))
+        return error::create_failed;
+
+    // buffer upload next to the textures
+    std::vector<ui32> data(1024, 42);
+    auto const data_size = data.size() * sizeof(ui32);
+
+    auto buffer = make_buffer();
+    if (!buffer->create(app.device, nullptr, data_size,
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+        return error::create_failed;
+
+    auto buffer_ready = false;
+    if (!app.uploads->add({ buffer, data.data(), data_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT },
+                          [&]() { buffer_ready = true; }))
+        return error::create_failed;
+
+    auto const ownership_transfer = app.uploads->ownership_transfer();
+
+    auto frame_count = 0u;
+    auto submitted = ui64(0);
+
+    app.on_update = [&](delta dt) {
+        batch->poll(&app.staging);
+
+        submitted = app.uploads->get_submitted_value();
+
+        auto const done = batch->done() && buffer_ready && !app.uploads->busy();
+        if (done || ++frame_count == 1000)
+            return app.shut_down();
+
+        return true;
+    };
+
+    app.add_run_end([&]() {
+        batch->cancel();
+
+        for (auto& texture : batch->get_textures())
+            if (texture)
+                texture->destroy();
+
+        buffer->destroy();
+    });
+
+    auto const result = app.run();
+
+    std::filesystem::remove_all(path);
+
+    if (result != 0)
+        return result;
+
+    log()->info("upload context - textures: {} / {}, buffer ready: {}, submits: {}, frames: {}, ownership transfer: {}",
+                loaded, file_count, buffer_ready, submitted, frame_count, ownership_transfer);
+
+    auto const passed = loaded == file_count && buffer_ready && submitted > 0;
+    return passed ? 0 : error::run_aborted;
+}
+
+//-----------------------------------------------------------------------------
+LAVA_TEST(23, "async compute") {
+    app app("lava async compute", argh);
+
+    // compute queue next to the graphics queue
+    app.manager.on_create_param = [](device::create_param& param) {
+        param.add_dedicated_queues();
+    };
+
+    if (!app.setup())
+        return error::not_ready;
+
+    if (!app.compute) {
+        log()->error("async compute - no dedicated compute queue or timeline semaphores");
+        return error::not_ready;
+    }
+
+    auto const buffer_size = 4u << 20;
+    auto const usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    auto dependent_buffer = make_buffer();
+    auto independent_buffer = make_buffer();
+    if (!dependent_buffer->create(app.device, nullptr, buffer_size, usage)
+        || !independent_buffer->create(app.device, nullptr, buffer_size, usage))
+        return error::create_failed;
+
+    auto& compute = app.compute;
+
+    // graphics work waits for the first command only
+    auto const dependent = compute->add_cmd([&](VkCommandBuffer cmd_buf) {
+        app.device->call().vkCmdFillBuffer(cmd_buf, dependent_buffer->get(), 0, VK_WHOLE_SIZE, 1);
+    });
+
+    compute->add_cmd([&](VkCommandBuffer cmd_buf) {
+        app.device->call().vkCmdFillBuffer(cmd_buf, independent_buffer->get(), 0, VK_WHOLE_SIZE, 2);
+    });
+
+    compute->add_dependency(dependent, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    // waits without timeline value are rejected
+    auto const rejected = !compute->add_wait_semaphore(VK_NULL_HANDLE, VK_PIPELINE_STAGE_TRANSFER_BIT, 1)
+                          && !compute->add_wait_semaphore(compute->get_semaphore(), VK_PIPELINE_STAGE_TRANSFER_BIT, 0);
+
+    auto frame_count = 0u;
+    auto split_frames = 0u;
+    auto waits = 0u;
+
+    app.on_update = [&](delta dt) {
+        // dependent commands signal first, the rest signals the next value
+        if (compute->get_wait_stages() == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+            && compute->get_wait_value() + 1 == compute->get_submitted_value())
+            ++split_frames;
+
+        // next submit waits for the last one on the own timeline
+        if (auto const value = compute->get_submitted_value())
+            if (compute->add_wait_semaphore(compute->get_semaphore(), VK_PIPELINE_STAGE_TRANSFER_BIT, value))
+                ++waits;
+
+        if (++frame_count == 100)
+            return app.shut_down();
+
+        return true;
+    };
+
+    app.add_run_end([&]() {
+        dependent_buffer->destroy();
+        independent_buffer->destroy();
+    });
+
+    auto const result = app.run();
+    if (result != 0)
+        return result;
+
+    log()->info("async compute - frames: {}, split submits: {}, timeline waits: {}, rejected waits: {}",
+                frame_count, split_frames, waits, rejected);
+
+    auto const passed = rejected && split_frames > 0 && waits > 0;
+    return passed ? 0 : error::run_aborted;
+}
@@ -7,6 +7,7 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <liblava/lava.hpp>
+#include <numbers>
 
 using namespace lava;
 
@@ -118,3 +119,655 @@ TEST_CASE("queue setup - Intel(R) HD Graphics 620", "[queue]") {
         REQUIRE(verify_queues(list, properties) == verify_queues_result::ok);
     }
 }
+
+//-----------------------------------------------------------------------------
+TEST_CASE("mesh simplification", "[mesh]") {
+    mesh_data<vertex> data;
+
+    auto const size = 32u;
+    for (auto y = 0u; y <= size; ++y) {
+        for (auto x = 0u; x <= size; ++x) {
+            vertex vert{};
+            vert.position = v3(to_r32(x) / size, to_r32(y) / size, 0.f);
+            vert.normal = v3(0.f, 0.f, 1.f);
+            data.vertices.push_back(vert);
+        }
+    }
+
+    for (auto y = 0u; y < size; ++y) {
+        for (auto x = 0u; x < size; ++x) {
+            auto const a = y * (size + 1) + x;
+            auto const c = a + size + 1;
+            data.indices.insert(data.indices.end(), { a, a + 1, c + 1, a, c + 1, c });
+        }
+    }
+
+    SECTION("flat grid collapses without error") {
+        r32 error = 1.f;
+        auto const result = simplify_mesh(data.vertices, data.indices, 6, 0.001f, &error);
+
+        REQUIRE(result.size() < data.indices.size() / 4);
+        REQUIRE(result.size() % 3 == 0);
+        REQUIRE(error < 0.001f);
+
+        for (auto i : result)
+            REQUIRE(i < data.vertices.size());
+    }
+
+    SECTION("lods of a sphere share vertices and select by screen size") {
+        // curved surface, every collapse adds error
+        mesh_data<vertex> sphere;
+
+        auto const rings = 32u;
+        auto const segments = 64u;
+        for (auto r = 0u; r <= rings; ++r) {
+            auto const theta = to_r32(r) / rings * std::numbers::pi_v<r32>;
+
+            for (auto s = 0u; s <= segments; ++s) {
+                auto const phi = to_r32(s) / segments * 2.f * std::numbers::pi_v<r32>;
+
+                vertex vert{};
+                vert.position = v3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                vert.normal = vert.position;
+                sphere.vertices.push_back(vert);
+            }
+        }
+
+        for (auto r = 0u; r < rings; ++r) {
+            for (auto s = 0u; s < segments; ++s) {
+                auto const a = r * (segments + 1) + s;
+                auto const c = a + segments + 1;
+                sphere.indices.insert(sphere.indices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+            }
+        }
+
+        auto const full_count = sphere.indices.size();
+        auto const lod_count = generate_lods(sphere, 4);
+
+        REQUIRE(lod_count > 2);
+        REQUIRE(sphere.lods.front().index_count == full_count);
+        REQUIRE(sphere.lods.front().error == 0.f);
+
+        for (auto i = 1u; i < sphere.lods.size(); ++i) {
+            REQUIRE(sphere.lods[i].index_count < sphere.lods[i - 1].index_count);
+            REQUIRE(sphere.lods[i].first_index + sphere.lods[i].index_count <= sphere.indices.size());
+            REQUIRE(sphere.lods[i].error > sphere.lods[i - 1].error);
+        }
+
+        for (auto i : sphere.indices)
+            REQUIRE(i < sphere.vertices.size());
+
+        REQUIRE(select_lod(sphere.lods, 1.f, 0.0001f) == sphere.lods.size() - 1);
+        REQUIRE(select_lod(sphere.lods, 1.f, 10.f) < sphere.lods.size() - 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("meshlet builder", "[mesh]") {
+    mesh_data<vertex> data;
+
+    auto const size = 40u;
+    for (auto y = 0u; y <= size; ++y)
+        for (auto x = 0u; x <= size; ++x)
+            data.vertices.push_back({ .position = v3(to_r32(x), to_r32(y), 0.f) });
+
+    for (auto y = 0u; y < size; ++y) {
+        for (auto x = 0u; x < size; ++x) {
+            auto const a = y * (size + 1) + x;
+            auto const c = a + size + 1;
+            data.indices.insert(data.indices.end(), { a, a + 1, c + 1, a, c + 1, c });
+        }
+    }
+
+    auto const result = build_meshlets(data);
+
+    REQUIRE(result.count() > 1);
+    REQUIRE(result.spheres.size() == result.count());
+    REQUIRE(result.cones.size() == result.count());
+    REQUIRE(result.cone_apices.size() == result.count());
+
+    auto triangle_count = 0u;
+    for (auto const& meshlet : result.meshlets) {
+        REQUIRE(meshlet.vertex_count <= meshlet_max_vertices);
+        REQUIRE(meshlet.triangle_count <= meshlet_max_triangles);
+
+        for (auto t = 0u; t < meshlet.triangle_count; ++t) {
+            auto const packed = result.triangles.at(meshlet.triangle_offset + t);
+            REQUIRE((packed & 0xff) < meshlet.vertex_count);
+            REQUIRE(((packed >> 8) & 0xff) < meshlet.vertex_count);
+            REQUIRE(((packed >> 16) & 0xff) < meshlet.vertex_count);
+        }
+
+        triangle_count += meshlet.triangle_count;
+    }
+
+    REQUIRE(triangle_count == data.indices.size() / 3);
+
+    // flat grid faces +Z
+    REQUIRE(meshlet_cone_culled(result, 0, v3(0.f, 0.f, -10.f)));
+    REQUIRE_FALSE(meshlet_cone_culled(result, 0, v3(0.f, 0.f, 10.f)));
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("mip chain generation", "[texture]") {
+    uv2 const size = { 37, 20 };
+
+    auto const levels = get_mip_levels(size);
+    REQUIRE(levels.size() == 6);
+    REQUIRE(levels.back().extent == uv2(1, 1));
+    REQUIRE(get_mip_chain_size(size) == 3904);
+
+    SECTION("constant color") {
+        std::vector<char> chain(get_mip_chain_size(size));
+        for (auto p = 0u; p < size.x * size.y; ++p) {
+            chain[p * 4] = 10;
+            chain[p * 4 + 1] = char(200);
+            chain[p * 4 + 2] = 77;
+            chain[p * 4 + 3] = char(255);
+        }
+
+        for (auto srgb : { false, true }) {
+            generate_mip_chain(chain.data(), levels, srgb);
+
+            auto const* last = (ui8 const*) chain.data() + chain.size() - 4;
+            REQUIRE(last[0] == 10);
+            REQUIRE(last[1] == 200);
+            REQUIRE(last[2] == 77);
+            REQUIRE(last[3] == 255);
+        }
+    }
+
+    SECTION("gamma correct") {
+        ui8 const pixels[] = { 0, 0, 0, 0, 255, 255, 255, 255,
+                               0, 0, 0, 0, 255, 255, 255, 255 };
+        ui8 result[4]{};
+
+        downsample_rgba8((data_cptr) pixels, { 2, 2 }, (data_ptr) result, false);
+        REQUIRE(result[0] == 128);
+        REQUIRE(result[3] == 128);
+
+        downsample_rgba8((data_cptr) pixels, { 2, 2 }, (data_ptr) result, true);
+        REQUIRE(result[0] == 188);
+        REQUIRE(result[3] == 128);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("block compression", "[texture]") {
+    std::array<ui8, 64> pixels;
+    std::array<ui8, 64> decoded;
+    std::array<ui8, 16> block;
+
+    SECTION("solid block") {
+        for (auto i = 0u; i < 16; ++i) {
+            pixels[i * 4] = 255;
+            pixels[i * 4 + 1] = 0;
+            pixels[i * 4 + 2] = 255;
+            pixels[i * 4 + 3] = 255;
+        }
+
+        for (auto format : { VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC7_UNORM_BLOCK }) {
+            encode_bc_block(format, pixels.data(), block.data());
+            decode_bc_block(format, block.data(), decoded.data());
+
+            // BC7 mode 6 shares the p-bit over all channels
+            for (auto i = 0u; i < 16; ++i) {
+                REQUIRE(decoded[i * 4] >= 254);
+                REQUIRE(decoded[i * 4 + 1] <= 1);
+                REQUIRE(decoded[i * 4 + 2] >= 254);
+            }
+        }
+    }
+
+    SECTION("two values") {
+        for (auto i = 0u; i < 16; ++i) {
+            pixels[i * 4] = i % 2 ? 200 : 10;
+            pixels[i * 4 + 1] = i % 2 ? 30 : 90;
+        }
+
+        encode_bc_block(VK_FORMAT_BC5_UNORM_BLOCK, pixels.data(), block.data());
+        decode_bc_block(VK_FORMAT_BC5_UNORM_BLOCK, block.data(), decoded.data());
+
+        for (auto i = 0u; i < 16; ++i) {
+            REQUIRE(decoded[i * 4] == pixels[i * 4]);
+            REQUIRE(decoded[i * 4 + 1] == pixels[i * 4 + 1]);
+        }
+    }
+
+    SECTION("punch through alpha") {
+        for (auto i = 0u; i < 16; ++i) {
+            pixels[i * 4] = ui8(i * 16);
+            pixels[i * 4 + 1] = 0;
+            pixels[i * 4 + 2] = ui8(255 - i * 16);
+            pixels[i * 4 + 3] = i % 2 ? 255 : 0;
+        }
+
+        encode_bc_block(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, pixels.data(), block.data());
+        decode_bc_block(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, block.data(), decoded.data());
+
+        for (auto i = 0u; i < 16; ++i)
+            REQUIRE(decoded[i * 4 + 3] == pixels[i * 4 + 3]);
+    }
+
+    SECTION("gradient quality") {
+        uv2 const size = { 37, 21 };
+
+        std::vector<char> image(size.x * size.y * 4);
+        for (auto y = 0u; y < size.y; ++y) {
+            for (auto x = 0u; x < size.x; ++x) {
+                auto* pixel = (ui8*) &image[(y * size.x + x) * 4];
+                pixel[0] = ui8(x * 6);
+                pixel[1] = ui8(y * 12);
+                pixel[2] = ui8(128);
+                pixel[3] = ui8(255 - x * 3);
+            }
+        }
+
+        std::vector<char> encoded(get_bc_size(VK_FORMAT_BC7_UNORM_BLOCK, size));
+        std::vector<char> result(image.size());
+
+        REQUIRE(encode_bc(VK_FORMAT_BC7_UNORM_BLOCK, image.data(), size, encoded.data()));
+        REQUIRE(decode_bc(VK_FORMAT_BC7_UNORM_BLOCK, encoded.data(), size, result.data()));
+        REQUIRE(calculate_psnr(image.data(), result.data(), size) > 32.0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("file seek", "[file]") {
+    std::vector<char> data(64, 'x');
+
+    auto const path = (fs::temp_directory_path() / "lava_unit_seek.bin").string();
+
+    {
+        file file(str(path), true);
+        REQUIRE(file.opened());
+        REQUIRE(file.write(data.data(), data.size()) == to_i64(data.size()));
+
+        // positions are absolute, like PhysFS
+        REQUIRE(file.seek(8) == 8);
+        REQUIRE(file.seek(8) == 8);
+        REQUIRE(file.tell() == 8);
+    }
+
+    {
+        file file(str(path));
+        REQUIRE(file.opened());
+
+        REQUIRE(file.seek(40) == 40);
+        REQUIRE(file.seek(16) == 16);
+        REQUIRE(file.tell() == 16);
+    }
+
+    fs::remove(path);
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("file chunked read", "[file]") {
+    std::vector<char> data(200000);
+    for (auto i = 0u; i < data.size(); ++i)
+        data[i] = char(i * 7 + i / 300);
+
+    auto const path = (fs::temp_directory_path() / "lava_unit_chunked_read.bin").string();
+
+    {
+        file file(str(path), true);
+        REQUIRE(file.opened());
+        REQUIRE(file.write(data.data(), data.size()) == to_i64(data.size()));
+    }
+
+    {
+        file file(str(path));
+        REQUIRE(file.opened());
+
+        REQUIRE(asset_cache::hash(file) == asset_cache::hash(data.data(), data.size()));
+        REQUIRE(file.tell() == 0);
+
+        std::array<char, 16> chunk;
+        file.seek(1000);
+        REQUIRE(file.read_next(chunk.data(), chunk.size()) == to_i64(chunk.size()));
+        REQUIRE(memcmp(chunk.data(), &data[1000], chunk.size()) == 0);
+
+        file.seek(data.size() - 4);
+        REQUIRE(file.read_next(chunk.data(), chunk.size()) == 4);
+    }
+
+    fs::remove(path);
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("half float conversion", "[texture]") {
+    SECTION("special values") {
+        REQUIRE(float_to_half(0.f) == 0x0000);
+        REQUIRE(float_to_half(-0.f) == 0x8000);
+        REQUIRE(float_to_half(1.f) == 0x3c00);
+        REQUIRE(float_to_half(-2.f) == 0xc000);
+        REQUIRE(float_to_half(65504.f) == 0x7bff);
+        REQUIRE(float_to_half(65520.f) == 0x7c00);
+        REQUIRE(float_to_half(std::numeric_limits<r32>::infinity()) == 0x7c00);
+        REQUIRE(float_to_half(std::numeric_limits<r32>::quiet_NaN()) == 0x7e00);
+        REQUIRE(float_to_half(5.96046448e-8f) == 0x0001);
+    }
+
+    SECTION("round trip") {
+        for (auto bits = 0u; bits < 0x10000; ++bits) {
+            auto const exponent = (bits >> 10) & 0x1f;
+            if (exponent == 0x1f && (bits & 0x3ff))
+                continue;
+
+            REQUIRE(float_to_half(half_to_float(ui16(bits))) == bits);
+        }
+    }
+
+    SECTION("simd matches scalar") {
+        std::vector<r32> values = { 0.f, -0.f, 1.f, 65504.f, 65520.f, 1e-5f, -1e-7f, 3.14159f,
+                                    std::numeric_limits<r32>::infinity(), -std::numeric_limits<r32>::infinity() };
+        for (auto i = 0u; i < 1000; ++i)
+            values.push_back(random(-70000.f, 70000.f) * (i % 2 ? 1.f : 1e-6f));
+
+        std::vector<ui16> simd(values.size());
+        std::vector<ui16> scalar(values.size());
+
+        convert_to_half(values.data(), simd.data(), values.size());
+        convert_to_half(values.data(), scalar.data(), values.size(), false);
+
+        REQUIRE(simd == scalar);
+
+        std::vector<ui32> packed_simd(values.size() / 4);
+        std::vector<ui32> packed_scalar(values.size() / 4);
+
+        convert_to_b10g11r11(values.data(), packed_simd.data(), packed_simd.size());
+        convert_to_b10g11r11(values.data(), packed_scalar.data(), packed_scalar.size(), false);
+
+        REQUIRE(packed_simd == packed_scalar);
+    }
+
+    SECTION("packed float") {
+        REQUIRE(unpack_b10g11r11(pack_b10g11r11({ 1.f, 0.5f, 2.f })) == v3(1.f, 0.5f, 2.f));
+        REQUIRE(unpack_b10g11r11(pack_b10g11r11({ -1.f, std::numeric_limits<r32>::quiet_NaN(), 0.f })) == v3(0.f));
+        REQUIRE(unpack_b10g11r11(pack_b10g11r11(v3(1e9f))) == v3(65024.f, 65024.f, 64512.f));
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("id registry", "[id]") {
+    struct object : entity {};
+
+    id_registry<object, string> registry;
+
+    auto const first = registry.create("first");
+    auto const second = registry.create("second");
+
+    REQUIRE(registry.has(first));
+    REQUIRE(registry.get(first)->get_id() == first);
+    REQUIRE(registry.get_meta(second) == "second");
+
+    REQUIRE(registry.update(second, "updated"));
+    REQUIRE(registry.get_meta(second) == "updated");
+
+    registry.remove(first);
+    REQUIRE(!registry.has(first));
+    REQUIRE(!registry.update(first, "removed"));
+    REQUIRE(registry.get_all().size() == 1);
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("vertex streams", "[mesh]") {
+    SECTION("interleaved") {
+        auto const streams = get_vertex_streams<vertex>(mesh_layout::interleaved);
+
+        REQUIRE(streams.size() == 1);
+        REQUIRE(streams.front().stride == sizeof(vertex));
+        REQUIRE(streams.front().attributes.size() == 4);
+        REQUIRE(streams.front().attributes.at(3).offset == offsetof(vertex, normal));
+    }
+
+    SECTION("position split") {
+        auto const streams = get_vertex_streams<vertex>(mesh_layout::position_split);
+
+        REQUIRE(streams.size() == 2);
+        REQUIRE(streams.at(0).stride == sizeof(v3));
+        REQUIRE(streams.at(0).attributes.front().attribute == vertex_attribute::position);
+        REQUIRE(streams.at(1).stride == sizeof(v4) + sizeof(v2) + sizeof(v3));
+        REQUIRE(streams.at(1).attributes.at(2).offset == sizeof(v4) + sizeof(v2));
+    }
+
+    SECTION("soa") {
+        auto const streams = get_vertex_streams<vertex>(mesh_layout::soa);
+
+        REQUIRE(streams.size() == 4);
+        REQUIRE(streams.at(1).attributes.front().format == VK_FORMAT_R32G32B32A32_SFLOAT);
+        REQUIRE(streams.at(2).stride == sizeof(v2));
+
+        for (auto& stream : streams)
+            REQUIRE(stream.attributes.front().offset == 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("packed vertex", "[mesh]") {
+    REQUIRE(sizeof(packed_vertex) == 20);
+
+    mesh_data<> data;
+    for (auto i = 0u; i < 1000; ++i) {
+        vertex vert{};
+        vert.position = v3(random(-10.f, 10.f), random(0.f, 2.f), random(-50.f, 50.f));
+        vert.color = v4(random(0.f, 1.f), random(0.f, 1.f), random(0.f, 1.f), 1.f);
+        vert.uv = v2(random(0.f, 1.f), random(0.f, 1.f));
+        vert.normal = glm::normalize(v3(random(-1.f, 1.f), random(-1.f, 1.f), random(-1.f, 1.f)) + v3(0.001f));
+        data.vertices.push_back(vert);
+        data.indices.push_back(i);
+    }
+
+    auto const packed = pack_mesh(data);
+
+    REQUIRE(packed.data.vertices.size() == data.vertices.size());
+    REQUIRE(packed.data.indices == data.indices);
+
+    auto max_position_error = 0.f;
+    auto max_normal_error = 0.f;
+
+    for (auto i = 0u; i < data.vertices.size(); ++i) {
+        auto const& vertex = data.vertices.at(i);
+        auto const& packed_vertex = packed.data.vertices.at(i);
+
+        max_position_error = std::max(max_position_error,
+                                      glm::length(get_position(packed_vertex, packed.dequantization) - vertex.position));
+        max_normal_error = std::max(max_normal_error, glm::length(get_normal(packed_vertex) - vertex.normal));
+    }
+
+    // 100 units extent at 16 bits
+    REQUIRE(max_position_error < 0.005f);
+    REQUIRE(max_normal_error < 0.001f);
+
+    auto const attributes = get_vertex_attributes<packed_vertex>();
+    REQUIRE(attributes.size() == 4);
+    REQUIRE(attributes.front().format == VK_FORMAT_R16G16B16A16_SNORM);
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("range allocator", "[mesh]") {
+    range_allocator allocator;
+    allocator.reset(100);
+
+    ui32 first = 0;
+    ui32 second = 0;
+    ui32 third = 0;
+
+    REQUIRE(allocator.allocate(30, first));
+    REQUIRE(allocator.allocate(30, second));
+    REQUIRE(allocator.allocate(30, third));
+    REQUIRE(first == 0);
+    REQUIRE(third == 60);
+    REQUIRE(allocator.get_free_count() == 10);
+
+    ui32 offset = 0;
+
+    SECTION("first fit in freed range") {
+        allocator.free(second, 30);
+        REQUIRE(allocator.get_free_range_count() == 2);
+
+        REQUIRE(allocator.allocate(20, offset));
+        REQUIRE(offset == 30);
+    }
+
+    SECTION("fragmented") {
+        allocator.free(first, 30);
+        allocator.free(third, 30);
+
+        REQUIRE(allocator.get_free_count() == 70);
+        REQUIRE(allocator.get_largest_free() == 40);
+        REQUIRE_FALSE(allocator.allocate(50, offset));
+    }
+
+    SECTION("merge") {
+        allocator.free(first, 30);
+        allocator.free(third, 30);
+        allocator.free(second, 30);
+
+        REQUIRE(allocator.get_free_range_count() == 1);
+        REQUIRE(allocator.get_largest_free() == 100);
+    }
+
+    SECTION("compacted") {
+        allocator.reset(100, 90);
+        REQUIRE(allocator.allocate(10, offset));
+        REQUIRE(offset == 90);
+    }
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("instance attributes", "[mesh]") {
+    auto const binding = instance_buffer::get_binding(1);
+    REQUIRE(binding.binding == 1);
+    REQUIRE(binding.stride == sizeof(instance_data));
+    REQUIRE(binding.inputRate == VK_VERTEX_INPUT_RATE_INSTANCE);
+
+    auto const attributes = instance_data::get_attributes(1, 4);
+    REQUIRE(attributes.size() == 5);
+    REQUIRE(attributes.front().location == 4);
+    REQUIRE(attributes.at(3).offset == sizeof(v4) * 3);
+    REQUIRE(attributes.back().location == 8);
+    REQUIRE(attributes.back().offset == offsetof(instance_data, color));
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("sampler info hash", "[sampler]") {
+    VkSamplerCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .maxLod = 10.f,
+    };
+
+    auto same = info;
+    REQUIRE(equal_sampler_info(info, same));
+    REQUIRE(hash_sampler_info(info) == hash_sampler_info(same));
+
+    auto other = info;
+    other.minLod = 1.f;
+    REQUIRE(!equal_sampler_info(info, other));
+    REQUIRE(hash_sampler_info(info) != hash_sampler_info(other));
+
+    other = info;
+    other.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    REQUIRE(!equal_sampler_info(info, other));
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("pipeline cache header", "[pipeline]") {
+    VkPhysicalDeviceProperties properties = {
+        .vendorID = 0x10de,
+        .deviceID = 0x1c03,
+    };
+    for (auto i = 0u; i < VK_UUID_SIZE; ++i)
+        properties.pipelineCacheUUID[i] = ui8(i);
+
+    std::vector<char> data(64, 0);
+    ui32 const header[4] = { 32, VK_PIPELINE_CACHE_HEADER_VERSION_ONE, properties.vendorID, properties.deviceID };
+    memcpy(data.data(), header, sizeof(header));
+    memcpy(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+    REQUIRE(pipeline_cache_compatible({ data.data(), data.size() }, properties));
+    REQUIRE(!pipeline_cache_compatible({ data.data(), 16 }, properties));
+    REQUIRE(!pipeline_cache_compatible({}, properties));
+
+    auto other = properties;
+    other.deviceID = 0x1c02;
+    REQUIRE(!pipeline_cache_compatible({ data.data(), data.size() }, other));
+
+    other = properties;
+    other.pipelineCacheUUID[7] = 0xff;
+    REQUIRE(!pipeline_cache_compatible({ data.data(), data.size() }, other));
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("atlas packer", "[texture]") {
+    atlas_packer packer;
+    packer.reset({ 256, 256 });
+
+    std::vector<std::pair<uv2, uv2>> rects;
+    for (auto i = 0u; i < 500; ++i) {
+        uv2 const size = { 4 + (i * 7) % 29, 4 + (i * 13) % 31 };
+
+        uv2 position{};
+        if (!packer.insert(size, position))
+            continue;
+
+        REQUIRE(position.x + size.x <= 256);
+        REQUIRE(position.y + size.y <= 256);
+
+        for (auto const& [other_position, other_size] : rects) {
+            auto const overlap = position.x < other_position.x + other_size.x && other_position.x < position.x + size.x
+                                 && position.y < other_position.y + other_size.y && other_position.y < position.y + size.y;
+            REQUIRE(!overlap);
+        }
+
+        rects.emplace_back(position, size);
+    }
+
+    REQUIRE(!rects.empty());
+    REQUIRE(packer.get_occupancy() > 0.75f);
+
+    uv2 position{};
+    REQUIRE(!packer.insert({ 257, 1 }, position));
+
+    atlas_region region;
+    region.uv_offset = { 0.25f, 0.5f };
+    region.uv_scale = { 0.125f, 0.25f };
+    REQUIRE(region.remap({ 1.f, 1.f }).x == 0.375f);
+    REQUIRE(region.remap({ 1.f, 1.f }).y == 0.75f);
+}
+
+//-----------------------------------------------------------------------------
+TEST_CASE("alias ranges", "[image]") {
+    // three passes, each attachment used in one pass
+    alias_range_list ranges = {
+        { .size = 4096, .alignment = 256, .first_pass = 0, .last_pass = 0 },
+        { .size = 2048, .alignment = 256, .first_pass = 1, .last_pass = 1 },
+        { .size = 3072, .alignment = 256, .first_pass = 2, .last_pass = 2 },
+    };
+
+    std::vector<VkDeviceSize> offsets;
+    REQUIRE(place_alias_ranges(ranges, offsets) == 4096);
+    REQUIRE(offsets == std::vector<VkDeviceSize>{ 0, 0, 0 });
+
+    // overlapping lifetimes do not share memory
+    ranges[1].first_pass = 0;
+    ranges[1].last_pass = 2;
+
+    auto const size = place_alias_ranges(ranges, offsets);
+    REQUIRE(size == 4096 + 2048);
+
+    for (auto i = 0u; i < ranges.size(); ++i) {
+        REQUIRE(offsets[i] % ranges[i].alignment == 0);
+        REQUIRE(offsets[i] + ranges[i].size <= size);
+
+        for (auto j = 0u; j < i; ++j) {
+            if (!ranges[i].overlaps(ranges[j]))
+                continue;
+
+            REQUIRE((offsets[i] + ranges[i].size <= offsets[j] || offsets[j] + ranges[j].size <= offsets[i]));
+        }
+    }
+}